@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+#
+# Measures CPU usage and resident memory of the running camera nodes, e.g. to compare one video_streamer
+# process per camera (all.launch) with the single multi_camera_streamer process (multi_camera.launch), or
+# the subscribers in separate processes with the ones loaded into the camera's nodelet manager (per subscriber).
+#
+# Usage: camera_host_benchmark.sh <process name> <number of cameras> [seconds] [unit]
+#
+# Process name is a pgrep pattern, e.g. 'video_streamer|nodelet' measures both.
+#
+# Subscribe to the cameras' topics before measuring, otherwise the nodes are idle.
+
+set -euo pipefail
+
+if [[ $# -lt 2 ]]; then
+    echo "Usage: $0 <process name> <number of cameras> [seconds] [unit]" >&2
+    exit 1
+fi
+
+name=$1
+cameras=$2
+seconds=${3:-10}
+unit=${4:-camera}
+
+mapfile -t pids < <(pgrep -x "$name" || true)
+
+if [[ ${#pids[@]} -eq 0 ]]; then
+    echo "No running $name processes" >&2
+    exit 1
+fi
+
+# user and system time of the processes in clock ticks
+cpu_ticks() {
+    local total=0
+    for pid in "${pids[@]}"; do
+        # fields after the command name (which could contain spaces), utime and stime are the 12th and 13th
+        local stat
+        stat=$(sed 's/^.*) //' "/proc/$pid/stat")
+        read -r -a fields <<< "$stat"
+        total=$((total + fields[11] + fields[12]))
+    done
+    echo "$total"
+}
+
+# resident memory of the processes in KiB
+rss_kib() {
+    local total=0
+    for pid in "${pids[@]}"; do
+        total=$((total + $(awk '/^VmRSS:/ {print $2}' "/proc/$pid/status")))
+    done
+    echo "$total"
+}
+
+ticks_per_second=$(getconf CLK_TCK)
+
+start=$(cpu_ticks)
+sleep "$seconds"
+end=$(cpu_ticks)
+
+rss=$(rss_kib)
+
+awk -v name="$name" -v processes="${#pids[@]}" -v cameras="$cameras" -v ticks=$((end - start)) \
+    -v hz="$ticks_per_second" -v seconds="$seconds" -v rss="$rss" -v unit="$unit" 'BEGIN {
+    cpu = 100 * ticks / hz / seconds
+    printf "%s: %d processes, %d %ss, %.0f s\n", name, processes, cameras, unit, seconds
+    printf "CPU: %.1f %% total, %.1f %% per %s\n", cpu, cpu / cameras, unit
+    printf "RSS: %.1f MiB total, %.1f MiB per %s\n", rss / 1024, rss / 1024 / cameras, unit
+}'
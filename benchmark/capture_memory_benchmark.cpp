@@ -0,0 +1,119 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+
+#include "lirs_ros_video_streaming/V4L2VideoCapture.hpp"
+
+namespace {
+
+    constexpr auto FRAMES = 100;
+
+    /* Frame is read once right after capture (cold) and then again (as by the subsequent conversions) */
+    constexpr auto READS_PER_FRAME = 4;
+
+    volatile uint64_t sink;
+
+    // Reads every byte of the frame (word by word)
+    void readFrame(uint8_t const *data, size_t size) {
+        auto sum = uint64_t{0};
+
+        for (auto offset = size_t{0}; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            sum += word;
+        }
+
+        sink = sum;
+    }
+
+    void report(std::string const &name, double bytes, std::chrono::nanoseconds elapsed) {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+
+        std::cout << std::setw(32) << std::left << name
+                  << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+                  << (seconds > 0 ? bytes / seconds / (1024 * 1024) : 0.0) << " MiB/s\n";
+    }
+
+    void measure(std::string const &device, lirs::MemoryType memoryType, std::string const &name) {
+        lirs::V4L2Capture capture{device};
+
+        if (!capture.IsOpened() || !capture.Set(lirs::CaptureParam::MEMORY_TYPE, static_cast<int>(memoryType))
+            || !capture.StartStreaming()) {
+            std::cout << std::setw(32) << std::left << name << "    not supported\n";
+            return;
+        }
+
+        auto firstRead = std::chrono::nanoseconds{0};
+        auto nextReads = std::chrono::nanoseconds{0};
+        auto bytes = 0.0;
+
+        auto captured = 0;
+
+        // reading times out if the device stalls
+        for (auto attempt = 0; captured < FRAMES && attempt < 2 * FRAMES; ++attempt) {
+            auto frame = capture.ReadFrame();  // borrowed, i.e. read right from the v4l2 buffer
+
+            if (!frame) continue;
+
+            auto start = std::chrono::steady_clock::now();
+            readFrame(frame->data(), frame->size());
+            auto read = std::chrono::steady_clock::now();
+
+            for (auto i = 1; i < READS_PER_FRAME; ++i) {
+                readFrame(frame->data(), frame->size());
+            }
+
+            firstRead += read - start;
+            nextReads += std::chrono::steady_clock::now() - read;
+            bytes += static_cast<double>(frame->size());
+            ++captured;
+        }
+
+        if (captured == 0) {
+            std::cout << std::setw(32) << std::left << name << "    no frames captured\n";
+            return;
+        }
+
+        report(name + " (first read)", bytes, firstRead);
+        report(name + " (next reads)", bytes * (READS_PER_FRAME - 1), nextReads);
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto device = std::string{argc > 1 ? argv[1] : "/dev/video0"};
+
+    std::cout << "Capture buffers read bandwidth, " << device << ", " << FRAMES << " frames\n";
+
+    measure(device, lirs::MemoryType::MMAP, "MMAP");
+    measure(device, lirs::MemoryType::USERPTR, "USERPTR");
+}
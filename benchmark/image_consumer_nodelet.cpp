@@ -0,0 +1,82 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <cstdint>
+#include <memory>
+
+#include <ros/ros.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <sensor_msgs/Image.h>
+#include <image_transport/image_transport.h>
+
+namespace lirs {
+
+    constexpr auto CONSUMER_REPORT_PERIOD = 5.0;  // seconds
+
+    /**
+     * @brief Subscriber of the image topic measuring the transport cost only (images are not processed).
+     *
+     * Loaded into the camera's nodelet manager it receives the published messages themselves (no serialization),
+     * run standalone (separate process) it receives serialized copies over TCPROS.
+     */
+    class ImageConsumerNodelet final : public nodelet::Nodelet {
+    private:
+        void onInit() override {
+            imageTransport_ = std::make_unique<image_transport::ImageTransport>(getNodeHandle());
+            subscriber_ = imageTransport_->subscribe("image", 1, &ImageConsumerNodelet::consume, this);
+            lastReport_ = ros::Time::now();
+        }
+
+        void consume(sensor_msgs::ImageConstPtr const &imageMsg) {
+            auto now = ros::Time::now();
+
+            latency_ += now - imageMsg->header.stamp;
+            ++count_;
+
+            auto elapsed = now - lastReport_;
+
+            if (elapsed >= ros::Duration{CONSUMER_REPORT_PERIOD}) {
+                NODELET_INFO_STREAM(getName() << ": " << count_ / elapsed.toSec() << " fps, capture-to-receive "
+                                              << latency_.toSec() * 1e3 / count_ << " ms (mean)");
+                latency_ = ros::Duration{};
+                count_ = 0;
+                lastReport_ = now;
+            }
+        }
+
+    private:
+        std::unique_ptr<image_transport::ImageTransport> imageTransport_;
+        image_transport::Subscriber subscriber_;
+
+        ros::Time lastReport_;
+        ros::Duration latency_;
+        uint64_t count_ = 0;
+    };
+
+}  // namespace lirs
+
+PLUGINLIB_EXPORT_CLASS(lirs::ImageConsumerNodelet, nodelet::Nodelet)
@@ -0,0 +1,119 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+
+#include "lirs_ros_video_streaming/V4L2VideoCapture.hpp"
+#include "lirs_ros_video_streaming/FramePool.hpp"
+#include "lirs_ros_video_streaming/MemoryCopy.hpp"
+
+namespace {
+
+    constexpr auto FRAMES_PER_KERNEL = 100;
+
+    constexpr auto ALL_COPY_KERNELS = std::array<lirs::CopyKernel, 3>{
+            lirs::CopyKernel::GENERIC, lirs::CopyKernel::STREAMING_SSE41, lirs::CopyKernel::STREAMING_AVX2};
+
+    struct Measurement {
+        double bytes = 0.0;
+        std::chrono::nanoseconds elapsed{0};
+        int frames = 0;
+    };
+
+    void report(lirs::CopyKernel kernel, Measurement const &measurement) {
+        auto name = lirs::MemoryCopy::copy_kernel_name(kernel);
+
+        if (measurement.frames == 0) {
+            std::cout << std::setw(32) << std::left << name << "    not supported\n";
+            return;
+        }
+
+        auto seconds = std::chrono::duration<double>(measurement.elapsed).count();
+
+        std::cout << std::setw(32) << std::left << name
+                  << std::setw(10) << std::right << std::fixed << std::setprecision(2)
+                  << (seconds > 0 ? measurement.bytes / seconds / 1e9 : 0.0) << " GB/s\n";
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto device = std::string{argc > 1 ? argv[1] : "/dev/video0"};
+
+    lirs::V4L2Capture capture{device};
+
+    if (!capture.IsOpened() || !capture.StartStreaming()) {
+        std::cerr << "Failed to start streaming from " << device << '\n';
+        return 1;
+    }
+
+    std::cout << "Copy bandwidth of the driver's (mmap) buffers, " << device << ", "
+              << FRAMES_PER_KERNEL << " frames per kernel, selected kernel: "
+              << lirs::MemoryCopy::copy_kernel_name(lirs::MemoryCopy::copy_kernel()) << '\n';
+
+    // cache line aligned destination, as the capture's frame pool
+    auto pool = lirs::FramePool{static_cast<size_t>(capture.imageSize()), 1};
+
+    std::array<Measurement, ALL_COPY_KERNELS.size()> measurements{};
+
+    auto const total = FRAMES_PER_KERNEL * static_cast<int>(ALL_COPY_KERNELS.size());
+
+    // kernels take turns, so that each one copies the frames never read before
+    for (auto frameIndex = 0, attempt = 0; frameIndex < total && attempt < 2 * total; ++attempt) {
+        auto frame = capture.ReadFrame();  // borrowed, i.e. data is in the v4l2 buffer
+
+        if (!frame) continue;
+
+        auto destination = pool.Acquire(frame->size());
+
+        if (!destination) {
+            std::cerr << "Frame of " << frame->size() << " bytes exceeds the buffer size\n";
+            return 1;
+        }
+
+        auto index = static_cast<size_t>(frameIndex++) % ALL_COPY_KERNELS.size();
+
+        auto start = std::chrono::steady_clock::now();
+        auto isSupported = lirs::MemoryCopy::from_device(ALL_COPY_KERNELS[index], frame->data(),
+                                                         destination->data(), frame->size());
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (isSupported) {
+            measurements[index].bytes += static_cast<double>(frame->size());
+            measurements[index].elapsed += elapsed;
+            ++measurements[index].frames;
+        }
+    }
+
+    for (auto i = size_t{0}; i < ALL_COPY_KERNELS.size(); ++i) {
+        report(ALL_COPY_KERNELS[i], measurements[i]);
+    }
+}
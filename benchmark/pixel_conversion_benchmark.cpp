@@ -0,0 +1,233 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+
+#include <opencv2/imgproc.hpp>
+
+#include "lirs_ros_video_streaming/PixelConversion.hpp"
+
+namespace {
+
+    constexpr auto WIDTH = 1920;
+    constexpr auto HEIGHT = 1080;
+    constexpr auto ITERATIONS = 500;
+
+    // Average time per frame in microseconds
+    double measure(std::function<void()> const &convert) {
+        convert();  // warm up
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < ITERATIONS; ++i) {
+            convert();
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / ITERATIONS;
+    }
+
+    void report(std::string const &name, double microseconds) {
+        std::cout << std::setw(32) << std::left << name
+                  << std::setw(10) << std::right << std::fixed << std::setprecision(1) << microseconds << " us/frame\n";
+    }
+
+}  // namespace
+
+int main() {
+    std::vector<uint8_t> yuyv(WIDTH * HEIGHT * 2);
+    std::vector<uint8_t> mono(WIDTH * HEIGHT);
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 255};
+
+    for (auto &byte : yuyv) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+
+    std::cout << "YUYV -> MONO8 " << WIDTH << 'x' << HEIGHT << '\n';
+
+    // previous streamer's path: conversion into a new Mat followed by the copy into the message
+    report("OpenCV cvtColor + assign", measure([&] {
+        cv::Mat rawImage(HEIGHT, WIDTH, CV_8UC2, yuyv.data());
+        cv::Mat grayscale;
+        cv::cvtColor(rawImage, grayscale, cv::COLOR_YUV2GRAY_YUYV, 1);
+        mono.assign(grayscale.data, grayscale.data + grayscale.rows * grayscale.cols);
+    }));
+
+    for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON}) {
+        auto supported = true;
+
+        auto time = measure([&] {
+            supported = lirs::PixelConversion::yuyv_to_mono8(level, yuyv.data(), WIDTH * 2,
+                                                             mono.data(), WIDTH, WIDTH, HEIGHT);
+        });
+
+        if (supported) {
+            report(std::string{"PixelConversion "} + lirs::PixelConversion::simd_level_name(level), time);
+        }
+    }
+
+    std::vector<uint8_t> uyvy(WIDTH * HEIGHT * 2);
+
+    std::cout << "\nYUYV -> UYVY " << WIDTH << 'x' << HEIGHT << '\n';
+
+    report("memcpy (reference)", measure([&] {
+        std::memcpy(uyvy.data(), yuyv.data(), yuyv.size());
+    }));
+
+    for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON}) {
+        auto supported = true;
+
+        auto time = measure([&] {
+            supported = lirs::PixelConversion::yuyv_to_uyvy(level, yuyv.data(), WIDTH * 2,
+                                                            uyvy.data(), WIDTH * 2, WIDTH, HEIGHT);
+        });
+
+        if (supported) {
+            report(std::string{"PixelConversion "} + lirs::PixelConversion::simd_level_name(level), time);
+        }
+    }
+
+    std::vector<uint8_t> rgb(WIDTH * HEIGHT * 3);
+
+    std::cout << "\nYUYV -> RGB8 " << WIDTH << 'x' << HEIGHT << '\n';
+
+    report("OpenCV cvtColor + assign", measure([&] {
+        cv::Mat rawImage(HEIGHT, WIDTH, CV_8UC2, yuyv.data());
+        cv::Mat color;
+        cv::cvtColor(rawImage, color, cv::COLOR_YUV2RGB_YUYV);
+        rgb.assign(color.data, color.data + color.total() * color.elemSize());
+    }));
+
+    for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON}) {
+        auto supported = true;
+
+        auto time = measure([&] {
+            supported = lirs::PixelConversion::yuv422_to_rgb(level, lirs::YuvToRgb{}, yuyv.data(), WIDTH * 2,
+                                                             rgb.data(), WIDTH * 3, WIDTH, HEIGHT);
+        });
+
+        if (supported) {
+            report(std::string{"PixelConversion "} + lirs::PixelConversion::simd_level_name(level), time);
+        }
+    }
+
+    std::vector<uint8_t> bayer(WIDTH * HEIGHT);
+
+    for (auto &byte : bayer) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+
+    std::cout << "\nBayer RGGB -> RGB8 " << WIDTH << 'x' << HEIGHT << '\n';
+
+    // downstream consumer's path (e.g. image_proc), timing only (OpenCV names patterns differently)
+    report("OpenCV cvtColor + assign", measure([&] {
+        cv::Mat rawImage(HEIGHT, WIDTH, CV_8UC1, bayer.data());
+        cv::Mat color;
+        cv::cvtColor(rawImage, color, cv::COLOR_BayerBG2RGB);
+        rgb.assign(color.data, color.data + color.total() * color.elemSize());
+    }));
+
+    for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON}) {
+        auto supported = true;
+
+        auto time = measure([&] {
+            supported = lirs::PixelConversion::bayer_to_rgb(level, lirs::BayerPattern::RGGB, lirs::RgbOrder::RGB,
+                                                            bayer.data(), WIDTH, rgb.data(), WIDTH * 3,
+                                                            WIDTH, HEIGHT);
+        });
+
+        if (supported) {
+            report(std::string{"PixelConversion "} + lirs::PixelConversion::simd_level_name(level), time);
+        }
+    }
+
+    std::cout << "\nBayer RGGB -> MONO8 " << WIDTH << 'x' << HEIGHT << '\n';
+
+    for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON}) {
+        auto supported = true;
+
+        auto time = measure([&] {
+            supported = lirs::PixelConversion::bayer_to_mono8(level, lirs::BayerPattern::RGGB, bayer.data(), WIDTH,
+                                                              mono.data(), WIDTH, WIDTH, HEIGHT);
+        });
+
+        if (supported) {
+            report(std::string{"PixelConversion "} + lirs::PixelConversion::simd_level_name(level), time);
+        }
+    }
+
+    std::vector<uint8_t> raw(WIDTH * HEIGHT * 2);
+    std::vector<uint8_t> raw16(WIDTH * HEIGHT * 2);
+
+    for (auto &byte : raw) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+
+    for (auto format : {lirs::RawFormat{lirs::RawPacking::MIPI10, 10}, lirs::RawFormat{lirs::RawPacking::MIPI12, 12},
+                        lirs::RawFormat{lirs::RawPacking::UNPACKED, 10}}) {
+
+        auto rawStep = format.packing == lirs::RawPacking::MIPI10 ? WIDTH * 5 / 4
+                                                                   : format.packing == lirs::RawPacking::MIPI12
+                                                                     ? WIDTH * 3 / 2 : WIDTH * 2;
+
+        std::cout << "\nRAW" << int{format.bits} << (format.packing == lirs::RawPacking::UNPACKED ? "" : " (MIPI)")
+                  << " -> 16-bit / MONO8 " << WIDTH << 'x' << HEIGHT << '\n';
+
+        for (auto level : {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2, lirs::SimdLevel::AVX2,
+                           lirs::SimdLevel::NEON}) {
+            auto supported = true;
+
+            auto unpackTime = measure([&] {
+                supported = lirs::PixelConversion::raw_to_16(level, format, raw.data(), rawStep,
+                                                             raw16.data(), WIDTH * 2, WIDTH, HEIGHT);
+            });
+
+            auto windowTime = measure([&] {
+                lirs::PixelConversion::raw_to_8(level, format, lirs::RawWindow{64, 960}, raw.data(), rawStep,
+                                                mono.data(), WIDTH, WIDTH, HEIGHT);
+            });
+
+            if (supported) {
+                report(std::string{"PixelConversion 16-bit "} + lirs::PixelConversion::simd_level_name(level),
+                       unpackTime);
+                report(std::string{"PixelConversion MONO8 "} + lirs::PixelConversion::simd_level_name(level),
+                       windowTime);
+            }
+        }
+    }
+
+    std::cout << "\nSelected at runtime: "
+              << lirs::PixelConversion::simd_level_name(lirs::PixelConversion::simd_level()) << '\n';
+}
@@ -0,0 +1,268 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <image_transport/image_transport.h>
+#include <camera_info_manager/camera_info_manager.h>
+
+#include "V4L2VideoCapture.hpp"
+#include "PixelConversion.hpp"
+#include "JpegDecodePool.hpp"
+#include "JpegEncoder.hpp"
+#include "VideoBitstream.hpp"
+#include "FramePool.hpp"
+#include "RosUtils.hpp"
+#include "StereoHalvesPublisher.hpp"
+#include "CompressedPublisher.hpp"
+#include "PacketPublisher.hpp"
+#include "DmaBufPublisher.hpp"
+
+namespace lirs {
+    namespace ros_utils {
+
+        /**
+         * @brief High bit depth v4l2 pixel format and image formats it could be published as.
+         */
+        struct RawSource final {
+            uint32_t v4l2PixFmt;
+            lirs::RawFormat format;
+            std::string imageFormat16;  // unpacked
+            std::string imageFormat8;   // windowed
+        };
+
+        /**
+         * @brief Encoded video source (camera's on-board encoder).
+         */
+        struct EncodedSource final {
+            uint32_t v4l2PixFmt;
+            lirs::VideoCodec codec;
+        };
+
+    }  // namespace ros_utils
+
+    /**
+     * @brief Captures a single camera and publishes its frames (parameters and topics of the video_streamer node).
+     *
+     * Parameters are read from the parameter handle's namespace, topics (image, camera_info, image/compressed,
+     * packets, etc.) are advertised in the node handle's one. Frames are read by the owner, i.e. by the publishing
+     * loop (ReadFrame()) or by the capture reactor serving many cameras (capture() is registered), and passed
+     * to Publish().
+     *
+     * Outputs besides the image topic (side-by-side halves, compressed images, packets and shared buffers) are
+     * published by their own publishers, the streamer converts frames and dispatches them.
+     *
+     * Images are published either by reference (serialized for each of the subscribers) or by shared pointers
+     * (zero-copy, i.e. nodelet subscribers loaded into the same manager receive the messages themselves).
+     *
+     * Non-copyable and non-movable.
+     */
+    class CameraStreamer final {
+    public:
+        /**
+         * @brief Validates parameters, opens the device and starts streaming (errors are logged).
+         *
+         * @param isZeroCopy images are published by shared pointers (messages are not overwritten while held).
+         */
+        CameraStreamer(ros::NodeHandle nodeHandle, ros::NodeHandle paramHandle, bool isZeroCopy = false);
+
+        /**
+         * @return true - if the camera is streaming, i.e. parameters are valid and the device is opened.
+         */
+        bool IsStreaming() const;
+
+        /**
+         * @brief Checks subscribers (and accepts clients of the shared buffers).
+         *
+         * Subscribers are counted only if changed (see the subscriber status callbacks). If lazy streaming is
+         * enabled, streaming is paused when there are no subscribers (after the standby delay, ready frames are
+         * discarded meanwhile) and resumed when the first one connects, time to the first published frame is reported.
+         *
+         * @return true - if there is anyone to publish frames to (and the camera is streaming).
+         */
+        bool UpdateSubscribers();
+
+        /**
+         * @brief Reads frame (blocks until the device signals the frame is ready or timeout).
+         *
+         * Frame is shared with the clients of the buffers (if any) before being returned.
+         */
+        std::optional<Frame> ReadFrame();
+
+        /**
+         * @brief Converts frame into the subscribed topics and publishes them.
+         *
+         * Frame (e.g. borrowed v4l2 buffer) is released before the raw image is published.
+         */
+        void Publish(Frame frame);
+
+        V4L2Capture &capture() {
+            return *capture_;
+        }
+
+        std::string const &cameraName() const {
+            return cameraName_;
+        }
+
+        bool isZeroCopy() const {
+            return isZeroCopy_;
+        }
+
+        CameraStreamer(CameraStreamer const &) = delete;
+
+        CameraStreamer &operator=(CameraStreamer const &) = delete;
+
+        CameraStreamer(CameraStreamer &&) = delete;
+
+        CameraStreamer &operator=(CameraStreamer &&) = delete;
+
+    private:
+        /* Reads parameters and configures the capture, false - if the parameters are invalid */
+        bool configure(ros::NodeHandle &paramHandle);
+
+        /* Advertises topics and preallocates messages */
+        void advertise();
+
+        /* Converts frame into the messages (compressed images and packets are published), returns capture time */
+        std::optional<std::chrono::nanoseconds> convert(Frame frame);
+
+        /* Subscriber status callbacks (spinner thread), subscribers are counted by the publishing thread */
+        void onSubscriberConnected();
+
+        void onSubscriberDisconnected();
+
+        /* Pauses or resumes streaming (lazy streaming), false - if the camera is not streaming */
+        bool updateStreaming(bool isActive);
+
+        /* Converts YUV 4:2:2 image (could be a strided view of the frame) into the message */
+        void convertYuv(uint8_t const *src, size_t srcStep, size_t srcSize, sensor_msgs::Image &imageMsg) const;
+
+        /* Copies frame off the v4l2 buffer (decoding workers could hold frames for a long time) */
+        Frame detach(Frame frame);
+
+        /* Frames are borrowed from the v4l2 buffers, i.e. not copied by the capture thread */
+        bool isBorrowingFrames() const;
+
+    private:
+        ros::NodeHandle nodeHandle_;
+
+        bool isZeroCopy_;
+
+        image_transport::ImageTransport imageTransport_;
+
+        std::string cameraName_;
+        std::string frameId_;
+        std::string cameraInfoUrl_;
+        std::string imageFormat_;
+
+        double latencyReportPeriod_;
+
+        int decodeThreads_;
+        int encodeThreads_;
+
+        std::string dmabufSocket_;
+        int dmabufFramesInFlight_;
+
+        bool isLazy_;
+        double standbyDelay_;
+
+        uint32_t pixFormat_;
+
+        std::optional<ros_utils::EncodedSource> encodedSource_;
+        std::optional<lirs::DecodedFormat> decodedFormat_;
+        std::optional<lirs::YuvToRgb> yuvToRgb_;
+        std::optional<ros_utils::RawSource> rawSource_;
+        lirs::RawWindow rawWindow_;
+        std::optional<lirs::BayerPattern> bayerPattern_;
+        std::string debayerFormat_;
+        std::optional<lirs::JpegEncoding> jpegEncoding_;
+
+        bool isSideBySide_;
+        std::string leftCameraInfoUrl_;
+        std::string rightCameraInfoUrl_;
+
+        std::unique_ptr<V4L2Capture> capture_;
+
+        bool isStreaming_;
+
+        /* Shares the capture's buffers, i.e. is destroyed before it */
+        std::unique_ptr<DmaBufPublisher> dmabufPublisher_;
+
+        std::unique_ptr<camera_info_manager::CameraInfoManager> cameraInfoManager_;
+        sensor_msgs::CameraInfo cameraInfoMsg_;
+
+        /* Reporters are used by the decoding workers, i.e. outlive them */
+        std::unique_ptr<ros_utils::LatencyReporter> latencyReporter_;
+
+        /* Image message data is preallocated and reused, i.e. no allocations per frame */
+        image_transport::CameraPublisher publisher_;
+        sensor_msgs::ImagePtr imageMsg_;
+
+        /* Shared messages (zero-copy), i.e. are published by the decoding workers and outlive them */
+        std::unique_ptr<ros_utils::ImageMessagePool> imagePool_;
+        std::unique_ptr<ros_utils::ImageMessagePool> debayerPool_;
+
+        /* Frames submitted to the decoding workers */
+        std::unique_ptr<FramePool> decodeFramePool_;
+
+        std::unique_ptr<JpegDecodePool> decodePool_;
+
+        std::unique_ptr<CompressedPublisher> compressedPublisher_;
+
+        std::unique_ptr<PacketPublisher> packetPublisher_;
+
+        /* Left and right halves of the side-by-side frame */
+        std::unique_ptr<StereoHalvesPublisher> halvesPublisher_;
+
+        image_transport::Publisher debayerPublisher_;
+        sensor_msgs::ImagePtr debayerMsg_;
+
+        /* Set by the subscriber status callbacks */
+        std::atomic_bool isSubscriptionChanged_;
+
+        /* Time the last subscriber connected at (steady clock, ns) */
+        std::atomic<int64_t> connectedAt_;
+
+        /* Lazy streaming: no subscribers since (warm standby), first frame after the first subscriber */
+        std::optional<std::chrono::steady_clock::time_point> idleSince_;
+        bool wasActive_;
+        bool isAwaitingFirstFrame_;
+        bool isResumed_;
+
+        bool hasRawSubscribers_;
+        bool hasDebayerSubscribers_;
+    };
+
+}  // namespace lirs
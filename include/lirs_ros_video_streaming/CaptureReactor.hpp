@@ -0,0 +1,120 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "VideoCapture.hpp"
+#include "V4L2VideoCapture.hpp"
+
+namespace lirs {
+
+    namespace capture_reactor_defaults {
+        /* Ready events handled per Poll() (the rest are reported by the next one) */
+        constexpr auto MAX_EVENTS = 16;
+    }
+
+    /**
+     * @brief Event loop capturing frames of many devices on a single thread.
+     *
+     * Event handles of the streaming captures (see V4L2Capture::eventHandle()) are registered
+     * with a single epoll instance, Poll() waits for any of them with a single syscall and dispatches
+     * ready frames to the captures' handlers. Waiting costs the same for any number of captures,
+     * each ready device costs a single frame dequeue (there is no per-device readiness check).
+     *
+     * Handlers are called on the polling thread, frames are borrowed (see V4L2Capture::ReadFrame()).
+     * Captures should outlive their registration and be re-added after the streaming restart.
+     */
+    class CaptureReactor final {
+    public:
+        using FrameHandler = std::function<void(Frame &&frame)>;
+
+        CaptureReactor();
+
+        ~CaptureReactor();
+
+        bool IsOpened() const;
+
+        /**
+         * @brief Registers streaming capture, its ready frames are passed to the handler.
+         *
+         * @return false - if the capture is not streaming or already registered.
+         */
+        bool Add(V4L2Capture &capture, FrameHandler handler);
+
+        /**
+         * @brief Unregisters capture (could be called from the handlers).
+         */
+        bool Remove(V4L2Capture const &capture);
+
+        /**
+         * @brief Waits for the ready frames and dispatches them (a frame per ready capture).
+         *
+         * Frames left in the captures' queues are dispatched by the next Poll() (events are level-triggered).
+         *
+         * @param timeout waiting time, zero - returns immediately.
+         * @return number of dispatched frames.
+         */
+        size_t Poll(std::chrono::milliseconds timeout);
+
+        size_t captureCount() const;
+
+        CaptureReactor(CaptureReactor const &) = delete;
+
+        CaptureReactor &operator=(CaptureReactor const &) = delete;
+
+        CaptureReactor(CaptureReactor &&) = delete;
+
+        CaptureReactor &operator=(CaptureReactor &&) = delete;
+
+    private:
+        struct Registration final {
+            /* Null if removed while dispatching */
+            V4L2Capture *capture;
+
+            int handle;
+
+            FrameHandler handler;
+        };
+
+        /* Erases registrations removed while dispatching */
+        void eraseRemoved();
+
+    private:
+        int epoll_;
+
+        bool isDispatching_;
+
+        /* Registrations are referenced by the epoll events, i.e. their addresses are stable */
+        std::vector<std::unique_ptr<Registration>> registrations_;
+    };
+
+}  // namespace lirs
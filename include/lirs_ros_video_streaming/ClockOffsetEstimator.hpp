@@ -0,0 +1,99 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace lirs {
+
+    namespace clock_offset_defaults {
+        /* Clock samples taken longer than that (e.g. due to preemption) are discarded */
+        constexpr auto MAX_SAMPLING_DURATION = std::chrono::microseconds{50};
+
+        /* Offset differences greater than that are considered as system clock steps (e.g. NTP) */
+        constexpr auto MAX_OFFSET_DRIFT = std::chrono::milliseconds{5};
+
+        /* Exponential smoothing factor is 1 / SMOOTHING */
+        constexpr auto SMOOTHING = 16;
+    }
+
+    /**
+     * @brief Continuously estimates offset between monotonic (steady) and system (wall) clocks.
+     *
+     * V4L2 drivers stamp buffers using CLOCK_MONOTONIC which has no relation to the epoch.
+     * Estimator converts such timestamps to the system clock taking into account
+     * slewing (smoothed) and steps (reset) of the system clock.
+     */
+    class ClockOffsetEstimator final {
+    public:
+        /**
+         * @brief Samples both clocks and updates the estimated offset.
+         *
+         * @return current offset estimate (system - monotonic).
+         */
+        std::chrono::nanoseconds update() {
+            using namespace clock_offset_defaults;
+
+            // bracket system clock reading with the monotonic ones
+            auto before = std::chrono::steady_clock::now().time_since_epoch();
+            auto wall = std::chrono::system_clock::now().time_since_epoch();
+            auto after = std::chrono::steady_clock::now().time_since_epoch();
+
+            if (after - before > MAX_SAMPLING_DURATION && initialized_) return offset_;
+
+            auto sample = std::chrono::duration_cast<std::chrono::nanoseconds>(wall - (before + (after - before) / 2));
+
+            if (!initialized_ || sample - offset_ > MAX_OFFSET_DRIFT || offset_ - sample > MAX_OFFSET_DRIFT) {
+                offset_ = sample;
+                initialized_ = true;
+            } else {
+                offset_ += (sample - offset_) / SMOOTHING;
+            }
+
+            return offset_;
+        }
+
+        std::chrono::nanoseconds offset() const {
+            return offset_;
+        }
+
+        /**
+         * @param monotonic time point of the monotonic clock (since its epoch).
+         * @return corresponding time point of the system clock (since epoch).
+         */
+        std::chrono::nanoseconds toSystemTime(std::chrono::nanoseconds monotonic) const {
+            return monotonic + offset_;
+        }
+
+    private:
+        bool initialized_ = false;
+
+        std::chrono::nanoseconds offset_{0};
+    };
+
+}  // namespace lirs
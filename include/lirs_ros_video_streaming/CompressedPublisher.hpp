@@ -0,0 +1,108 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <ros/ros.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include "JpegEncoder.hpp"
+#include "RosUtils.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief Publishes JPEG images on the compressed topic (image/compressed) instead of image_transport's plugin.
+     *
+     * Images are either captured (MJPEG source, published untouched) or compressed by the node right from the
+     * YUV 4:2:2 frames (in parallel stripes by the encoder threads, compression time is reported).
+     *
+     * Non-copyable and non-movable.
+     */
+    class CompressedPublisher final {
+    public:
+        /**
+         * @brief Disables image_transport's compressed plugin of the image topic and advertises the compressed one.
+         *
+         * Should be created before the image topic is advertised.
+         *
+         * @param encoding compression of the YUV 4:2:2 frames (none - JPEG images are captured).
+         */
+        CompressedPublisher(ros::NodeHandle &nodeHandle, std::string const &cameraName, std::string const &frameId,
+                            std::optional<JpegEncoding> const &encoding, size_t encodeThreads,
+                            double latencyReportPeriod, ros_utils::SubscriberCallbacks const &callbacks);
+
+        /**
+         * @brief Counts subscribers (on the subscription changes only).
+         *
+         * @return true - if the topic has subscribers.
+         */
+        bool UpdateSubscribers();
+
+        /**
+         * @brief Publishes captured JPEG image as is.
+         */
+        void Publish(uint8_t const *jpeg, size_t size, ros::Time const &stamp);
+
+        /**
+         * @brief Compresses YUV 4:2:2 image (blocks until all the stripes are done) and publishes it.
+         */
+        void Encode(uint8_t const *src, size_t srcStep, int width, int height, ros::Time const &stamp);
+
+        bool hasSubscribers() const {
+            return hasSubscribers_;
+        }
+
+        /**
+         * @return true - if images are compressed by the node.
+         */
+        bool isEncoding() const {
+            return static_cast<bool>(jpegEncoder_);
+        }
+
+        CompressedPublisher(CompressedPublisher const &) = delete;
+
+        CompressedPublisher &operator=(CompressedPublisher const &) = delete;
+
+        CompressedPublisher(CompressedPublisher &&) = delete;
+
+        CompressedPublisher &operator=(CompressedPublisher &&) = delete;
+
+    private:
+        ros::Publisher publisher_;
+        sensor_msgs::CompressedImagePtr compressedMsg_;
+
+        std::unique_ptr<JpegEncoder> jpegEncoder_;
+        ros_utils::LatencyReporter encodeReporter_;
+
+        bool hasSubscribers_;
+    };
+
+}  // namespace lirs
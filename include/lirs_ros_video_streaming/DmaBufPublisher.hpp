@@ -0,0 +1,87 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "V4L2VideoCapture.hpp"
+#include "DmaBufSharing.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief Shares the capture buffers with the same-host processes (no copy) before the frames are published.
+     *
+     * Clients must not hold the buffers the streamer and the driver need, thus at most the buffers count minus
+     * dmabuf_defaults::RESERVED_BUFFERS frames are in flight in total.
+     *
+     * Non-copyable and non-movable.
+     */
+    class DmaBufPublisher final {
+    public:
+        /**
+         * @param capture streaming device exporting its buffers (outlives the publisher).
+         * @param framesInFlight frames each of the clients could hold.
+         */
+        DmaBufPublisher(V4L2Capture &capture, std::string socketPath, size_t framesInFlight);
+
+        /**
+         * @return true - if clients could connect to the socket.
+         */
+        bool IsListening() const;
+
+        /**
+         * @brief Accepts new clients and handles released frames (does not block).
+         *
+         * @return true - if any client is connected.
+         */
+        bool UpdateClients();
+
+        /**
+         * @brief Reads frame (see V4L2Capture::ReadFrame()) and shares it with the connected clients.
+         */
+        std::optional<Frame> ReadFrame();
+
+        std::string const &socketPath() const {
+            return server_.socketPath();
+        }
+
+        DmaBufPublisher(DmaBufPublisher const &) = delete;
+
+        DmaBufPublisher &operator=(DmaBufPublisher const &) = delete;
+
+        DmaBufPublisher(DmaBufPublisher &&) = delete;
+
+        DmaBufPublisher &operator=(DmaBufPublisher &&) = delete;
+
+    private:
+        V4L2Capture &capture_;
+
+        DmaBufServer server_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,225 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "VideoCapture.hpp"
+#include "V4L2VideoCapture.hpp"
+
+namespace lirs {
+
+    namespace dmabuf_defaults {
+        /* Frames held by a single client (each one keeps a v4l2 buffer dequeued) */
+        constexpr auto DEFAULT_MAX_FRAMES_IN_FLIGHT = size_t{1};
+
+        constexpr auto MAX_CLIENTS = size_t{8};
+
+        /* Buffers never shared: the frame held by the streamer while publishing and the one left for capturing */
+        constexpr auto RESERVED_BUFFERS = size_t{2};
+
+        /* Frames held by all of the clients, i.e. the rest of the v4l2 buffers */
+        constexpr auto DEFAULT_MAX_TOTAL_FRAMES_IN_FLIGHT = v4l2_defaults::DEFAULT_V4L2_BUFFERS_NUM - RESERVED_BUFFERS;
+    }
+
+    /**
+     * @brief Local socket protocol of the dmabuf sharing (SOCK_SEQPACKET, i.e. one message per packet).
+     *
+     * Server sends FrameMessage per frame with the memory planes' dmabuf fds attached (SCM_RIGHTS, fdCount fds).
+     * Client maps the fds read-only, reads the planes and closes the fds, then replies with ReleaseMessage.
+     * Server keeps the v4l2 buffer dequeued until the release or the client's disconnection.
+     */
+    namespace dmabuf_protocol {
+        constexpr auto MAGIC = uint32_t{0x4c495253};  // "LIRS"
+
+        struct PlaneDescriptor final {
+            uint32_t memoryPlane;  // index of the attached fd
+            uint32_t offset;
+            uint32_t step;
+            uint32_t size;
+        };
+
+        struct FrameMessage final {
+            uint32_t magic;
+            uint32_t bufferIndex;
+            uint64_t frameId;
+            int64_t timestamp;  // nanoseconds since epoch (system clock)
+            uint32_t sequence;
+            uint32_t flags;
+            uint32_t width;
+            uint32_t height;
+            uint32_t pixelFormat;
+            uint32_t fdCount;
+            uint32_t planeCount;
+            PlaneDescriptor planes[MAX_FRAME_PLANES];
+        };
+
+        struct ReleaseMessage final {
+            uint32_t magic;
+            uint32_t reserved;
+            uint64_t frameId;
+        };
+    }
+
+    /**
+     * @brief Stream format announced with every shared frame.
+     */
+    struct DmaBufFormat final {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t pixelFormat = 0;
+    };
+
+    /**
+     * @brief Shares exported capture buffers with the same-host processes (zero-copy).
+     *
+     * Server is driven by the capturing thread: Poll() accepts clients and handles released frames,
+     * Publish() sends the frame to every client having less than maxFramesInFlight frames. Frames are held
+     * by the server while clients read them, thus all of the clients hold at most maxTotalFramesInFlight frames
+     * (i.e. the driver is not starved of buffers), the rest of the clients skip the frame.
+     *
+     * Non-copyable and non-movable.
+     */
+    class DmaBufServer final {
+    public:
+        /**
+         * @param socketPath path of the local socket (stale socket file is replaced).
+         * @param maxTotalFramesInFlight v4l2 buffers count minus dmabuf_defaults::RESERVED_BUFFERS.
+         */
+        DmaBufServer(std::string socketPath, DmaBufFormat format,
+                     size_t maxFramesInFlight = dmabuf_defaults::DEFAULT_MAX_FRAMES_IN_FLIGHT,
+                     size_t maxTotalFramesInFlight = dmabuf_defaults::DEFAULT_MAX_TOTAL_FRAMES_IN_FLIGHT);
+
+        /**
+         * @brief Disconnects clients (frames are released) and removes the socket file.
+         */
+        ~DmaBufServer();
+
+        bool IsListening() const;
+
+        /**
+         * @brief Accepts pending clients and handles released frames (does not block).
+         */
+        void Poll();
+
+        /**
+         * @return number of clients the frame has been sent to.
+         */
+        size_t Publish(DmaBufFrame const &frame);
+
+        size_t clientCount() const {
+            return clients_.size();
+        }
+
+        /**
+         * @return number of frames sent and not released yet.
+         */
+        size_t framesInFlight() const;
+
+        std::string const &socketPath() const {
+            return socketPath_;
+        }
+
+        DmaBufServer(DmaBufServer const &) = delete;
+
+        DmaBufServer &operator=(DmaBufServer const &) = delete;
+
+        DmaBufServer(DmaBufServer &&) = delete;
+
+        DmaBufServer &operator=(DmaBufServer &&) = delete;
+
+    private:
+        struct Client final {
+            int socket;
+
+            /* Frame copies keep the buffers dequeued until released */
+            std::map<uint64_t, Frame> inFlight;
+        };
+
+        /* Receives release messages, false - if the client has disconnected */
+        bool receiveReleases(Client &client);
+
+    private:
+        std::string const socketPath_;
+
+        DmaBufFormat const format_;
+
+        size_t const maxFramesInFlight_;
+
+        size_t const maxTotalFramesInFlight_;
+
+        int socket_;
+
+        uint64_t nextFrameId_;
+
+        /* Clients are served round-robin once the total limit is reached */
+        size_t firstClient_;
+
+        std::vector<Client> clients_;
+    };
+
+    /**
+     * @brief Shared frame received from the DmaBufServer.
+     */
+    struct SharedFrame final {
+        /* Borrows the mapped planes (see Frame::plane()), frame is released to the server with the last copy */
+        Frame frame;
+
+        DmaBufFormat format;
+    };
+
+    /**
+     * @brief Receives frames shared by the DmaBufServer.
+     */
+    class DmaBufClient final {
+    public:
+        /**
+         * @brief Connects to the server's socket, i.e. IsConnected() = true on success.
+         */
+        explicit DmaBufClient(std::string const &socketPath);
+
+        bool IsConnected() const;
+
+        /**
+         * @brief Waits for the next frame and maps its planes read-only.
+         *
+         * @return empty - on timeout, disconnection or malformed message.
+         */
+        std::optional<SharedFrame> Receive(std::chrono::milliseconds timeout);
+
+    private:
+        /* Socket is shared with the received frames in order to release them after the client is destroyed */
+        std::shared_ptr<int> socket_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,152 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <optional>
+
+#include "VideoCapture.hpp"
+
+namespace lirs {
+
+    namespace frame_pool_defaults {
+        constexpr auto DEFAULT_ALIGNMENT = size_t{64};  // cache line, enough for AVX-512 loads/stores
+
+        /* Room for the lease's control block (pointer, deleter and the allocator sharing the slot) */
+        constexpr auto LEASE_STORAGE_SIZE = size_t{64};
+    }
+
+    /**
+     * @brief Fixed-size pool of pre-allocated aligned frame buffers.
+     *
+     * Pool hands out frames which borrow its buffers (see Frame::isBorrowed()). Buffer returns back
+     * to the pool when the last copy of the frame is destroyed. Buffers are allocated once,
+     * so acquiring and releasing frames involves no heap allocations.
+     *
+     * Acquire() should be called from a single thread, frames could be released from any thread.
+     *
+     * Non-copyable and non-movable.
+     */
+    class FramePool final {
+    public:
+        /**
+         * @param bufferSize size of a single buffer in bytes (e.g. VideoCapture::imageSize()).
+         * @param capacity number of buffers.
+         * @param alignment buffer alignment in bytes (power of two).
+         */
+        FramePool(size_t bufferSize, size_t capacity,
+                  size_t alignment = frame_pool_defaults::DEFAULT_ALIGNMENT);
+
+        /**
+         * @brief Copies given data into a free buffer.
+         *
+         * @return empty - if there is no free buffers (pool is exhausted) or data does not fit in the buffer,
+         *         otherwise - frame borrowing the pool's buffer.
+         */
+        std::optional<Frame> Acquire(uint8_t const *data, size_t size);
+
+        /**
+         * @brief Acquires a free buffer to be filled by the caller (e.g. gathered from several planes).
+         *
+         * @return empty - if there is no free buffers or size exceeds the buffer size,
+         *         otherwise - frame of the given size borrowing the pool's buffer (contents are unspecified).
+         */
+        std::optional<Frame> Acquire(size_t size);
+
+        size_t bufferSize() const {
+            return bufferSize_;
+        }
+
+        size_t capacity() const {
+            return slots_.size();
+        }
+
+        /**
+         * @return number of buffers not borrowed by frames.
+         */
+        size_t available() const;
+
+        /**
+         * @return number of successfully acquired frames.
+         */
+        uint64_t acquiredCount() const {
+            return acquired_;
+        }
+
+        /**
+         * @return number of Acquire() calls failed due to the pool exhaustion.
+         */
+        uint64_t exhaustedCount() const {
+            return exhausted_;
+        }
+
+        FramePool(FramePool const &) = delete;
+
+        FramePool &operator=(FramePool const &) = delete;
+
+        FramePool(FramePool &&) = delete;
+
+        FramePool &operator=(FramePool &&) = delete;
+
+    private:
+        struct AlignedFree final {
+            void operator()(uint8_t *data) const {
+                std::free(data);
+            }
+        };
+
+        struct Slot final {
+            std::unique_ptr<uint8_t, AlignedFree> data;
+
+            /* Claimed by Acquire() (acquire), cleared once the last copy of the frame is destroyed (release) */
+            std::atomic_bool isBorrowed{false};
+
+            /* Lease's control block is placed here, i.e. no heap allocations per frame */
+            alignas(std::max_align_t) unsigned char leaseStorage[frame_pool_defaults::LEASE_STORAGE_SIZE];
+        };
+
+        /* Places the lease's control block into the slot, the slot is returned to the pool on its deallocation */
+        template<typename T>
+        struct LeaseAllocator;
+
+    private:
+        size_t bufferSize_;
+
+        size_t nextSlot_;
+
+        std::vector<std::shared_ptr<Slot>> slots_;
+
+        std::atomic_uint64_t acquired_;
+
+        std::atomic_uint64_t exhausted_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,153 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VideoCapture.hpp"
+#include "JpegDecoder.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief Pool of threads decoding JPEG frames (e.g. MJPEG capture) off the capture thread.
+     *
+     * Each worker owns its decoder and image buffer. Decoded images are delivered in the submission order,
+     * one at a time, from the worker threads. Frames are dropped rather than queued when all the workers are busy,
+     * so the latency never grows beyond a single decode.
+     *
+     * Non-copyable and non-movable.
+     */
+    class JpegDecodePool final {
+    public:
+        /**
+         * @brief Decoded image callback.
+         *
+         * Image buffer (step is width * decoded_channels()) could be swapped out (e.g. into a message),
+         * the worker resizes it back before the next decode.
+         */
+        using Callback = std::function<void(FrameInfo const &info, std::vector<uint8_t> &image)>;
+
+        /**
+         * @param threads number of worker threads (at least one).
+         * @param format decoded images format.
+         * @param width expected images width.
+         * @param height expected images height.
+         * @param callback called for each successfully decoded image.
+         */
+        JpegDecodePool(size_t threads, DecodedFormat format, int width, int height, Callback callback);
+
+        /**
+         * @brief Finishes pending decodes and joins the workers.
+         */
+        ~JpegDecodePool();
+
+        /**
+         * @brief Schedules the frame for decoding.
+         *
+         * Frame should not borrow the capture's memory for long (see VideoCapture's ReadFrameCopy()).
+         *
+         * @return true - if the frame has been scheduled, false - if all the workers are busy (frame is dropped).
+         */
+        bool Submit(Frame &&frame);
+
+        size_t threads() const {
+            return workers_.size();
+        }
+
+        /**
+         * @return number of frames dropped by Submit() because of busy workers.
+         */
+        uint64_t droppedCount() const {
+            return dropped_;
+        }
+
+        /**
+         * @return number of frames failed to decode (corrupted data or unexpected size).
+         */
+        uint64_t failedCount() const {
+            return failed_;
+        }
+
+        JpegDecodePool(JpegDecodePool const &) = delete;
+
+        JpegDecodePool &operator=(JpegDecodePool const &) = delete;
+
+        JpegDecodePool(JpegDecodePool &&) = delete;
+
+        JpegDecodePool &operator=(JpegDecodePool &&) = delete;
+
+    private:
+        struct Job final {
+            Frame frame;
+            uint64_t ticket;
+        };
+
+        void run(JpegDecoder decoder);
+
+    private:
+        int const width_;
+
+        int const height_;
+
+        size_t const step_;
+
+        Callback const callback_;
+
+        std::mutex mutex_;
+
+        /* Notifies workers about new jobs and stopping */
+        std::condition_variable jobsChanged_;
+
+        /* Notifies workers waiting for their turn to deliver */
+        std::condition_variable delivered_;
+
+        std::deque<Job> jobs_;
+
+        size_t busy_;
+
+        uint64_t nextTicket_;
+
+        uint64_t nextDelivery_;
+
+        bool isStopping_;
+
+        std::atomic_uint64_t dropped_;
+
+        std::atomic_uint64_t failed_;
+
+        std::vector<std::thread> workers_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,98 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace lirs {
+
+    /**
+     * @brief Pixel layout of the decoded JPEG images.
+     */
+    enum class DecodedFormat : uint8_t {
+        RGB8,
+        BGR8,
+        MONO8
+    };
+
+    /**
+     * @return number of bytes per decoded pixel.
+     */
+    constexpr int decoded_channels(DecodedFormat format) {
+        return format == DecodedFormat::MONO8 ? 1 : 3;
+    }
+
+    /**
+     * @brief Reusable JPEG decoder (libjpeg-turbo).
+     *
+     * Decompressor's state is allocated once and reused for all the images.
+     * Abbreviated MJPEG frames without Huffman tables (common for UVC cameras) are supported by libjpeg-turbo.
+     *
+     * Not thread-safe: each thread should use its own decoder. Non-copyable, movable.
+     */
+    class JpegDecoder final {
+    public:
+        explicit JpegDecoder(DecodedFormat format);
+
+        ~JpegDecoder();
+
+        /**
+         * @brief Decodes JPEG image into the destination buffer.
+         *
+         * @param jpeg compressed image data.
+         * @param size compressed image size in bytes.
+         * @param dst destination image, at least dstStep * height bytes.
+         * @param dstStep destination image line size in bytes.
+         * @param width expected image width.
+         * @param height expected image height.
+         * @return true - if the image has been decoded and its size is the expected one, otherwise - false.
+         */
+        bool Decode(uint8_t const *jpeg, size_t size, uint8_t *dst, size_t dstStep, int width, int height);
+
+        DecodedFormat format() const {
+            return format_;
+        }
+
+        JpegDecoder(JpegDecoder const &) = delete;
+
+        JpegDecoder &operator=(JpegDecoder const &) = delete;
+
+        JpegDecoder(JpegDecoder &&) noexcept;
+
+        JpegDecoder &operator=(JpegDecoder &&) noexcept;
+
+    private:
+        struct Decompressor;
+
+        DecodedFormat format_;
+
+        std::unique_ptr<Decompressor> decompressor_;
+    };
+
+}  // namespace lirs
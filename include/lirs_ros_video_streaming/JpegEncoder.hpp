@@ -0,0 +1,147 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PixelConversion.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief JPEG encoder settings.
+     */
+    struct JpegEncoding final {
+        YuvLayout layout = YuvLayout::YUYV;
+        ColorRange range = ColorRange::LIMITED;  // source range, JPEG stores full range
+        bool isGray = false;                     // only luma is encoded
+        int quality = 90;                        // [1, 100]
+    };
+
+    /**
+     * @brief Multithreaded JPEG encoder of the packed YUV 4:2:2 images (libjpeg-turbo).
+     *
+     * YUV 4:2:2 is encoded as is (4:2:2 chroma subsampling), i.e. there is no RGB intermediate.
+     * Image is split into horizontal stripes encoded in parallel, the stripes are joined
+     * by the restart markers into a single baseline JPEG. Color images are expected to be BT.601 (JFIF).
+     *
+     * Encode() should be called from a single thread. Non-copyable and non-movable.
+     */
+    class JpegEncoder final {
+    public:
+        /**
+         * @param threads number of threads encoding the stripes (including the calling one).
+         */
+        JpegEncoder(size_t threads, JpegEncoding encoding);
+
+        ~JpegEncoder();
+
+        /**
+         * @brief Encodes image blocking until all the stripes are done.
+         *
+         * @param src YUV 4:2:2 image (even width).
+         * @param srcStep source image line size in bytes.
+         * @param jpeg destination, its capacity is reused.
+         * @return true - if the image has been encoded, otherwise - false.
+         */
+        bool Encode(uint8_t const *src, size_t srcStep, int width, int height, std::vector<uint8_t> &jpeg);
+
+        size_t threads() const {
+            return compressors_.size();
+        }
+
+        JpegEncoding const &encoding() const {
+            return encoding_;
+        }
+
+        JpegEncoder(JpegEncoder const &) = delete;
+
+        JpegEncoder &operator=(JpegEncoder const &) = delete;
+
+        JpegEncoder(JpegEncoder &&) = delete;
+
+        JpegEncoder &operator=(JpegEncoder &&) = delete;
+
+    private:
+        struct Compressor;
+
+        struct Stripe final {
+            int firstRow = 0;
+            int rows = 0;
+            std::vector<uint8_t> jpeg;  // stripe encoded as a standalone image
+            bool isEncoded = false;
+        };
+
+        /* Encodes the stripes left in the current job */
+        void encodeStripes(Compressor &compressor);
+
+        bool encodeStripe(Compressor &compressor, Stripe &stripe);
+
+        void run(size_t compressorIndex);
+
+        bool join(std::vector<uint8_t> &jpeg, int height) const;
+
+    private:
+        JpegEncoding const encoding_;
+
+        std::vector<std::unique_ptr<Compressor>> compressors_;
+
+        /* Source values mapped onto the full range */
+        std::array<uint8_t, 256> lumaLut_;
+        std::array<uint8_t, 256> chromaLut_;
+
+        std::mutex mutex_;
+
+        /* Current job (guarded by the mutex) */
+        std::vector<Stripe> stripes_;
+        uint8_t const *src_;
+        size_t srcStep_;
+        int width_;
+        unsigned restartInterval_;
+        size_t nextStripe_;
+
+        std::condition_variable jobStarted_;
+
+        std::condition_variable stripesDone_;
+
+        uint64_t job_;
+
+        size_t doneStripes_;
+
+        bool isStopping_;
+
+        std::vector<std::thread> workers_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,76 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lirs {
+
+    /**
+     * @brief Routine used to copy frames out of the device (driver's) memory.
+     */
+    enum class CopyKernel : uint8_t {
+        GENERIC,         // memcpy
+        STREAMING_SSE41, // streaming loads (MOVNTDQA) and non-temporal stores of 16 bytes
+        STREAMING_AVX2   // streaming loads (VMOVNTDQA) and non-temporal stores of 32 bytes
+    };
+
+    /**
+     * @brief Copy kernels for the device memory.
+     *
+     * Mapped v4l2 buffers are often write-combined or uncached (e.g. CMA-backed buffers of the
+     * embedded capture devices), ordinary loads from them are performed byte by byte or line by line
+     * without prefetching, i.e. generic copy is several times slower than the one of the cached memory.
+     * Streaming loads fetch a whole cache line into the streaming load buffer instead, non-temporal
+     * stores write the copy around the caches. On the cached memory streaming loads behave as the
+     * ordinary ones, so the kernels are safe to use for any source. The best kernel supported
+     * by the CPU is selected at runtime.
+     */
+    struct MemoryCopy {
+
+        /**
+         * @return copy kernel used on this CPU.
+         */
+        static CopyKernel copy_kernel();
+
+        static char const *copy_kernel_name(CopyKernel kernel);
+
+        /**
+         * @brief Copies data out of the device memory (memory regions should not overlap).
+         */
+        static void from_device(uint8_t const *src, uint8_t *dst, size_t size);
+
+        /**
+         * @brief Copies data out of the device memory using the given kernel (for testing and benchmarks).
+         *
+         * @return false - if the kernel is not supported by the CPU.
+         */
+        static bool from_device(CopyKernel kernel, uint8_t const *src, uint8_t *dst, size_t size);
+    };
+
+}  // namespace lirs
@@ -0,0 +1,99 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <ros/ros.h>
+
+#include "VideoCapture.hpp"
+#include "VideoBitstream.hpp"
+#include "RosUtils.hpp"
+#include "lirs_ros_video_streaming/Packet.h"
+
+namespace lirs {
+
+    /**
+     * @brief Publishes access units of the camera's encoded stream (packets topic) as is, i.e. no decoding.
+     *
+     * Subscribers could not decode the stream until the keyframe, thus the stream starts with it (and restarts
+     * with the next one after AwaitKeyframe()).
+     *
+     * Non-copyable and non-movable.
+     */
+    class PacketPublisher final {
+    public:
+        /**
+         * @param width, height negotiated frame size (stream's resolution).
+         */
+        PacketPublisher(ros::NodeHandle &nodeHandle, std::string const &frameId, VideoCodec codec, uint32_t width,
+                        uint32_t height, ros_utils::SubscriberCallbacks const &callbacks);
+
+        /**
+         * @brief Counts subscribers (on the subscription changes only).
+         *
+         * @return true - if the topic has subscribers.
+         */
+        bool UpdateSubscribers();
+
+        /**
+         * @brief Publishes frame's access unit (keyframes are flagged by the driver or found in the bitstream).
+         *
+         * @return false - if the frame is dropped awaiting the keyframe.
+         */
+        bool Publish(Frame const &frame);
+
+        /**
+         * @brief Drops frames until the next keyframe (e.g. nobody has been receiving the stream).
+         */
+        void AwaitKeyframe() {
+            isAwaitingKeyframe_ = true;
+        }
+
+        bool hasSubscribers() const {
+            return hasSubscribers_;
+        }
+
+        PacketPublisher(PacketPublisher const &) = delete;
+
+        PacketPublisher &operator=(PacketPublisher const &) = delete;
+
+        PacketPublisher(PacketPublisher &&) = delete;
+
+        PacketPublisher &operator=(PacketPublisher &&) = delete;
+
+    private:
+        VideoCodec const codec_;
+
+        ros::Publisher publisher_;
+        lirs_ros_video_streaming::PacketPtr packetMsg_;
+
+        bool isAwaitingKeyframe_;
+        bool hasSubscribers_;
+    };
+
+}  // namespace lirs
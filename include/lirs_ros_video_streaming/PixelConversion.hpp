@@ -0,0 +1,269 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lirs {
+
+    /**
+     * @brief Instruction set used by the pixel conversion kernels.
+     */
+    enum class SimdLevel : uint8_t {
+        SCALAR,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    /**
+     * @brief Packed YUV 4:2:2 byte order.
+     */
+    enum class YuvLayout : uint8_t {
+        YUYV,
+        UYVY
+    };
+
+    /**
+     * @brief RGB output byte order.
+     */
+    enum class RgbOrder : uint8_t {
+        RGB,
+        BGR
+    };
+
+    /**
+     * @brief YCbCr to RGB conversion matrix.
+     */
+    enum class ColorMatrix : uint8_t {
+        BT601,  // SD
+        BT709   // HD
+    };
+
+    /**
+     * @brief YCbCr values range.
+     */
+    enum class ColorRange : uint8_t {
+        LIMITED,  // Y in [16, 235], Cb and Cr in [16, 240]
+        FULL      // all components in [0, 255]
+    };
+
+    /**
+     * @brief Bayer color filter array pattern (colors of the top-left 2x2 block).
+     */
+    enum class BayerPattern : uint8_t {
+        RGGB,
+        BGGR,
+        GRBG,
+        GBRG
+    };
+
+    /**
+     * @brief Storage of the high bit depth (10 to 16 bits) pixels.
+     */
+    enum class RawPacking : uint8_t {
+        UNPACKED,  // little-endian 16-bit words, value in the low bits (e.g. Y10, Y16, SRGGB12)
+        MIPI10,    // 4 pixels in 5 bytes: high 8 bits of each pixel followed by the low 2 bits (e.g. Y10P)
+        MIPI12     // 2 pixels in 3 bytes: high 8 bits of each pixel followed by the low 4 bits (e.g. SRGGB12P)
+    };
+
+    /**
+     * @brief High bit depth pixel format.
+     */
+    struct RawFormat final {
+        RawPacking packing = RawPacking::UNPACKED;
+        uint8_t bits = 16;  // significant bits (10 and 12 for MIPI packing)
+    };
+
+    /**
+     * @brief Range of raw values (in significant bits) mapped onto [0, 255].
+     */
+    struct RawWindow final {
+        uint16_t min = 0;
+        uint16_t max = UINT16_MAX;  // greater than min
+    };
+
+    /**
+     * @brief YUV 4:2:2 to RGB conversion settings.
+     */
+    struct YuvToRgb final {
+        YuvLayout layout = YuvLayout::YUYV;
+        RgbOrder order = RgbOrder::RGB;
+        ColorMatrix matrix = ColorMatrix::BT601;
+        ColorRange range = ColorRange::LIMITED;
+    };
+
+    /**
+     * @brief Pixel format conversion kernels.
+     *
+     * Kernels read directly from the captured frame and write into the preallocated destination
+     * (e.g. ROS image message data), there are no intermediate buffers. The best instruction set
+     * supported by the CPU is selected at runtime.
+     *
+     * Steps are line sizes in bytes (could be greater than the minimal ones due to the padding).
+     */
+    struct PixelConversion {
+
+        /**
+         * @return instruction set used by the kernels on this CPU.
+         */
+        static SimdLevel simd_level();
+
+        static char const *simd_level_name(SimdLevel level);
+
+        /**
+         * @brief Extracts luma (Y) from the packed YUYV 4:2:2 image into the MONO8 one.
+         *
+         * @param width image width in pixels (even).
+         */
+        static void yuyv_to_mono8(uint8_t const *src, size_t srcStep,
+                                  uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Extracts luma from YUYV image using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool yuyv_to_mono8(SimdLevel level, uint8_t const *src, size_t srcStep,
+                                  uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Swaps bytes of the packed YUYV 4:2:2 image producing the UYVY one (and vice versa).
+         *
+         * Swizzle is performed during the copy, i.e. at the memcpy-level cost.
+         *
+         * @param width image width in pixels (even).
+         */
+        static void yuyv_to_uyvy(uint8_t const *src, size_t srcStep,
+                                 uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Swaps bytes of the YUYV image using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool yuyv_to_uyvy(SimdLevel level, uint8_t const *src, size_t srcStep,
+                                 uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Converts packed YUV 4:2:2 (YUYV or UYVY) image into the packed RGB (rgb8 or bgr8) one.
+         *
+         * Conversion uses 16-bit fixed-point arithmetic (6 fractional bits), results are within
+         * 2 levels of the floating-point conversion.
+         *
+         * @param width image width in pixels (even).
+         */
+        static void yuv422_to_rgb(YuvToRgb const &conversion, uint8_t const *src, size_t srcStep,
+                                  uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Converts YUV 4:2:2 image into RGB using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool yuv422_to_rgb(SimdLevel level, YuvToRgb const &conversion, uint8_t const *src, size_t srcStep,
+                                  uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Unpacks high bit depth image into the 16-bit one (mono16, bayer_*16).
+         *
+         * Values are shifted to the most significant bits (e.g. 10-bit 1023 becomes 65472),
+         * so that 16-bit consumers see the full brightness range.
+         *
+         * @param width image width in pixels (multiple of 4 for MIPI10, even for MIPI12).
+         */
+        static void raw_to_16(RawFormat format, uint8_t const *src, size_t srcStep,
+                              uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Unpacks high bit depth image using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool raw_to_16(SimdLevel level, RawFormat format, uint8_t const *src, size_t srcStep,
+                              uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Maps the window of high bit depth values linearly onto the 8-bit image (mono8, bayer_*8).
+         *
+         * Values outside of the window are saturated, results are within 1 level of the exact mapping.
+         *
+         * @param width image width in pixels (multiple of 4 for MIPI10, even for MIPI12).
+         */
+        static void raw_to_8(RawFormat format, RawWindow window, uint8_t const *src, size_t srcStep,
+                             uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Windows high bit depth image using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool raw_to_8(SimdLevel level, RawFormat format, RawWindow window, uint8_t const *src,
+                             size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Demosaics 8-bit Bayer image into the packed RGB (rgb8 or bgr8) one.
+         *
+         * Missing colors are bilinearly interpolated from the nearest neighbours,
+         * image borders are reflected.
+         *
+         * @param width image width in pixels (at least 2).
+         * @param height image height in pixels (at least 2).
+         */
+        static void bayer_to_rgb(BayerPattern pattern, RgbOrder order, uint8_t const *src, size_t srcStep,
+                                 uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Demosaics Bayer image into RGB using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool bayer_to_rgb(SimdLevel level, BayerPattern pattern, RgbOrder order, uint8_t const *src,
+                                 size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Demosaics 8-bit Bayer image into the MONO8 one.
+         *
+         * Intensity is approximated as (R + 2G + B) / 4 of the bilinearly interpolated colors.
+         *
+         * @param width image width in pixels (at least 2).
+         * @param height image height in pixels (at least 2).
+         */
+        static void bayer_to_mono8(BayerPattern pattern, uint8_t const *src, size_t srcStep,
+                                   uint8_t *dst, size_t dstStep, int width, int height);
+
+        /**
+         * @brief Demosaics Bayer image into MONO8 using the given instruction set (for testing and benchmarks).
+         *
+         * @return false - if the instruction set is not supported by the CPU.
+         */
+        static bool bayer_to_mono8(SimdLevel level, BayerPattern pattern, uint8_t const *src, size_t srcStep,
+                                   uint8_t *dst, size_t dstStep, int width, int height);
+    };
+
+}  // namespace lirs
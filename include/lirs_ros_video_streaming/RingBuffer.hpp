@@ -0,0 +1,157 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace lirs {
+
+    /**
+     * @brief Bounded lock-free ring of elements passed from the producer to the consumer.
+     *
+     * Designed for a single producer and a single consumer. In addition, the producer is allowed
+     * to TryPop() in order to drop the oldest element when the ring is full. Each slot carries
+     * its own sequence number, thus the slot's element is never accessed by two threads at once.
+     *
+     * Capacity is rounded up to the power of two.
+     */
+    template<typename T>
+    class RingBuffer final {
+    public:
+        explicit RingBuffer(size_t capacity)
+                : mask_{capacityFor(capacity) - 1},
+                  slots_{std::make_unique<Slot[]>(mask_ + 1)},
+                  head_{0}, tail_{0} {
+            for (auto i = size_t{0}; i <= mask_; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @return true - if the element is pushed, false - if the ring is full.
+         */
+        bool TryPush(T &&value) {
+            auto position = tail_.load(std::memory_order_relaxed);
+
+            for (;;) {
+                auto &slot = slots_[position & mask_];
+                auto sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;  // full
+                } else {
+                    position = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @return empty - if the ring is empty, otherwise - the oldest element.
+         */
+        std::optional<T> TryPop() {
+            auto position = head_.load(std::memory_order_relaxed);
+
+            for (;;) {
+                auto &slot = slots_[position & mask_];
+                auto sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+                if (diff == 0) {
+                    if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        auto value = std::move(slot.value);
+                        slot.value.reset();
+                        slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                        return value;
+                    }
+                } else if (diff < 0) {
+                    return std::nullopt;  // empty
+                } else {
+                    position = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @return approximate number of elements (exact if neither thread modifies the ring).
+         */
+        size_t size() const {
+            auto tail = tail_.load(std::memory_order_acquire);
+            auto head = head_.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        size_t capacity() const {
+            return mask_ + 1;
+        }
+
+        /**
+         * @return capacity of the ring created for the requested one, i.e. the nearest power of two.
+         */
+        static size_t capacityFor(size_t capacity) {
+            auto result = size_t{1};
+            while (result < capacity) result <<= 1u;
+            return result;
+        }
+
+        void clear() {
+            while (TryPop());
+        }
+
+        RingBuffer(RingBuffer const &) = delete;
+
+        RingBuffer &operator=(RingBuffer const &) = delete;
+
+    private:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        struct Slot final {
+            std::atomic_size_t sequence{0};
+            std::optional<T> value;
+        };
+
+    private:
+        size_t const mask_;
+
+        std::unique_ptr<Slot[]> slots_;
+
+        /* Consumer and producer positions are kept on separate cache lines to avoid false sharing */
+        alignas(CACHE_LINE_SIZE) std::atomic_size_t head_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic_size_t tail_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,180 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <image_transport/image_transport.h>
+
+#include "VideoCapture.hpp"
+
+namespace lirs {
+    namespace ros_utils {
+
+        /**
+         * @brief Accumulates latency (e.g. capture-to-publish) and reports it periodically.
+         *
+         * Thread-safe: images could be published from the decoding threads.
+         */
+        class LatencyReporter final {
+        public:
+            LatencyReporter(std::string name, double periodSeconds)
+                    : name_{std::move(name)}, period_{periodSeconds}, lastReport_{ros::Time::now()} {}
+
+            /**
+             * @brief Adds latency since the capture time.
+             */
+            void add(ros::Time const &captured) {
+                if (period_.isZero()) return;
+
+                add(ros::Time::now() - captured);
+            }
+
+            void add(ros::Duration const &latency) {
+                if (period_.isZero()) return;
+
+                std::lock_guard<std::mutex> lock{mutex_};
+
+                auto now = ros::Time::now();
+
+                sum_ += latency;
+                max_ = std::max(max_, latency);
+                ++count_;
+
+                if (now - lastReport_ >= period_) {
+                    ROS_INFO_STREAM(name_ << " (ms): mean = " << sum_.toSec() * 1e3 / count_
+                                          << ", max = " << max_.toSec() * 1e3 << " over " << count_ << " frames");
+                    sum_ = max_ = ros::Duration{};
+                    count_ = 0;
+                    lastReport_ = now;
+                }
+            }
+
+        private:
+            std::mutex mutex_;
+
+            std::string name_;
+            ros::Duration period_;
+            ros::Time lastReport_;
+
+            ros::Duration sum_;
+            ros::Duration max_;
+            uint64_t count_ = 0;
+        };
+
+        /**
+         * @brief Image messages published by shared pointers (intra-process subscribers receive the message itself).
+         *
+         * Subscribers could hold the published message for any time, thus it is not overwritten until released by
+         * all of them. Released messages are reused (no allocations per frame), at most MAX_MESSAGES are kept.
+         *
+         * Thread-safe: images could be published from the decoding threads.
+         */
+        class ImageMessagePool final {
+        public:
+            static constexpr auto MAX_MESSAGES = size_t{8};
+
+            /**
+             * @param prototype header and layout of the messages (data is sized alike).
+             */
+            explicit ImageMessagePool(sensor_msgs::Image const &prototype)
+                    : prototype_{prototype}, dataSize_{prototype.data.size()} {
+                prototype_.data = {};
+            }
+
+            /**
+             * @brief Acquires the message not referenced by anyone else (the caller's previous one is to be reset).
+             */
+            sensor_msgs::ImagePtr acquire() {
+                std::lock_guard<std::mutex> lock{mutex_};
+
+                for (auto const &message : messages_) {
+                    if (message.unique()) return message;
+                }
+
+                auto message = boost::make_shared<sensor_msgs::Image>(prototype_);
+                message->data.resize(dataSize_);
+
+                if (messages_.size() < MAX_MESSAGES) {
+                    messages_.push_back(message);  // otherwise subscribers hold all of them, message is not reused
+                }
+
+                return message;
+            }
+
+        private:
+            std::mutex mutex_;
+
+            sensor_msgs::Image prototype_;
+            size_t dataSize_;
+
+            std::vector<sensor_msgs::ImagePtr> messages_;
+        };
+
+        /**
+         * @brief Subscriber status callbacks shared by the camera's topics (subscribers are counted on changes only).
+         */
+        struct SubscriberCallbacks final {
+            ros::SubscriberStatusCallback onConnect;
+            ros::SubscriberStatusCallback onDisconnect;
+            image_transport::SubscriberStatusCallback onImageConnect;
+            image_transport::SubscriberStatusCallback onImageDisconnect;
+        };
+
+        /**
+         * @brief Converts frame's capture time (system clock) into ROS time.
+         */
+        inline ros::Time rosTimeFrom(std::chrono::nanoseconds timestamp) {
+            return ros::Time().fromNSec(static_cast<uint64_t>(timestamp.count()));
+        }
+
+        /**
+         * @brief Creates camera info of the uncalibrated camera (principal point at the image center).
+         */
+        sensor_msgs::CameraInfo defaultCameraInfoFrom(sensor_msgs::ImagePtr const &img);
+
+        /**
+         * @brief Creates message for the image converted in the node (no padding).
+         */
+        sensor_msgs::ImagePtr convertedImageMessageFrom(std::string const &frameId, std::string const &imageFormat,
+                                                        lirs::VideoCapture const &capture);
+
+        /**
+         * @brief Publishes image and camera info by shared pointers (zero-copy).
+         */
+        void publishShared(image_transport::CameraPublisher const &publisher,
+                           sensor_msgs::CameraInfo const &cameraInfoMsg,
+                           sensor_msgs::ImagePtr const &imageMsg, ros::Time const &stamp);
+
+    }  // namespace ros_utils
+}  // namespace lirs
@@ -0,0 +1,118 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+#include <image_transport/image_transport.h>
+#include <camera_info_manager/camera_info_manager.h>
+
+#include "VideoCapture.hpp"
+#include "RosUtils.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief Publishes halves of the side-by-side stereo frame (YUV 4:2:2) as the left and right cameras.
+     *
+     * Each half is a separate camera (left/image_raw, left/camera_info, left/set_camera_info, etc.). Halves are
+     * converted right from the strided views of the frame (a single pass), frame width must be divisible by 4.
+     *
+     * Non-copyable and non-movable.
+     */
+    class StereoHalvesPublisher final {
+    public:
+        /* Converts YUV 4:2:2 image (strided view of the frame) into the message: src, srcStep, srcSize, message */
+        using ConvertCallback = std::function<void(uint8_t const *, size_t, size_t, sensor_msgs::Image &)>;
+
+        /**
+         * @brief Advertises topics of the halves and preallocates their messages.
+         *
+         * @param cameraInfoUrls calibration of the left and right cameras (uncalibrated if empty).
+         * @param capture streaming device, halves are sized from the negotiated format.
+         * @param isZeroCopy images are published by shared pointers (messages are not overwritten while held).
+         */
+        StereoHalvesPublisher(ros::NodeHandle const &nodeHandle, image_transport::ImageTransport &imageTransport,
+                              std::string const &cameraName, std::string const &frameId,
+                              std::string const &imageFormat, std::array<std::string, 2> const &cameraInfoUrls,
+                              lirs::VideoCapture const &capture, bool isZeroCopy,
+                              ros_utils::SubscriberCallbacks const &callbacks, ConvertCallback convert);
+
+        /**
+         * @brief Counts subscribers of the halves (on the subscription changes only).
+         *
+         * @return true - if any of the halves has subscribers.
+         */
+        bool UpdateSubscribers();
+
+        /**
+         * @brief Converts the subscribed halves of the frame into their messages.
+         */
+        void Convert(Frame const &frame, size_t srcStep);
+
+        /**
+         * @brief Publishes the subscribed halves stamped with the frame's capture time.
+         */
+        void Publish(ros::Time const &stamp);
+
+        StereoHalvesPublisher(StereoHalvesPublisher const &) = delete;
+
+        StereoHalvesPublisher &operator=(StereoHalvesPublisher const &) = delete;
+
+        StereoHalvesPublisher(StereoHalvesPublisher &&) = delete;
+
+        StereoHalvesPublisher &operator=(StereoHalvesPublisher &&) = delete;
+
+    private:
+        /* Half of the frame published as a separate camera (left or right) */
+        struct Half final {
+            std::unique_ptr<camera_info_manager::CameraInfoManager> cameraInfoManager;
+            sensor_msgs::CameraInfo cameraInfoMsg;
+
+            image_transport::CameraPublisher publisher;
+            sensor_msgs::ImagePtr imageMsg;
+
+            /* Shared messages (zero-copy) */
+            std::unique_ptr<ros_utils::ImageMessagePool> imagePool;
+
+            /* Offset of the half's first column in the frame's row (bytes) */
+            size_t offset = 0;
+
+            bool hasSubscribers = false;
+        };
+
+    private:
+        std::array<Half, 2> halves_;
+
+        ConvertCallback convert_;
+    };
+
+}  // namespace lirs
@@ -0,0 +1,129 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <optional>
+
+#include "VideoCapture.hpp"
+
+namespace lirs {
+
+    namespace stereo_pairing_defaults {
+        /* Frames waiting for the other camera's one (borrowed frames hold the capture's buffers) */
+        constexpr auto MAX_PENDING_FRAMES = size_t{2};
+    }
+
+    enum class StereoSide : uint8_t {
+        LEFT = 0,
+        RIGHT = 1
+    };
+
+    /**
+     * @brief Left and right frames captured at the same time (within the tolerance).
+     *
+     * Both frames are stamped with the same capture time (midpoint of their capture times).
+     */
+    struct StereoPair final {
+        Frame left;
+        Frame right;
+
+        /* Right frame's capture time minus the left one's */
+        std::chrono::nanoseconds skew;
+    };
+
+    /**
+     * @brief Pairing statistics (indexed by StereoSide).
+     */
+    struct StereoPairingStats final {
+        uint64_t pairs = 0;
+
+        /* Frames discarded with no frame of the other camera within the tolerance */
+        std::array<uint64_t, 2> unpaired{};
+
+        /* Frames dropped by the drivers (gaps of the sequence numbers) */
+        std::array<uint64_t, 2> dropped{};
+
+        /* Sum and maximum of the absolute skew of the pairs */
+        std::chrono::nanoseconds skewSum{0};
+        std::chrono::nanoseconds maxSkew{0};
+    };
+
+    /**
+     * @brief Pairs frames of two cameras by their capture (driver) timestamps.
+     *
+     * Cameras deliver frames in the capture order, thus frame is paired with the closest frame of the other
+     * camera captured within the tolerance, the other camera's earlier frames could not be paired anymore and
+     * are discarded. Frame waits for its mate unless the MAX_PENDING_FRAMES newer frames of the same camera
+     * arrive first. Gaps of the driver's sequence numbers are counted as the dropped frames.
+     *
+     * Should be used from a single thread.
+     */
+    class StereoPairing final {
+    public:
+        /**
+         * @param tolerance maximum difference of the capture times of the paired frames.
+         */
+        explicit StereoPairing(std::chrono::nanoseconds tolerance,
+                               size_t maxPendingFrames = stereo_pairing_defaults::MAX_PENDING_FRAMES);
+
+        /**
+         * @brief Pairs frame with the other camera's pending one.
+         *
+         * @return pair - if the mate is found, empty - frame is pending.
+         */
+        std::optional<StereoPair> Push(StereoSide side, Frame frame);
+
+        /**
+         * @brief Discards pending frames (e.g. streaming is stopped) and sequence numbers.
+         */
+        void Reset();
+
+        StereoPairingStats const &stats() const;
+
+        void resetStats();
+
+        size_t pendingCount(StereoSide side) const;
+
+        std::chrono::nanoseconds tolerance() const;
+
+    private:
+        std::chrono::nanoseconds tolerance_;
+        size_t maxPendingFrames_;
+
+        /* Pending frames of each camera in the capture order */
+        std::array<std::deque<Frame>, 2> pending_;
+
+        std::array<std::optional<uint32_t>, 2> lastSequence_;
+
+        StereoPairingStats stats_;
+    };
+
+}  // namespace lirs
@@ -31,14 +31,17 @@
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <poll.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
 #include <cstring>
 
 #include <optional>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <set>
 
 namespace lirs {
@@ -48,6 +51,24 @@ namespace lirs {
         constexpr auto V4L2_MAX_BUFFER_SIZE = 32;
     }
 
+    /**
+     * @brief Line and image sizes of the v4l2 buffer's memory plane (single-planar buffers have one).
+     */
+    struct V4L2PlaneFormat final {
+        size_t step = 0;
+        size_t size = 0;
+    };
+
+    /**
+     * @brief Image plane (e.g. Y or CbCr) located in the memory plane of the v4l2 buffer.
+     */
+    struct V4L2ImagePlane final {
+        size_t memoryPlane = 0;
+        size_t offset = 0;  // within the memory plane
+        size_t step = 0;
+        size_t size = 0;
+    };
+
     struct V4L2Utils {
         static constexpr auto ERROR_CODE = -1;
 
@@ -55,13 +76,20 @@ namespace lirs {
         static constexpr auto SELECT_TIMEOUT_MICROSECONDS = 0;
         static constexpr auto SELECT_NUM_OF_READY_DEVICES = 1;
 
+        // Waits until the handle becomes readable, i.e. the frame is ready (poll is not limited by FD_SETSIZE)
         static inline bool v4l2_is_readable(int handle,
                                             timeval timeout = {SELECT_TIMEOUT_SECONDS, SELECT_TIMEOUT_MICROSECONDS}) {
-            fd_set fds{};
-            FD_ZERO(&fds);
-            FD_SET(handle, &fds);
+            pollfd pollHandle{handle, POLLIN, 0};
+
+            // sub-millisecond timeouts are rounded up (not to poll without waiting)
+            auto timeoutMs = static_cast<int>(timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000);
+
+            int status{0};
+            do {
+                status = poll(&pollHandle, 1, timeoutMs);
+            } while (status == ERROR_CODE && errno == EINTR);
 
-            return select(handle + 1, &fds, nullptr, nullptr, &timeout) == SELECT_NUM_OF_READY_DEVICES;
+            return status == SELECT_NUM_OF_READY_DEVICES && (pollHandle.revents & POLLIN);
         }
 
         static inline int xioctl(int handle, size_t request, void *arg) {
@@ -108,11 +136,12 @@ namespace lirs {
             return true;
         }
 
-        static std::set<uint32_t> v4l2_query_pixel_formats(int fd) {
+        static std::set<uint32_t> v4l2_query_pixel_formats(int fd,
+                                                           uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
             std::set<uint32_t> pixelFormats;
 
             v4l2_fmtdesc desc{};
-            desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            desc.type = bufferType;
 
             while (V4L2Utils::xioctl(fd, VIDIOC_ENUM_FMT, &desc) != ERROR_CODE) {
                 ++desc.index;
@@ -122,6 +151,21 @@ namespace lirs {
             return pixelFormats;
         }
 
+        // Checks if the pixel format is compressed, i.e. frames have variable size (e.g. MJPEG)
+        static bool v4l2_is_compressed_format(int fd, uint32_t pixFmt,
+                                              uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            v4l2_fmtdesc desc{};
+            desc.type = bufferType;
+
+            for (; V4L2Utils::xioctl(fd, VIDIOC_ENUM_FMT, &desc) != ERROR_CODE; ++desc.index) {
+                if (desc.pixelformat == pixFmt) {
+                    return (desc.flags & V4L2_FMT_FLAG_COMPRESSED) != 0;
+                }
+            }
+
+            return false;
+        }
+
         static bool v4l2_check_input_capabilities(int handle) {
             v4l2_input v4l2Input{};
 
@@ -155,8 +199,23 @@ namespace lirs {
             return {capability};
         }
 
+        // Capabilities of the opened device node (not of the whole physical device)
+        static uint32_t v4l2_device_capabilities(v4l2_capability const &caps) {
+            return caps.capabilities & V4L2_CAP_DEVICE_CAPS ? caps.device_caps : caps.capabilities;
+        }
+
+        // Selects single-planar capture if supported, otherwise multi-planar one
+        static std::optional<uint32_t> v4l2_capture_buffer_type(v4l2_capability const &caps) {
+            auto deviceCaps = v4l2_device_capabilities(caps);
+
+            if (deviceCaps & V4L2_CAP_VIDEO_CAPTURE) return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            if (deviceCaps & V4L2_CAP_VIDEO_CAPTURE_MPLANE) return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+
+            return std::nullopt;
+        }
+
         static bool v4l2_check_capabilities(v4l2_capability const &caps, uint32_t requiredCaps) {
-            if (!(caps.capabilities & requiredCaps)) {
+            if (!(v4l2_device_capabilities(caps) & requiredCaps)) {
                 std::cerr << "ERROR: Device does not support required capabilities\n";
                 return false;
             }
@@ -168,24 +227,50 @@ namespace lirs {
             return true;
         }
 
+        // Creates single-planar or multi-planar format request
+        static v4l2_format v4l2_format_request(uint32_t bufferType, uint32_t pixFmt, int width, int height) {
+            v4l2_format format{};
+            format.type = bufferType;
+
+            if (V4L2_TYPE_IS_MULTIPLANAR(bufferType)) {
+                format.fmt.pix_mp.field = V4L2_FIELD_ANY;
+                format.fmt.pix_mp.pixelformat = pixFmt;
+                format.fmt.pix_mp.width = static_cast<uint32_t >(width);
+                format.fmt.pix_mp.height = static_cast<uint32_t >(height);
+            } else {
+                format.fmt.pix.field = V4L2_FIELD_ANY;
+                format.fmt.pix.pixelformat = pixFmt;
+                format.fmt.pix.width = static_cast<uint32_t >(width);
+                format.fmt.pix.height = static_cast<uint32_t >(height);
+            }
+
+            return format;
+        }
+
+        static bool v4l2_format_matches(v4l2_format const &format, uint32_t pixFmt, int width, int height) {
+            if (V4L2_TYPE_IS_MULTIPLANAR(format.type)) {
+                return format.fmt.pix_mp.pixelformat == pixFmt
+                       && format.fmt.pix_mp.width == static_cast<uint32_t >(width)
+                       && format.fmt.pix_mp.height == static_cast<uint32_t >(height);
+            }
+
+            return format.fmt.pix.pixelformat == pixFmt
+                   && format.fmt.pix.width == static_cast<uint32_t >(width)
+                   && format.fmt.pix.height == static_cast<uint32_t >(height);
+        }
+
         // Checks if given format is supported on v4l2 device w/o interrupting video capturing
         static std::optional<v4l2_format> v4l2_try_format(int handle, uint32_t pixFmt,
-                                                          int width, int height) {
-            v4l2_format format{};
-            format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            format.fmt.pix.field = V4L2_FIELD_ANY;
-            format.fmt.pix.pixelformat = pixFmt;
-            format.fmt.pix.width = static_cast<uint32_t >(width);
-            format.fmt.pix.height = static_cast<uint32_t >(height);
+                                                          int width, int height,
+                                                          uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            auto format = v4l2_format_request(bufferType, pixFmt, width, height);
 
             if (V4L2Utils::xioctl(handle, VIDIOC_TRY_FMT, &format) == ERROR_CODE) {
                 std::cerr << "ERROR: VIDIOC_TRY_FMT - " << strerror(errno) << '\n';
                 return std::nullopt;
             }
 
-            if (format.fmt.pix.pixelformat != pixFmt
-                || format.fmt.pix.width != static_cast<uint32_t >(width)
-                || format.fmt.pix.height != static_cast<uint32_t >(height)) {
+            if (!v4l2_format_matches(format, pixFmt, width, height)) {
                 return std::nullopt;
             }
 
@@ -194,31 +279,98 @@ namespace lirs {
 
         // Sets given format to the v4l2 device (device should not be in streaming mode)
         static std::optional<v4l2_format> v4l2_set_format(int handle, uint32_t pixFmt,
-                                                          int width, int height) {
-            v4l2_format format{};
-            format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            format.fmt.pix.field = V4L2_FIELD_ANY;
-            format.fmt.pix.pixelformat = pixFmt;
-            format.fmt.pix.width = static_cast<uint32_t >(width);
-            format.fmt.pix.height = static_cast<uint32_t >(height);
+                                                          int width, int height,
+                                                          uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            auto format = v4l2_format_request(bufferType, pixFmt, width, height);
 
             if (V4L2Utils::xioctl(handle, VIDIOC_S_FMT, &format) == ERROR_CODE) {
                 std::cerr << "ERROR: VIDIOC_S_FMT - " << strerror(errno) << '\n';
                 return std::nullopt;
             }
 
-            if (format.fmt.pix.pixelformat != pixFmt
-                || format.fmt.pix.width != static_cast<uint32_t >(width)
-                || format.fmt.pix.height != static_cast<uint32_t >(height)) {
+            if (!v4l2_format_matches(format, pixFmt, width, height)) {
                 return std::nullopt;
             }
 
             return {format};
         }
 
-        static std::optional<v4l2_format> v4l2_get_current_format(int handle) {
+        // Extracts line and image sizes of each memory plane
+        static std::vector<V4L2PlaneFormat> v4l2_plane_formats(v4l2_format const &format) {
+            if (!V4L2_TYPE_IS_MULTIPLANAR(format.type)) {
+                return {V4L2PlaneFormat{format.fmt.pix.bytesperline, format.fmt.pix.sizeimage}};
+            }
+
+            std::vector<V4L2PlaneFormat> planes;
+
+            for (auto i = 0u; i < format.fmt.pix_mp.num_planes && i < VIDEO_MAX_PLANES; ++i) {
+                planes.push_back(V4L2PlaneFormat{format.fmt.pix_mp.plane_fmt[i].bytesperline,
+                                                 format.fmt.pix_mp.plane_fmt[i].sizeimage});
+            }
+
+            return planes;
+        }
+
+        // Locates image planes in the memory planes, e.g. NV12 stores Y and CbCr planes in a single memory plane
+        // while NV12M stores them in the separate ones. Unknown formats consist of the memory planes.
+        static std::vector<V4L2ImagePlane> v4l2_image_planes(uint32_t pixFmt, int height,
+                                                             std::vector<V4L2PlaneFormat> const &memoryPlanes) {
+            std::vector<V4L2ImagePlane> planes;
+
+            if (memoryPlanes.size() != 1) {
+                for (auto i = size_t{0}; i < memoryPlanes.size(); ++i) {
+                    planes.push_back(V4L2ImagePlane{i, 0, memoryPlanes[i].step, memoryPlanes[i].size});
+                }
+                return planes;
+            }
+
+            auto const step = memoryPlanes[0].step;
+            auto const lumaSize = step * static_cast<size_t>(height);
+            auto const halfHeight = static_cast<size_t>(height + 1) / 2;
+
+            switch (pixFmt) {
+                case V4L2_PIX_FMT_NV12:
+                case V4L2_PIX_FMT_NV21:
+                    return {V4L2ImagePlane{0, 0, step, lumaSize},
+                            V4L2ImagePlane{0, lumaSize, step, step * halfHeight}};
+                case V4L2_PIX_FMT_NV16:
+                case V4L2_PIX_FMT_NV61:
+                    return {V4L2ImagePlane{0, 0, step, lumaSize},
+                            V4L2ImagePlane{0, lumaSize, step, lumaSize}};
+                case V4L2_PIX_FMT_YUV420:
+                case V4L2_PIX_FMT_YVU420:
+                    return {V4L2ImagePlane{0, 0, step, lumaSize},
+                            V4L2ImagePlane{0, lumaSize, step / 2, step / 2 * halfHeight},
+                            V4L2ImagePlane{0, lumaSize + step / 2 * halfHeight, step / 2, step / 2 * halfHeight}};
+                case V4L2_PIX_FMT_YUV422P:
+                    return {V4L2ImagePlane{0, 0, step, lumaSize},
+                            V4L2ImagePlane{0, lumaSize, step / 2, lumaSize / 2},
+                            V4L2ImagePlane{0, lumaSize + lumaSize / 2, step / 2, lumaSize / 2}};
+                default:
+                    return {V4L2ImagePlane{0, 0, step, memoryPlanes[0].size}};
+            }
+        }
+
+        // Exports the memory plane of the mmap v4l2 buffer as a dmabuf fd (read-only, closed by the caller)
+        static std::optional<int> v4l2_export_buffer(int handle, uint32_t bufferType, uint32_t index, uint32_t plane) {
+            v4l2_exportbuffer exportBuffer{};
+            exportBuffer.type = bufferType;
+            exportBuffer.index = index;
+            exportBuffer.plane = plane;
+            exportBuffer.flags = O_RDONLY | O_CLOEXEC;
+
+            if (V4L2Utils::xioctl(handle, VIDIOC_EXPBUF, &exportBuffer) == ERROR_CODE) {
+                std::cerr << "ERROR: VIDIOC_EXPBUF - " << strerror(errno) << '\n';
+                return std::nullopt;
+            }
+
+            return {exportBuffer.fd};
+        }
+
+        static std::optional<v4l2_format> v4l2_get_current_format(int handle,
+                                                                  uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
             v4l2_format format{};
-            format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            format.type = bufferType;
 
             if (V4L2Utils::xioctl(handle, VIDIOC_G_FMT, &format) == ERROR_CODE) {
                 std::cerr << "ERROR: VIDIOC_G_FMT - " << strerror(errno) << '\n';
@@ -228,9 +380,10 @@ namespace lirs {
             return {format};
         }
 
-        static std::optional<v4l2_streamparm> v4l2_get_current_frame_rate(int handle) {
+        static std::optional<v4l2_streamparm> v4l2_get_current_frame_rate(
+                int handle, uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
             v4l2_streamparm streamParam{};
-            streamParam.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            streamParam.type = bufferType;
 
             if (V4L2Utils::xioctl(handle, VIDIOC_G_PARM, &streamParam) == ERROR_CODE) {
                 std::cerr << "ERROR: VIDIOC_G_PARM - " << strerror(errno) << '\n';
@@ -241,9 +394,10 @@ namespace lirs {
         }
 
         // Sets frame rate on v4l2 device (device should not be in streaming mode)
-        static std::optional<v4l2_streamparm> v4l2_set_frame_rate(int handle, int num, int den) {
+        static std::optional<v4l2_streamparm> v4l2_set_frame_rate(int handle, int num, int den,
+                                                                  uint32_t bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE) {
             v4l2_streamparm streamParam{};
-            streamParam.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            streamParam.type = bufferType;
             streamParam.parm.capture.timeperframe.numerator = static_cast<uint32_t >(num);
             streamParam.parm.capture.timeperframe.denominator = static_cast<uint32_t >(den);
 
@@ -255,6 +409,22 @@ namespace lirs {
             return {streamParam};
         }
 
+        // Checks if v4l2 buffer is stamped using monotonic clock (CLOCK_MONOTONIC)
+        static inline bool v4l2_has_monotonic_timestamp(v4l2_buffer const &buffer) {
+            return (buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+        }
+
+        static inline std::chrono::nanoseconds v4l2_timestamp(v4l2_buffer const &buffer) {
+            return std::chrono::seconds{buffer.timestamp.tv_sec} + std::chrono::microseconds{buffer.timestamp.tv_usec};
+        }
+
+        // Converts the timeout for v4l2_is_readable()
+        static inline timeval to_timeval(std::chrono::microseconds timeout) {
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+
+            return {static_cast<time_t>(seconds.count()), static_cast<suseconds_t>((timeout - seconds).count())};
+        }
+
         template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, T>::type * = nullptr>
         static bool is_in_range_inclusive(T low, T high, T value) {
             return value >= low && value <= high;
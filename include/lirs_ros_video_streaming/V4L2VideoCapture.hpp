@@ -33,14 +33,78 @@
 #include <sys/mman.h>
 #include <optional>
 #include <atomic>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <memory>
 #include <vector>
 #include <string>
 #include <map>
 
 #include "V4L2Utils.hpp"
+#include "FramePool.hpp"
+#include "ClockOffsetEstimator.hpp"
+#include "RingBuffer.hpp"
 
 namespace lirs {
 
+    namespace v4l2_capture_thread {
+        /* Capture thread checks for the stop request at least that often (also while blocked on the full queue) */
+        constexpr auto POLL_TIMEOUT_MICROSECONDS = 100'000;
+    }
+
+    namespace v4l2_latest_frame {
+        /* Newest frame older than the frame period has been captured before the driver was starved of buffers */
+        constexpr auto STALE_FRAME_PERIODS = 1;
+
+        /* Waiting for the fresh frame instead of the stale one is limited to that many frame periods */
+        constexpr auto FRESH_FRAME_WAIT_PERIODS = 2;
+    }
+
+    namespace v4l2_user_memory {
+        /* USERPTR buffers are aligned to (and sized in) huge pages, i.e. fewer TLB misses while reading frames */
+        constexpr auto HUGE_PAGE_SIZE = size_t{2} << 20;
+    }
+
+    /**
+     * @brief Borrowed frame along with the dmabuf fds of its v4l2 buffer (see V4L2Capture::ReadDmaBufFrame()).
+     */
+    struct DmaBufFrame final {
+        /* Keeps the v4l2 buffer dequeued (and fds open) until released */
+        Frame frame;
+
+        uint32_t bufferIndex = 0;
+
+        /* Memory planes' dmabuf fds owned by the capture */
+        std::vector<int> fds;
+
+        /* Image planes within the memory planes, offsets include the driver's data offset */
+        std::vector<V4L2ImagePlane> planes;
+    };
+
+    /**
+     * @brief V4L2 video capture (memory mapping streaming I/O).
+     *
+     * If CaptureParam::CAPTURE_QUEUE_SIZE is positive, streaming starts a dedicated capture thread.
+     * The thread dequeues v4l2 buffers as soon as they are ready, copies them into the frame pool
+     * and passes frames to the lock-free queue of the given size (rounded up to the power of two, see
+     * RingBuffer::capacityFor()). Read methods then retrieve frames
+     * from that queue, CaptureParam::OVERFLOW_POLICY defines what happens when the queue is full.
+     *
+     * If CaptureParam::LATEST_FRAME_ONLY is non-zero, reading skips all of the stale frames
+     * (ready in the driver's or capture queue) and returns the newest one, i.e. minimal latency.
+     *
+     * Devices supporting only the multi-planar API (V4L2_CAP_VIDEO_CAPTURE_MPLANE) are captured plane by plane.
+     * Frames of the planar formats (e.g. NV12, YUV420 or NV12M) describe their image planes (see Frame::plane()):
+     * borrowed frames point into the mapped memory planes, copied frames store memory planes one after another.
+     *
+     * If CaptureParam::EXPORT_DMABUF is non-zero, v4l2 buffers are exported as dmabuf fds on allocation,
+     * thus frames could be shared with other processes without copying (see ReadDmaBufFrame()).
+     *
+     * CaptureParam::MEMORY_TYPE selects the buffers the driver writes into (see MemoryType). USERPTR buffers
+     * are allocated by the capture (huge pages if available, locked in memory), they are read at the cache speed
+     * unlike the uncached MMAP buffers of some drivers. USERPTR buffers could not be exported.
+     */
     class V4L2Capture final : public VideoCapture {
     public:
         /**
@@ -60,9 +124,10 @@ namespace lirs {
             if (IsOpened()) {
                 if (IsStreaming()) {
                     disableSteaming();
-                    cleanupInternalBuffers();
                 }
 
+                cleanupInternalBuffers();  // paused streaming keeps the buffers
+
                 if (V4L2Utils::close_device(handle_)) {
                     handle_ = v4l2_constants::CLOSED_HANDLE;
                 }
@@ -77,6 +142,22 @@ namespace lirs {
 
         bool StopStreaming() override;
 
+        /**
+         * @brief Stops streaming keeping the negotiated format and the allocated buffers (see ResumeStreaming()).
+         *
+         * Device stops capturing (no bus bandwidth is used), StopStreaming() releases the buffers.
+         */
+        bool PauseStreaming();
+
+        /**
+         * @brief Restarts paused streaming, i.e. buffers are enqueued back and streaming is enabled (no negotiation).
+         *
+         * Frames borrowed before the pause should be released, since their buffers are enqueued back.
+         */
+        bool ResumeStreaming();
+
+        bool IsPaused() const;
+
         /**
          * @brief Sets capture parameters if streaming mode is not enabled.
          */
@@ -86,6 +167,64 @@ namespace lirs {
 
         std::optional<Frame> ReadFrame() override;
 
+        bool ReadFrame(Frame &frame) override;
+
+        std::optional<FrameInfo> ReadInto(uint8_t *dst, size_t capacity) override;
+
+        /**
+         * @brief Captures frame and copies it into the capture's frame pool.
+         *
+         * Unlike ReadFrame() the v4l2 buffer is enqueued back immediately, thus frames could be held
+         * for a long time without starving the driver. Frame owns a heap copy if the pool is exhausted.
+         * Copies out of the v4l2 buffers (also by ReadFrame(Frame &) and ReadInto()) use MemoryCopy::from_device().
+         */
+        std::optional<Frame> ReadFrameCopy();
+
+        /**
+         * @brief Captures frame borrowing the exported v4l2 buffer (CaptureParam::EXPORT_DMABUF).
+         *
+         * Capture thread should be disabled (CaptureParam::CAPTURE_QUEUE_SIZE = 0), since it copies frames.
+         */
+        std::optional<DmaBufFrame> ReadDmaBufFrame();
+
+        /**
+         * @brief Reads the ready frame without waiting for it (e.g. after eventHandle() is reported readable).
+         *
+         * Frame is borrowed as by ReadFrame(), empty - if there is no ready frame.
+         */
+        std::optional<Frame> ReadReadyFrame();
+
+        /**
+         * @brief Releases the ready frames without waiting (e.g. while nobody reads them, but streaming is kept).
+         *
+         * Frames are not counted as dropped (see droppedFrames()).
+         *
+         * @return number of the released frames.
+         */
+        size_t DiscardReadyFrames();
+
+        /**
+         * @brief Handle becoming readable when a frame is ready (for poll, epoll, etc.).
+         *
+         * @return capture queue's event if the capture thread is enabled, otherwise the device handle,
+         * closed handle - if not streaming. Handle could change on streaming restart.
+         */
+        int eventHandle() const;
+
+        /**
+         * @return frame pool used by ReadFrameCopy(), nullptr - if streaming has not been started.
+         */
+        FramePool const *framePool() const {
+            return framePool_.get();
+        }
+
+        /**
+         * @return number of frames dropped due to the capture queue overflow or skipped as stale ones.
+         */
+        uint64_t droppedFrames() const {
+            return droppedFrames_;
+        }
+
         std::string const &device() const override {
             return device_;
         };
@@ -98,6 +237,27 @@ namespace lirs {
             return imageSize_;
         }
 
+        /**
+         * @return true - if the negotiated pixel format is compressed (frames are up to imageSize() bytes).
+         */
+        bool isCompressed() const {
+            return isCompressed_;
+        }
+
+        /**
+         * @return true - if the device is captured via the multi-planar API.
+         */
+        bool isMultiPlanar() const {
+            return V4L2_TYPE_IS_MULTIPLANAR(bufferType_);
+        }
+
+        /**
+         * @return negotiated image planes layout (empty - if streaming has not been started).
+         */
+        std::vector<V4L2ImagePlane> const &imagePlanes() const {
+            return imagePlanes_;
+        }
+
         // prohibit copying and moving
 
         V4L2Capture(const V4L2Capture &) = delete;
@@ -109,21 +269,136 @@ namespace lirs {
         V4L2Capture &operator=(V4L2Capture &&) = delete;
 
     private:
+        /* Memory planes of the v4l2 buffer (single-planar buffer has one) */
         struct MappedBuffer final {
-            void *rawDataPtr = nullptr;
-            int lengthBytes = -1;
+            struct Plane final {
+                void *rawDataPtr = nullptr;
+                size_t lengthBytes = 0;
+                int dmabufFd = v4l2_constants::CLOSED_HANDLE;  // exported on demand
+            };
+
+            std::vector<Plane> planes;
 
             ~MappedBuffer() {
-                if (munmap(rawDataPtr, static_cast<size_t>(lengthBytes)) == V4L2Utils::ERROR_CODE) {
-                    std::cerr << "WARNING: Unable to unmap buffers\n";
+                for (auto const &plane : planes) {
+                    if (munmap(plane.rawDataPtr, plane.lengthBytes) == V4L2Utils::ERROR_CODE) {
+                        std::cerr << "WARNING: Unable to unmap buffers\n";
+                    }
+
+                    if (plane.dmabufFd != v4l2_constants::CLOSED_HANDLE) {
+                        V4L2Utils::close_device(plane.dmabufFd);
+                    }
                 }
             }
 
-            MappedBuffer(void *bufData, int bufLen) : rawDataPtr(bufData), lengthBytes(bufLen) {}
+            MappedBuffer() = default;
+
+            uint8_t *data(size_t plane) const {
+                return static_cast<uint8_t *>(planes[plane].rawDataPtr);
+            }
+
+            MappedBuffer(MappedBuffer const &) = delete;
+
+            MappedBuffer &operator=(MappedBuffer const &) = delete;
         };
 
+        /* v4l2 buffer along with the storage of its planes (multi-planar buffer points to it) */
+        struct V4L2Buffer final {
+            v4l2_buffer v4l2{};
+            std::array<v4l2_plane, VIDEO_MAX_PLANES> planes{};
+
+            V4L2Buffer(uint32_t type, uint32_t memory) {
+                v4l2.type = type;
+                v4l2.memory = memory;
+
+                if (isMultiPlanar()) {
+                    v4l2.length = VIDEO_MAX_PLANES;  // capacity of the planes array, driver sets the number of planes
+                }
+                linkPlanes();
+            }
+
+            V4L2Buffer(V4L2Buffer const &other) : v4l2{other.v4l2}, planes{other.planes} {
+                linkPlanes();
+            }
+
+            V4L2Buffer &operator=(V4L2Buffer const &other) {
+                v4l2 = other.v4l2;
+                planes = other.planes;
+                linkPlanes();
+                return *this;
+            }
+
+            bool isMultiPlanar() const {
+                return V4L2_TYPE_IS_MULTIPLANAR(v4l2.type);
+            }
+
+            size_t planeCount() const {
+                return isMultiPlanar() ? v4l2.length : 1;
+            }
+
+            uint32_t length(size_t plane) const {
+                return isMultiPlanar() ? planes[plane].length : v4l2.length;
+            }
+
+            uint32_t memoryOffset(size_t plane) const {
+                return isMultiPlanar() ? planes[plane].m.mem_offset : v4l2.m.offset;
+            }
+
+            /* Offset of the plane's data, i.e. driver's header precedes it */
+            uint32_t dataOffset(size_t plane) const {
+                return isMultiPlanar() ? std::min(planes[plane].data_offset, planes[plane].bytesused) : 0;
+            }
+
+            /* Sets memory of the USERPTR buffer's plane */
+            void setUserPointer(size_t plane, void *data, uint32_t length) {
+                if (isMultiPlanar()) {
+                    planes[plane].m.userptr = reinterpret_cast<unsigned long>(data);
+                    planes[plane].length = length;
+                } else {
+                    v4l2.m.userptr = reinterpret_cast<unsigned long>(data);
+                    v4l2.length = length;
+                }
+            }
+
+            /* Plane's data size excluding the data offset */
+            size_t payloadSize(size_t plane) const {
+                return (isMultiPlanar() ? planes[plane].bytesused : v4l2.bytesused) - dataOffset(plane);
+            }
+
+            size_t payloadSize() const {
+                auto size = size_t{0};
+
+                for (auto plane = size_t{0}; plane < planeCount(); ++plane) {
+                    size += payloadSize(plane);
+                }
+
+                return size;
+            }
+
+            void resetBytesUsed() {
+                v4l2.bytesused = 0;
+
+                for (auto &plane : planes) {
+                    plane.bytesused = 0;
+                }
+            }
+
+        private:
+            void linkPlanes() {
+                if (isMultiPlanar()) {
+                    v4l2.m.planes = planes.data();
+                }
+            }
+        };
+
+        /* Identifies streaming session (STREAMON/STREAMOFF cycle) in which buffer was dequeued */
+        using StreamingSession = std::atomic_uint32_t;
+
         bool allocateInternalBuffers();
 
+        /* Allocates huge-page aligned memory of the USERPTR buffer's plane, locks it if permitted */
+        static std::optional<MappedBuffer::Plane> allocateUserPlane(size_t size, bool &isLocked);
+
         void cleanupInternalBuffers();
 
         bool enableStreaming();
@@ -132,12 +407,67 @@ namespace lirs {
 
         bool negotiateFormat();
 
+        /* V4L2_MEMORY_MMAP or V4L2_MEMORY_USERPTR (CaptureParam::MEMORY_TYPE) */
+        uint32_t v4l2Memory() const;
+
         bool negotiateFrameRate();
 
         bool checkSupportedCapabilities();
 
         std::optional<Frame> internalReadFrame();
 
+        std::optional<Frame> internalReadFrameCopy();
+
+        /* Borrows dequeued buffer (no copy), it is enqueued back when the frame is released */
+        Frame borrowFrame(V4L2Buffer const &buffer);
+
+        bool isCaptureThreadEnabled() const {
+            return captureThread_.joinable();
+        }
+
+        bool startCaptureThread();
+
+        void stopCaptureThread();
+
+        void captureLoop();
+
+        void pushCapturedFrame(Frame &&frame);
+
+        /* Wakes up the capture thread blocked on the full capture queue (OverflowPolicy::BLOCK) */
+        void notifyCaptureQueueSpace();
+
+        /* Waits for the frame from the capture thread */
+        std::optional<Frame> popCapturedFrame();
+
+        /* Pops captured frame without waiting for the capture queue's event */
+        std::optional<Frame> takeCapturedFrame();
+
+        /* Dequeues filled v4l2 buffer, corrupted buffers are enqueued back */
+        std::optional<V4L2Buffer> dequeueBuffer();
+
+        /* Dequeues the next buffer or the newest one (CaptureParam::LATEST_FRAME_ONLY) */
+        std::optional<V4L2Buffer> dequeueReadyBuffer();
+
+        bool enqueueBuffer(V4L2Buffer &buffer);
+
+        /* Frame period of the negotiated frame rate (zero if the rate is unknown) */
+        std::chrono::microseconds framePeriod() const;
+
+        /* Checks whether the frame is older than v4l2_latest_frame::STALE_FRAME_PERIODS frame periods */
+        bool isStale(FrameInfo const &info) const;
+
+        /* Extracts frame's metadata, i.e. driver's timestamp (converted to system time) and sequence number */
+        FrameInfo frameInfoFrom(V4L2Buffer const &buffer);
+
+        /* Creates a lease which enqueues the v4l2 buffer back to the driver on release */
+        std::shared_ptr<void> leaseBuffer(V4L2Buffer const &buffer);
+
+        /* Copies memory planes of the buffer one after another (payloadSize() bytes) */
+        void copyPlanes(V4L2Buffer const &buffer, uint8_t *dst) const;
+
+        /* Describes image planes of the frame holding memory planes one after another (see copyPlanes()) */
+        void describePlanes(Frame &frame, V4L2Buffer const &buffer) const;
+
     private:
         int handle_;
 
@@ -145,12 +475,46 @@ namespace lirs {
 
         int imageSize_;
 
+        bool isCompressed_;
+
+        /* V4L2_BUF_TYPE_VIDEO_CAPTURE or V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE */
+        uint32_t bufferType_;
+
+        std::vector<V4L2PlaneFormat> memoryPlanes_;
+
+        std::vector<V4L2ImagePlane> imagePlanes_;
+
         std::string const device_;
 
         /* Flag indicating if streaming process is on */
         std::atomic_bool isStreaming_;
 
-        std::vector<MappedBuffer> internalBuffers_;
+        /* Streaming is disabled, but the format and buffers are kept (see PauseStreaming()) */
+        bool isPaused_;
+
+        /* Shared with the borrowed frames in order to keep memory mapped while frames are alive */
+        std::vector<std::shared_ptr<MappedBuffer>> internalBuffers_;
+
+        std::shared_ptr<StreamingSession> streamingSession_;
+
+        /* Sized from imageSize() and V4L2_BUFFERS_NUM on buffers allocation */
+        std::unique_ptr<FramePool> framePool_;
+
+        ClockOffsetEstimator clockOffset_;
+
+        std::thread captureThread_;
+
+        std::atomic_bool isCapturing_;
+
+        std::unique_ptr<RingBuffer<Frame>> captureQueue_;
+
+        /* Counts frames in the capture queue, readable when there are frames to retrieve */
+        int captureQueueEvent_;
+
+        /* Readable when frames have been popped from the capture queue (OverflowPolicy::BLOCK) */
+        int captureSpaceEvent_;
+
+        std::atomic_uint64_t droppedFrames_;
 
         std::map<CaptureParam, int> params_;
     };
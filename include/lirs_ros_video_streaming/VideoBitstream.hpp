@@ -0,0 +1,63 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lirs {
+
+    /**
+     * @brief Codec of the encoded video stream (e.g. UVC cameras with on-board encoders).
+     */
+    enum class VideoCodec : uint8_t {
+        H264,
+        HEVC
+    };
+
+    /**
+     * @brief Inspection of the encoded access units (Annex B byte stream).
+     */
+    struct VideoBitstream {
+
+        /**
+         * @brief Checks if the access unit could be decoded on its own (H.264 IDR, HEVC IRAP pictures).
+         *
+         * Only NAL unit headers preceding the first picture slice are inspected, the slice data is not scanned.
+         *
+         * @param data access unit starting with the start code.
+         * @param size access unit size in bytes.
+         */
+        static bool is_keyframe(VideoCodec codec, uint8_t const *data, size_t size);
+
+        /**
+         * @return lowercase codec name (e.g. h264).
+         */
+        static char const *codec_name(VideoCodec codec);
+    };
+
+}  // namespace lirs
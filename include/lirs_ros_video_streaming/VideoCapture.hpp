@@ -29,8 +29,14 @@
 #pragma once
 
 #include <linux/videodev2.h>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <string>
+#include <array>
 #include <optional>
 
 namespace lirs {
@@ -41,19 +47,100 @@ namespace lirs {
         constexpr auto DEFAULT_FRAME_HEIGHT = 480;
         constexpr auto DEFAULT_V4L2_BUFFERS_NUM = 4;
         constexpr auto DEFAULT_V4L2_PIXEL_FORMAT = uint32_t{V4L2_PIX_FMT_YUYV};
+        constexpr auto DEFAULT_CAPTURE_QUEUE_SIZE = 0;  // no capture thread
     }
 
+    /**
+     * @brief Captured frame's metadata.
+     */
+    struct FrameInfo final {
+        /* Number of bytes of the frame's data */
+        size_t size = 0;
+
+        /* Capture time since epoch (system clock) */
+        std::chrono::nanoseconds timestamp{0};
+
+        /* Frame counter set by the driver (gaps indicate dropped frames) */
+        uint32_t sequence = 0;
+
+        /* v4l2 buffer flags (V4L2_BUF_FLAG_*) */
+        uint32_t flags = 0;
+    };
+
+    /* Maximum number of the image planes (e.g. Y, Cb and Cr planes of YUV 4:2:0) */
+    constexpr auto MAX_FRAME_PLANES = size_t{4};
+
+    /**
+     * @brief Image plane of the frame, e.g. Y or interleaved CbCr plane of NV12.
+     */
+    struct FramePlane final {
+        uint8_t const *data = nullptr;
+
+        /* Plane line size in bytes */
+        size_t step = 0;
+
+        /* Plane size in bytes */
+        size_t size = 0;
+    };
+
     /**
      * @brief Captured video data, i.e. images.
      *
-     * @todo add frame's captured timestamp and sequence number.
+     * Frame either owns a copy of the data or borrows the memory of the capture's internal buffer.
+     * Borrowed frames keep a lease on that buffer: the buffer is given back to the capture
+     * when the last copy of the frame is destroyed. Holding borrowed frames for too long
+     * starves the capture of free buffers.
+     *
+     * Frame is stamped with the time of its construction unless capture time is provided with stamp().
+     *
+     * Planar images (e.g. NV12, YUV420 or multi-planar v4l2 buffers) are accessed plane by plane with plane(),
+     * planes of the borrowed multi-planar buffers may reside apart from data(). Frame without plane description
+     * has a single plane covering all of its data.
      */
     class Frame final {
     public:
+        /**
+         * @brief Constructs frame owning a copy of the given data.
+         */
         Frame(uint8_t *data, size_t size)
                 : buffer_{std::vector<uint8_t>(data, data + size)},
                   captured_(std::chrono::system_clock::now().time_since_epoch()) {}
 
+        /**
+         * @brief Constructs frame borrowing the given data (no copy).
+         *
+         * @param lease keeps the data valid, its deleter returns the data to the owner.
+         */
+        Frame(uint8_t *data, size_t size, std::shared_ptr<void> lease)
+                : borrowedData_{data}, borrowedSize_{size}, lease_{std::move(lease)},
+                  captured_(std::chrono::system_clock::now().time_since_epoch()) {}
+
+        uint8_t *data() {
+            return lease_ ? borrowedData_ : buffer_.data();
+        }
+
+        uint8_t const *data() const {
+            return lease_ ? borrowedData_ : buffer_.data();
+        }
+
+        size_t size() const {
+            return lease_ ? borrowedSize_ : buffer_.size();
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        /**
+         * @return true - if frame borrows the capture's memory, false - if it owns the data.
+         */
+        bool isBorrowed() const {
+            return static_cast<bool>(lease_);
+        }
+
+        /**
+         * @return owned data, empty for the borrowed frames.
+         */
         std::vector<uint8_t> &buffer() {
             return buffer_;
         }
@@ -62,13 +149,152 @@ namespace lirs {
             return buffer_;
         }
 
+        /**
+         * @return capture time since epoch (system clock).
+         */
         std::chrono::nanoseconds timestamp() const {
             return captured_;
         }
 
+        uint32_t sequence() const {
+            return sequence_;
+        }
+
+        uint32_t flags() const {
+            return flags_;
+        }
+
+        FrameInfo info() const {
+            return FrameInfo{size(), captured_, sequence_, flags_};
+        }
+
+        size_t planeCount() const {
+            return planeCount_ == 0 ? 1 : planeCount_;
+        }
+
+        /**
+         * @return image plane (index is less than planeCount()).
+         */
+        FramePlane plane(size_t index) const {
+            if (planeCount_ == 0) return FramePlane{data(), 0, size()};
+
+            auto const &plane = planes_[index];
+
+            return FramePlane{plane.external ? plane.external : data() + plane.offset, plane.step, plane.size};
+        }
+
+        /**
+         * @brief Describes the image plane located at the offset of the frame's data.
+         *
+         * Planes should be described in order, i.e. index is at most planeCount().
+         */
+        void setPlane(size_t index, size_t offset, size_t step, size_t size) {
+            planes_[index] = PlaneLayout{nullptr, offset, step, size};
+            planeCount_ = std::max(planeCount_, index + 1);
+        }
+
+        /**
+         * @brief Describes the image plane stored apart from the frame's data (e.g. borrowed multi-planar buffer).
+         *
+         * Plane's memory should be kept valid by the frame's lease.
+         */
+        void setExternalPlane(size_t index, uint8_t *data, size_t step, size_t size) {
+            planes_[index] = PlaneLayout{data, 0, step, size};
+            planeCount_ = std::max(planeCount_, index + 1);
+        }
+
+        /**
+         * @brief Sets frame's capture metadata.
+         */
+        void stamp(FrameInfo const &info) {
+            captured_ = info.timestamp;
+            sequence_ = info.sequence;
+            flags_ = info.flags;
+        }
+
+        /**
+         * @brief Replaces frame's data with a copy of the given data.
+         *
+         * Releases borrowed data (if any). Owned buffer's capacity is reused,
+         * i.e. no allocation takes place if capacity is enough.
+         */
+        void assign(uint8_t const *data, size_t size) {
+            std::copy_n(data, size, allocate(size));
+        }
+
+        /**
+         * @brief Replaces frame's data, planes and metadata with a copy of the other frame.
+         *
+         * Planes stored apart from the other frame's data are gathered one after another.
+         */
+        void assign(Frame const &other) {
+            auto const planesBegin = other.planes_.cbegin();
+            auto const planesEnd = planesBegin + static_cast<std::ptrdiff_t>(other.planeCount_);
+
+            if (std::none_of(planesBegin, planesEnd, [](PlaneLayout const &plane) { return plane.external; })) {
+                assign(other.data(), other.size());
+                planes_ = other.planes_;
+            } else {
+                auto size = size_t{0};
+                std::for_each(planesBegin, planesEnd, [&size](PlaneLayout const &plane) { size += plane.size; });
+
+                auto dst = allocate(size);
+
+                auto offset = size_t{0};
+
+                for (auto i = size_t{0}; i < other.planeCount_; ++i) {
+                    auto const plane = other.plane(i);
+                    std::copy_n(plane.data, plane.size, dst + offset);
+                    planes_[i] = PlaneLayout{nullptr, offset, plane.step, plane.size};
+                    offset += plane.size;
+                }
+            }
+
+            planeCount_ = other.planeCount_;
+            captured_ = other.captured_;
+            sequence_ = other.sequence_;
+            flags_ = other.flags_;
+        }
+
+        /**
+         * @brief Replaces frame's data with an owned buffer of the given size to be filled by the caller.
+         *
+         * Releases borrowed data (if any) and the planes description, owned buffer's capacity is reused.
+         *
+         * @return frame's data.
+         */
+        uint8_t *allocate(size_t size) {
+            lease_.reset();
+            borrowedData_ = nullptr;
+            borrowedSize_ = 0;
+            planeCount_ = 0;
+
+            buffer_.resize(size);
+            captured_ = std::chrono::system_clock::now().time_since_epoch();
+
+            return buffer_.data();
+        }
+
     private:
+        struct PlaneLayout final {
+            uint8_t *external;  // nullptr - plane is located at the offset of data()
+            size_t offset;
+            size_t step;
+            size_t size;
+        };
+
         std::vector<uint8_t> buffer_;
+
+        uint8_t *borrowedData_ = nullptr;
+        size_t borrowedSize_ = 0;
+        std::shared_ptr<void> lease_;
+
         std::chrono::nanoseconds captured_;
+        uint32_t sequence_ = 0;
+        uint32_t flags_ = 0;
+
+        std::array<PlaneLayout, MAX_FRAME_PLANES> planes_{};
+        size_t planeCount_ = 0;
     };
 
     /**
@@ -81,7 +307,29 @@ namespace lirs {
         FRAME_WIDTH,
         FRAME_HEIGHT,
         V4L2_PIX_FMT,
-        V4L2_BUFFERS_NUM
+        V4L2_BUFFERS_NUM,
+        CAPTURE_QUEUE_SIZE,
+        OVERFLOW_POLICY,
+        LATEST_FRAME_ONLY,
+        EXPORT_DMABUF,
+        MEMORY_TYPE
+    };
+
+    /**
+     * @brief Policy applied to captured frames when the capture queue is full.
+     */
+    enum class OverflowPolicy : uint8_t {
+        DROP_OLDEST,  // replace the oldest queued frame
+        DROP_NEWEST,  // discard the captured frame
+        BLOCK         // wait until the consumer retrieves a frame
+    };
+
+    /**
+     * @brief Memory of the capture buffers the driver writes frames into.
+     */
+    enum class MemoryType : uint8_t {
+        MMAP,     // driver's buffers mapped into the process (often uncached or write-combined)
+        USERPTR   // capture's cacheable buffers (huge pages, locked in memory)
     };
 
     /**
@@ -139,10 +387,33 @@ namespace lirs {
         /**
          * @brief Captures frame from the resource or retrieves one from the buffers.
          *
+         * Returned frame may borrow the resource's memory (see Frame::isBorrowed()),
+         * it should be released as soon as it is processed.
+         *
          * @return empty - in case if there is no frames to capture/retrieve, otherwise - frame with data.
          */
         virtual std::optional<Frame> ReadFrame() = 0;
 
+        /**
+         * @brief Captures frame into the given frame's own buffer.
+         *
+         * Frame's buffer is reused, thus there is no allocation once its capacity is enough.
+         *
+         * @param frame destination frame.
+         * @return true - if frame is captured, false - in case if there is no frames to capture/retrieve.
+         */
+        virtual bool ReadFrame(Frame &frame) = 0;
+
+        /**
+         * @brief Captures frame into the caller-owned memory.
+         *
+         * @param dst destination memory (at least imageSize() bytes).
+         * @param capacity destination memory size in bytes.
+         * @return empty - if there is no frames or capacity is not enough,
+         *         otherwise - captured frame's metadata (including number of written bytes).
+         */
+        virtual std::optional<FrameInfo> ReadInto(uint8_t *dst, size_t capacity) = 0;
+
         /**
          * @brief Sets capture parameter.
          *
@@ -0,0 +1,962 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/CameraStreamer.hpp"
+#include "lirs_ros_video_streaming/MemoryCopy.hpp"
+
+#include <linux/videodev2.h>
+#include <array>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <optional>
+#include <map>
+
+#include <sensor_msgs/image_encodings.h>
+
+namespace lirs {
+    namespace ros_utils {
+
+        /* defaults */
+        constexpr auto DEFAULT_DEVICE_NAME = "/dev/video0";
+        constexpr auto DEFAULT_CAMERA_NAME = "camera";
+        constexpr auto DEFAULT_CAMERA_INFO_URL = "";
+        constexpr auto DEFAULT_FRAME_ID = "camera_frame_id";
+
+        constexpr auto DEFAULT_FRAME_RATE = 30;
+        constexpr auto DEFAULT_FRAME_WIDTH = 640;
+        constexpr auto DEFAULT_FRAME_HEIGHT = 480;
+        constexpr auto DEFAULT_IMAGE_FORMAT = "yuv422";
+        constexpr auto DEFAULT_CAPTURE_QUEUE_SIZE = 0;  // capture in the publishing loop
+        constexpr auto DEFAULT_OVERFLOW_POLICY = "drop_oldest";
+        constexpr auto DEFAULT_LATENCY_REPORT_PERIOD = 0.0;  // seconds, no reports
+        constexpr auto DEFAULT_LATEST_FRAME_ONLY = false;
+        constexpr auto DEFAULT_MEMORY_TYPE = "mmap";
+
+        /* rgb8/bgr8 output conversion */
+        constexpr auto DEFAULT_SOURCE_PIXEL_FORMAT = "yuyv";
+        constexpr auto DEFAULT_COLOR_MATRIX = "bt601";
+        constexpr auto DEFAULT_COLOR_RANGE = "limited";
+
+        /* in-node demosaicing of the Bayer image formats */
+        constexpr auto DEFAULT_DEBAYER_FORMAT = "";  // disabled
+
+        /* high bit depth sources windowing (mono8 and bayer_*8 image formats) */
+        constexpr auto DEFAULT_WINDOW_MIN = 0;
+        constexpr auto DEFAULT_WINDOW_MAX = -1;  // maximum of the source bit depth
+
+        /* MJPEG source decoding (rgb8, bgr8 and mono8 image formats) */
+        constexpr auto DEFAULT_DECODE_THREADS = 2;
+
+        /* in-node JPEG compression of the YUV 4:2:2 sources (compressed topic) */
+        constexpr auto DEFAULT_ENCODE_THREADS = 0;  // disabled, image_transport compressed plugin is used
+        constexpr auto DEFAULT_JPEG_QUALITY = 90;
+
+        /* zero-copy sharing of the capture buffers with the same-host processes */
+        constexpr auto DEFAULT_DMABUF_SOCKET = "";  // disabled
+        constexpr auto DEFAULT_DMABUF_FRAMES_IN_FLIGHT = 1;
+
+        /* side-by-side stereo frame split into the left and right images */
+        constexpr auto DEFAULT_SIDE_BY_SIDE = false;
+        constexpr auto DEFAULT_LEFT_CAMERA_INFO_URL = "";
+        constexpr auto DEFAULT_RIGHT_CAMERA_INFO_URL = "";
+
+        /* streaming is paused while there are no subscribers (format and buffers are kept) */
+        constexpr auto DEFAULT_LAZY_STREAMING = false;
+        constexpr auto DEFAULT_STANDBY_DELAY = 0.0;  // seconds, streaming is kept after the last subscriber leaves
+
+        // Checks if image format is produced from YUV 4:2:2 by color conversion
+        static bool isRgbImageFormat(std::string const &imageFormat) {
+            return imageFormat == sensor_msgs::image_encodings::RGB8 || imageFormat == sensor_msgs::image_encodings::BGR8;
+        }
+
+        // NOTE: Add other image format correspondences if it is necessary.
+        static std::optional<uint32_t> findCorrespondentV4l2PixFmt(std::string const &imageFormat) {
+            if (imageFormat == sensor_msgs::image_encodings::YUV422)
+                return std::optional{V4L2_PIX_FMT_YUYV};  // swizzled into UYVY
+            if (imageFormat == sensor_msgs::image_encodings::MONO8)
+                return std::optional{V4L2_PIX_FMT_YUYV};  // luma is extracted
+            if (isRgbImageFormat(imageFormat))
+                return std::optional{V4L2_PIX_FMT_YUYV};  // converted into RGB
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GRBG8)
+                return std::optional{V4L2_PIX_FMT_SGRBG8};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GBRG8)
+                return std::optional{V4L2_PIX_FMT_SGBRG8};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_BGGR8)
+                return std::optional{V4L2_PIX_FMT_SBGGR8};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_RGGB8)
+                return std::optional{V4L2_PIX_FMT_SRGGB8};
+            if (imageFormat == sensor_msgs::image_encodings::MONO16)
+                return std::optional{V4L2_PIX_FMT_Y16};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GRBG16)
+                return std::optional{V4L2_PIX_FMT_SGRBG16};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GBRG16)
+                return std::optional{V4L2_PIX_FMT_SGBRG16};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_BGGR16)
+                return std::optional{V4L2_PIX_FMT_SBGGR16};
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_RGGB16)
+                return std::optional{V4L2_PIX_FMT_SRGGB16};
+            return std::nullopt;
+        }
+
+        // Finds high bit depth source by the lowercase v4l2 pixel format name (e.g. srggb10p)
+        static std::optional<RawSource> findRawSource(std::string const &sourcePixelFormat) {
+            using namespace sensor_msgs::image_encodings;
+
+            constexpr auto unpacked = [](uint8_t bits) { return lirs::RawFormat{lirs::RawPacking::UNPACKED, bits}; };
+            constexpr auto mipi10 = lirs::RawFormat{lirs::RawPacking::MIPI10, 10};
+            constexpr auto mipi12 = lirs::RawFormat{lirs::RawPacking::MIPI12, 12};
+
+            static std::map<std::string, RawSource> const sources{
+                    {"y10",      {V4L2_PIX_FMT_Y10,      unpacked(10), MONO16,       MONO8}},
+                    {"y12",      {V4L2_PIX_FMT_Y12,      unpacked(12), MONO16,       MONO8}},
+                    {"y14",      {V4L2_PIX_FMT_Y14,      unpacked(14), MONO16,       MONO8}},
+                    {"y16",      {V4L2_PIX_FMT_Y16,      unpacked(16), MONO16,       MONO8}},
+                    {"y10p",     {V4L2_PIX_FMT_Y10P,     mipi10,       MONO16,       MONO8}},
+                    {"srggb10",  {V4L2_PIX_FMT_SRGGB10,  unpacked(10), BAYER_RGGB16, BAYER_RGGB8}},
+                    {"sbggr10",  {V4L2_PIX_FMT_SBGGR10,  unpacked(10), BAYER_BGGR16, BAYER_BGGR8}},
+                    {"sgrbg10",  {V4L2_PIX_FMT_SGRBG10,  unpacked(10), BAYER_GRBG16, BAYER_GRBG8}},
+                    {"sgbrg10",  {V4L2_PIX_FMT_SGBRG10,  unpacked(10), BAYER_GBRG16, BAYER_GBRG8}},
+                    {"srggb12",  {V4L2_PIX_FMT_SRGGB12,  unpacked(12), BAYER_RGGB16, BAYER_RGGB8}},
+                    {"sbggr12",  {V4L2_PIX_FMT_SBGGR12,  unpacked(12), BAYER_BGGR16, BAYER_BGGR8}},
+                    {"sgrbg12",  {V4L2_PIX_FMT_SGRBG12,  unpacked(12), BAYER_GRBG16, BAYER_GRBG8}},
+                    {"sgbrg12",  {V4L2_PIX_FMT_SGBRG12,  unpacked(12), BAYER_GBRG16, BAYER_GBRG8}},
+                    {"srggb16",  {V4L2_PIX_FMT_SRGGB16,  unpacked(16), BAYER_RGGB16, BAYER_RGGB8}},
+                    {"sbggr16",  {V4L2_PIX_FMT_SBGGR16,  unpacked(16), BAYER_BGGR16, BAYER_BGGR8}},
+                    {"sgrbg16",  {V4L2_PIX_FMT_SGRBG16,  unpacked(16), BAYER_GRBG16, BAYER_GRBG8}},
+                    {"sgbrg16",  {V4L2_PIX_FMT_SGBRG16,  unpacked(16), BAYER_GBRG16, BAYER_GBRG8}},
+                    {"srggb10p", {V4L2_PIX_FMT_SRGGB10P, mipi10,       BAYER_RGGB16, BAYER_RGGB8}},
+                    {"sbggr10p", {V4L2_PIX_FMT_SBGGR10P, mipi10,       BAYER_BGGR16, BAYER_BGGR8}},
+                    {"sgrbg10p", {V4L2_PIX_FMT_SGRBG10P, mipi10,       BAYER_GRBG16, BAYER_GRBG8}},
+                    {"sgbrg10p", {V4L2_PIX_FMT_SGBRG10P, mipi10,       BAYER_GBRG16, BAYER_GBRG8}},
+                    {"srggb12p", {V4L2_PIX_FMT_SRGGB12P, mipi12,       BAYER_RGGB16, BAYER_RGGB8}},
+                    {"sbggr12p", {V4L2_PIX_FMT_SBGGR12P, mipi12,       BAYER_BGGR16, BAYER_BGGR8}},
+                    {"sgrbg12p", {V4L2_PIX_FMT_SGRBG12P, mipi12,       BAYER_GRBG16, BAYER_GRBG8}},
+                    {"sgbrg12p", {V4L2_PIX_FMT_SGBRG12P, mipi12,       BAYER_GBRG16, BAYER_GBRG8}}
+            };
+
+            if (auto source = sources.find(sourcePixelFormat); source != sources.end()) {
+                return source->second;
+            }
+            return std::nullopt;
+        }
+
+        // Parses window of the raw values, negative maximum stands for the maximum of the bit depth
+        static std::optional<lirs::RawWindow> findRawWindow(lirs::RawFormat format, int min, int max) {
+            auto limit = (1 << format.bits) - 1;
+
+            if (max < 0) max = limit;
+
+            if (min < 0 || min >= max || max > limit) return std::nullopt;
+
+            return lirs::RawWindow{static_cast<uint16_t>(min), static_cast<uint16_t>(max)};
+        }
+
+        static std::optional<lirs::BayerPattern> findBayerPattern(std::string const &imageFormat) {
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_RGGB8) return lirs::BayerPattern::RGGB;
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_BGGR8) return lirs::BayerPattern::BGGR;
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GRBG8) return lirs::BayerPattern::GRBG;
+            if (imageFormat == sensor_msgs::image_encodings::BAYER_GBRG8) return lirs::BayerPattern::GBRG;
+            return std::nullopt;
+        }
+
+        // Checks if Bayer image could be demosaiced into the given image format
+        static bool isDebayerImageFormat(std::string const &imageFormat) {
+            return isRgbImageFormat(imageFormat) || imageFormat == sensor_msgs::image_encodings::MONO8;
+        }
+
+        static std::optional<EncodedSource> findEncodedSource(std::string const &sourcePixelFormat) {
+            if (sourcePixelFormat == "h264") return EncodedSource{V4L2_PIX_FMT_H264, lirs::VideoCodec::H264};
+            if (sourcePixelFormat == "hevc") return EncodedSource{V4L2_PIX_FMT_HEVC, lirs::VideoCodec::HEVC};
+            return std::nullopt;
+        }
+
+        // Finds layout of the JPEG images decoded into the image format
+        static std::optional<lirs::DecodedFormat> findDecodedFormat(std::string const &imageFormat) {
+            if (imageFormat == sensor_msgs::image_encodings::RGB8) return lirs::DecodedFormat::RGB8;
+            if (imageFormat == sensor_msgs::image_encodings::BGR8) return lirs::DecodedFormat::BGR8;
+            if (imageFormat == sensor_msgs::image_encodings::MONO8) return lirs::DecodedFormat::MONO8;
+            return std::nullopt;
+        }
+
+        // Parses YUV 4:2:2 to RGB conversion settings (captured YUV layout, color matrix and range)
+        static std::optional<lirs::YuvToRgb> findYuvToRgbConversion(std::string const &imageFormat,
+                                                                    std::string const &sourcePixelFormat,
+                                                                    std::string const &colorMatrix,
+                                                                    std::string const &colorRange) {
+            lirs::YuvToRgb conversion{};
+
+            conversion.order = imageFormat == sensor_msgs::image_encodings::BGR8 ? lirs::RgbOrder::BGR
+                                                                                 : lirs::RgbOrder::RGB;
+
+            if (sourcePixelFormat == "yuyv") conversion.layout = lirs::YuvLayout::YUYV;
+            else if (sourcePixelFormat == "uyvy") conversion.layout = lirs::YuvLayout::UYVY;
+            else return std::nullopt;
+
+            if (colorMatrix == "bt601") conversion.matrix = lirs::ColorMatrix::BT601;
+            else if (colorMatrix == "bt709") conversion.matrix = lirs::ColorMatrix::BT709;
+            else return std::nullopt;
+
+            if (colorRange == "limited") conversion.range = lirs::ColorRange::LIMITED;
+            else if (colorRange == "full") conversion.range = lirs::ColorRange::FULL;
+            else return std::nullopt;
+
+            return conversion;
+        }
+
+        static std::optional<lirs::OverflowPolicy> findOverflowPolicy(std::string const &policy) {
+            if (policy == "drop_oldest") return lirs::OverflowPolicy::DROP_OLDEST;
+            if (policy == "drop_newest") return lirs::OverflowPolicy::DROP_NEWEST;
+            if (policy == "block") return lirs::OverflowPolicy::BLOCK;
+            return std::nullopt;
+        }
+
+        static std::optional<lirs::MemoryType> findMemoryType(std::string const &memoryType) {
+            if (memoryType == "mmap") return lirs::MemoryType::MMAP;
+            if (memoryType == "userptr") return lirs::MemoryType::USERPTR;
+            return std::nullopt;
+        }
+
+        static bool checkImageFormat(std::string const &imageFormat) {
+            if (!(sensor_msgs::image_encodings::isMono(imageFormat)
+                  || sensor_msgs::image_encodings::isBayer(imageFormat)
+                  || sensor_msgs::image_encodings::isColor(imageFormat)
+                  || imageFormat == sensor_msgs::image_encodings::YUV422)) {
+                ROS_ERROR_STREAM("Given ROS image format: " << imageFormat << " is not supported!");
+                return false;
+            }
+            return true;
+        }
+
+        static sensor_msgs::ImagePtr imageMessageFrom(std::string const &frameId, std::string const &imageFormat,
+                                                      lirs::VideoCapture const &capture) {
+
+            auto imageMsg = boost::make_shared<sensor_msgs::Image>();
+            imageMsg->header.frame_id = frameId;
+            imageMsg->width = static_cast<uint32_t >(capture.Get(lirs::CaptureParam::FRAME_WIDTH));
+            imageMsg->height = static_cast<uint32_t >(capture.Get(lirs::CaptureParam::FRAME_HEIGHT));
+            imageMsg->is_bigendian = 0;
+
+            // YUV 4:2:2 is converted into 3 byte pixels
+            if (isRgbImageFormat(imageFormat)) {
+                imageMsg->encoding = imageFormat;
+                imageMsg->step = imageMsg->width * 3;
+                imageMsg->data.resize(imageMsg->step * imageMsg->height);
+
+                return imageMsg;
+            }
+
+            auto isYuyvCapture = capture.Get(lirs::CaptureParam::V4L2_PIX_FMT) == V4L2_PIX_FMT_YUYV;
+
+            // YUV422 represents UYVY (not YUYV), thus YUYV bytes are swapped
+            if (imageFormat == sensor_msgs::image_encodings::YUV422 && isYuyvCapture) {
+                imageMsg->encoding = imageFormat;
+                imageMsg->step = imageMsg->width * 2;
+                imageMsg->data.resize(imageMsg->step * imageMsg->height);
+            } else if (imageFormat == sensor_msgs::image_encodings::MONO8 && isYuyvCapture) {
+                imageMsg->encoding = imageFormat;
+                imageMsg->step = imageMsg->width;  // 1 byte pixel (depth)
+                imageMsg->data.resize(imageMsg->step * imageMsg->height);
+            } else {
+                imageMsg->encoding = imageFormat;
+                imageMsg->step = static_cast<uint32_t >(capture.imageStep());
+                imageMsg->data.resize(static_cast<size_t >(capture.imageSize()));
+            }
+
+            return imageMsg;
+        }
+
+        // Demosaics 8-bit Bayer image into the message (rgb8, bgr8 or mono8)
+        static void debayer(lirs::BayerPattern pattern, uint8_t const *src, size_t srcStep,
+                            sensor_msgs::Image &debayerMsg) {
+
+            if (debayerMsg.encoding == sensor_msgs::image_encodings::MONO8) {
+                lirs::PixelConversion::bayer_to_mono8(pattern, src, srcStep, debayerMsg.data.data(), debayerMsg.step,
+                                                      static_cast<int>(debayerMsg.width),
+                                                      static_cast<int>(debayerMsg.height));
+            } else {
+                auto order = debayerMsg.encoding == sensor_msgs::image_encodings::BGR8 ? lirs::RgbOrder::BGR
+                                                                                       : lirs::RgbOrder::RGB;
+
+                lirs::PixelConversion::bayer_to_rgb(pattern, order, src, srcStep, debayerMsg.data.data(),
+                                                    debayerMsg.step, static_cast<int>(debayerMsg.width),
+                                                    static_cast<int>(debayerMsg.height));
+            }
+        }
+
+    }  // namespace ros_utils
+
+    CameraStreamer::CameraStreamer(ros::NodeHandle nodeHandle, ros::NodeHandle paramHandle, bool isZeroCopy)
+            : nodeHandle_{std::move(nodeHandle)}, isZeroCopy_{isZeroCopy}, imageTransport_{nodeHandle_},
+              latencyReportPeriod_{0.0}, decodeThreads_{0}, encodeThreads_{0}, dmabufFramesInFlight_{0},
+              isLazy_{false}, standbyDelay_{0.0},
+              pixFormat_{0}, rawWindow_{}, isSideBySide_{false}, isStreaming_{false},
+              isSubscriptionChanged_{true}, connectedAt_{0}, wasActive_{false}, isAwaitingFirstFrame_{false},
+              isResumed_{false}, hasRawSubscribers_{false}, hasDebayerSubscribers_{false} {
+
+        if (!configure(paramHandle)) return;
+
+        if (!capture_->StartStreaming()) {
+            ROS_ERROR_STREAM("Couldn't start streaming on: " << capture_->device() << ". Check streaming parameters.");
+            return;
+        }
+
+        // halves are sized from the negotiated width (the driver could adjust the requested one)
+        if (auto width = capture_->Get(lirs::CaptureParam::FRAME_WIDTH); isSideBySide_ && width % 4 != 0) {
+            ROS_ERROR_STREAM("Side-by-side splitting requires width divisible by 4 (negotiated " << width << ")");
+            capture_->StopStreaming();  // buffers are released
+            return;
+        }
+
+        if (!dmabufSocket_.empty()) {
+            dmabufPublisher_ = std::make_unique<lirs::DmaBufPublisher>(*capture_, dmabufSocket_,
+                                                                       static_cast<size_t>(dmabufFramesInFlight_));
+
+            if (!dmabufPublisher_->IsListening()) {
+                ROS_ERROR_STREAM("Couldn't share buffers on: " << dmabufSocket_);
+                capture_->StopStreaming();  // buffers are released
+                return;
+            }
+        }
+
+        advertise();
+
+        isStreaming_ = true;
+    }
+
+    bool CameraStreamer::IsStreaming() const {
+        return isStreaming_;
+    }
+
+    bool CameraStreamer::configure(ros::NodeHandle &paramHandle) {
+        std::string deviceName;
+
+        int width;
+        int height;
+        int frameRate;
+
+        int captureQueueSize;
+        std::string overflowPolicyName;
+
+        bool latestFrameOnly;
+        std::string memoryTypeName;
+
+        std::string sourcePixelFormat;
+        std::string colorMatrix;
+        std::string colorRange;
+
+        int windowMin;
+        int windowMax;
+
+        int jpegQuality;
+
+        paramHandle.param("device_name", deviceName, std::string{ros_utils::DEFAULT_DEVICE_NAME});
+        paramHandle.param("camera_name", cameraName_, std::string{ros_utils::DEFAULT_CAMERA_NAME});
+        paramHandle.param("frame_id", frameId_, std::string{ros_utils::DEFAULT_FRAME_ID});
+        paramHandle.param("camera_info_url", cameraInfoUrl_, std::string{ros_utils::DEFAULT_CAMERA_INFO_URL});
+        paramHandle.param("width", width, ros_utils::DEFAULT_FRAME_WIDTH);
+        paramHandle.param("height", height, ros_utils::DEFAULT_FRAME_HEIGHT);
+        paramHandle.param("fps", frameRate, ros_utils::DEFAULT_FRAME_RATE);
+        paramHandle.param("image_format", imageFormat_, std::string{ros_utils::DEFAULT_IMAGE_FORMAT});
+        paramHandle.param("capture_queue_size", captureQueueSize, ros_utils::DEFAULT_CAPTURE_QUEUE_SIZE);
+        paramHandle.param("overflow_policy", overflowPolicyName, std::string{ros_utils::DEFAULT_OVERFLOW_POLICY});
+        paramHandle.param("latency_report_period", latencyReportPeriod_, ros_utils::DEFAULT_LATENCY_REPORT_PERIOD);
+        paramHandle.param("latest_frame_only", latestFrameOnly, ros_utils::DEFAULT_LATEST_FRAME_ONLY);
+        paramHandle.param("memory_type", memoryTypeName, std::string{ros_utils::DEFAULT_MEMORY_TYPE});
+        paramHandle.param("source_pixel_format", sourcePixelFormat,
+                          std::string{ros_utils::DEFAULT_SOURCE_PIXEL_FORMAT});
+        paramHandle.param("color_matrix", colorMatrix, std::string{ros_utils::DEFAULT_COLOR_MATRIX});
+        paramHandle.param("color_range", colorRange, std::string{ros_utils::DEFAULT_COLOR_RANGE});
+        paramHandle.param("debayer_format", debayerFormat_, std::string{ros_utils::DEFAULT_DEBAYER_FORMAT});
+        paramHandle.param("window_min", windowMin, ros_utils::DEFAULT_WINDOW_MIN);
+        paramHandle.param("window_max", windowMax, ros_utils::DEFAULT_WINDOW_MAX);
+        paramHandle.param("decode_threads", decodeThreads_, ros_utils::DEFAULT_DECODE_THREADS);
+        paramHandle.param("encode_threads", encodeThreads_, ros_utils::DEFAULT_ENCODE_THREADS);
+        paramHandle.param("jpeg_quality", jpegQuality, ros_utils::DEFAULT_JPEG_QUALITY);
+        paramHandle.param("dmabuf_socket", dmabufSocket_, std::string{ros_utils::DEFAULT_DMABUF_SOCKET});
+        paramHandle.param("dmabuf_frames_in_flight", dmabufFramesInFlight_,
+                          ros_utils::DEFAULT_DMABUF_FRAMES_IN_FLIGHT);
+        paramHandle.param("lazy_streaming", isLazy_, ros_utils::DEFAULT_LAZY_STREAMING);
+        paramHandle.param("standby_delay", standbyDelay_, ros_utils::DEFAULT_STANDBY_DELAY);
+        paramHandle.param("side_by_side", isSideBySide_, ros_utils::DEFAULT_SIDE_BY_SIDE);
+        paramHandle.param("left_camera_info_url", leftCameraInfoUrl_,
+                          std::string{ros_utils::DEFAULT_LEFT_CAMERA_INFO_URL});
+        paramHandle.param("right_camera_info_url", rightCameraInfoUrl_,
+                          std::string{ros_utils::DEFAULT_RIGHT_CAMERA_INFO_URL});
+
+        // encoded stream is published as packets, i.e. image format is not used
+        encodedSource_ = ros_utils::findEncodedSource(sourcePixelFormat);
+
+        // checking image format
+
+        if (!encodedSource_ && !ros_utils::checkImageFormat(imageFormat_)) {
+            return false;
+        }
+
+        auto pixFormat = encodedSource_ ? std::optional{encodedSource_->v4l2PixFmt}
+                                        : ros_utils::findCorrespondentV4l2PixFmt(imageFormat_);
+
+        if (!pixFormat) {
+            ROS_ERROR_STREAM("No corresponding v4l2 pixel format found for the given image format: " << imageFormat_);
+            return false;
+        }
+
+        // MJPEG frames are published untouched (compressed topic) and decoded by the worker threads
+        if (sourcePixelFormat == "mjpeg") {
+            decodedFormat_ = ros_utils::findDecodedFormat(imageFormat_);
+
+            if (!decodedFormat_ || decodeThreads_ < 1) {
+                ROS_ERROR_STREAM("MJPEG source could be decoded into rgb8, bgr8 or mono8 image formats only (given "
+                                         << imageFormat_ << ") by at least one thread (given " << decodeThreads_
+                                         << ")");
+                return false;
+            }
+
+            pixFormat = V4L2_PIX_FMT_MJPEG;
+        }
+
+        if (ros_utils::isRgbImageFormat(imageFormat_) && !decodedFormat_ && !encodedSource_) {
+            yuvToRgb_ = ros_utils::findYuvToRgbConversion(imageFormat_, sourcePixelFormat, colorMatrix, colorRange);
+
+            if (!yuvToRgb_) {
+                ROS_ERROR_STREAM("Unknown color conversion: " << sourcePixelFormat << ", " << colorMatrix << ", "
+                                                              << colorRange << " (expected yuyv or uyvy, "
+                                                              << "bt601 or bt709, limited or full)");
+                return false;
+            }
+
+            pixFormat = yuvToRgb_->layout == lirs::YuvLayout::UYVY ? V4L2_PIX_FMT_UYVY : V4L2_PIX_FMT_YUYV;
+        }
+
+        // UYVY devices are published as is
+        if (imageFormat_ == sensor_msgs::image_encodings::YUV422 && sourcePixelFormat == "uyvy") {
+            pixFormat = V4L2_PIX_FMT_UYVY;
+        }
+
+        // high bit depth source is unpacked (16-bit image formats) or windowed (8-bit image formats)
+        rawSource_ = ros_utils::findRawSource(sourcePixelFormat);
+
+        if (rawSource_) {
+            if (imageFormat_ != rawSource_->imageFormat16 && imageFormat_ != rawSource_->imageFormat8) {
+                ROS_ERROR_STREAM("Source pixel format: " << sourcePixelFormat << " could be published as "
+                                                         << rawSource_->imageFormat16 << " or "
+                                                         << rawSource_->imageFormat8 << " only (given "
+                                                         << imageFormat_ << ")");
+                return false;
+            }
+
+            if (auto window = ros_utils::findRawWindow(rawSource_->format, windowMin, windowMax)) {
+                rawWindow_ = *window;
+            } else {
+                ROS_ERROR_STREAM("Invalid window: [" << windowMin << ", " << windowMax << "] for "
+                                                     << int{rawSource_->format.bits} << "-bit source");
+                return false;
+            }
+
+            pixFormat = rawSource_->v4l2PixFmt;
+        }
+
+        // Bayer image is demosaiced once in the node (published alongside the raw one)
+        if (!debayerFormat_.empty()) {
+            bayerPattern_ = ros_utils::findBayerPattern(imageFormat_);
+
+            if (!bayerPattern_ || !ros_utils::isDebayerImageFormat(debayerFormat_)) {
+                ROS_ERROR_STREAM("Unsupported debayering: " << imageFormat_ << " -> " << debayerFormat_
+                                                            << " (expected bayer_*8 image format, "
+                                                            << "rgb8, bgr8 or mono8)");
+                return false;
+            }
+        }
+
+        // YUV 4:2:2 frames are compressed right from the v4l2 buffer (no RGB intermediate)
+        if (encodeThreads_ > 0) {
+            auto isYuvSource = *pixFormat == V4L2_PIX_FMT_YUYV || *pixFormat == V4L2_PIX_FMT_UYVY;
+
+            if (!isYuvSource || jpegQuality < 1 || jpegQuality > 100
+                || (colorRange != "limited" && colorRange != "full")) {
+                ROS_ERROR_STREAM("JPEG compression requires yuv422, mono8, rgb8 or bgr8 image format "
+                                         << "(captured as YUV 4:2:2), quality in [1, 100] (given " << jpegQuality
+                                         << ") and limited or full color range (given " << colorRange << ")");
+                return false;
+            }
+
+            jpegEncoding_ = lirs::JpegEncoding{};
+            jpegEncoding_->layout = *pixFormat == V4L2_PIX_FMT_UYVY ? lirs::YuvLayout::UYVY : lirs::YuvLayout::YUYV;
+            jpegEncoding_->range = colorRange == "full" ? lirs::ColorRange::FULL : lirs::ColorRange::LIMITED;
+            jpegEncoding_->isGray = imageFormat_ == sensor_msgs::image_encodings::MONO8;
+            jpegEncoding_->quality = jpegQuality;
+        }
+
+        // side-by-side stereo frame is split by columns, i.e. halves consist of the whole YUV 4:2:2 macropixels
+        if (isSideBySide_) {
+            auto isYuvSource = *pixFormat == V4L2_PIX_FMT_YUYV || *pixFormat == V4L2_PIX_FMT_UYVY;
+
+            if (!isYuvSource || encodedSource_ || decodedFormat_ || rawSource_ || jpegEncoding_) {
+                ROS_ERROR_STREAM("Side-by-side splitting requires yuv422, mono8, rgb8 or bgr8 image format "
+                                         << "(captured as YUV 4:2:2) and no in-node JPEG compression");
+                return false;
+            }
+        }
+
+        if (standbyDelay_ < 0.0) {
+            ROS_ERROR_STREAM("Invalid standby delay: " << standbyDelay_ << " s");
+            return false;
+        }
+
+        auto overflowPolicy = ros_utils::findOverflowPolicy(overflowPolicyName);
+
+        if (!overflowPolicy) {
+            ROS_ERROR_STREAM("Unknown overflow policy: " << overflowPolicyName
+                                                         << " (expected drop_oldest, drop_newest or block)");
+            return false;
+        }
+
+        auto memoryType = ros_utils::findMemoryType(memoryTypeName);
+
+        if (!memoryType || (*memoryType == lirs::MemoryType::USERPTR && !dmabufSocket_.empty())) {
+            ROS_ERROR_STREAM("Unknown memory type: " << memoryTypeName
+                                                     << " (expected mmap or userptr, buffers are shared in mmap only)");
+            return false;
+        }
+
+        pixFormat_ = *pixFormat;
+
+        capture_ = std::make_unique<lirs::V4L2Capture>(deviceName, pixFormat_, static_cast<uint32_t>(width),
+                                                       static_cast<uint32_t>(height),
+                                                       static_cast<uint32_t>(frameRate));
+
+        if (!capture_->IsOpened()) {
+            ROS_ERROR_STREAM("Couldn't open the video device: " << deviceName);
+            return false;
+        }
+
+        // decouple capturing from publishing (capture thread)
+        if (!capture_->Set(lirs::CaptureParam::CAPTURE_QUEUE_SIZE, captureQueueSize)) {
+            ROS_ERROR_STREAM("Invalid capture queue size: " << captureQueueSize);
+            return false;
+        }
+
+        if (!capture_->Set(lirs::CaptureParam::OVERFLOW_POLICY, static_cast<int>(*overflowPolicy))) {
+            ROS_ERROR_STREAM("Invalid overflow policy: " << overflowPolicyName);
+            return false;
+        }
+
+        // publish only the freshest frame (stale ones are skipped)
+        capture_->Set(lirs::CaptureParam::LATEST_FRAME_ONLY, latestFrameOnly);
+
+        // driver writes into the capture's cacheable buffers (userptr) or into its own ones (mmap)
+        capture_->Set(lirs::CaptureParam::MEMORY_TYPE, static_cast<int>(*memoryType));
+
+        // shared frames are borrowed from the v4l2 buffers, i.e. not copied by the capture thread
+        if (!dmabufSocket_.empty()) {
+            if (captureQueueSize > 0 || dmabufFramesInFlight_ < 1) {
+                ROS_ERROR_STREAM("Sharing buffers requires capture_queue_size 0 (given " << captureQueueSize
+                                         << ") and at least one frame in flight (given " << dmabufFramesInFlight_
+                                         << ")");
+                return false;
+            }
+
+            capture_->Set(lirs::CaptureParam::EXPORT_DMABUF, 1);
+        }
+
+        return true;
+    }
+
+    void CameraStreamer::advertise() {
+        cameraInfoManager_ = std::make_unique<camera_info_manager::CameraInfoManager>(nodeHandle_, cameraName_,
+                                                                                      cameraInfoUrl_);
+        cameraInfoMsg_ = cameraInfoManager_->getCameraInfo();
+
+        // NOTE: Image message format may differ from the image format (see imageMessageFrom() method).
+        imageMsg_ = rawSource_ || decodedFormat_
+                    ? ros_utils::convertedImageMessageFrom(frameId_, imageFormat_, *capture_)
+                    : ros_utils::imageMessageFrom(frameId_, imageFormat_, *capture_);
+
+        // if no cameraInfoUrl is provided
+        if (cameraInfoMsg_.distortion_model.empty()) {
+            cameraInfoMsg_ = ros_utils::defaultCameraInfoFrom(imageMsg_);
+            cameraInfoManager_->setCameraInfo(cameraInfoMsg_);
+        }
+
+        // subscribers are counted on the subscription changes only
+        auto const callbacks = ros_utils::SubscriberCallbacks{
+                [this](auto const &) { onSubscriberConnected(); },
+                [this](auto const &) { onSubscriberDisconnected(); },
+                [this](auto const &) { onSubscriberConnected(); },
+                [this](auto const &) { onSubscriberDisconnected(); }};
+
+        // JPEG images are published on the compressed topic by the node instead of image_transport
+        if (decodedFormat_ || jpegEncoding_) {
+            compressedPublisher_ = std::make_unique<lirs::CompressedPublisher>(
+                    nodeHandle_, cameraName_, frameId_, jpegEncoding_, static_cast<size_t>(encodeThreads_),
+                    latencyReportPeriod_, callbacks);
+        }
+
+        if (!encodedSource_ && !isSideBySide_) {
+            publisher_ = imageTransport_.advertiseCamera("image", 10, callbacks.onImageConnect,
+                                                         callbacks.onImageDisconnect, callbacks.onConnect,
+                                                         callbacks.onDisconnect);
+        }
+
+        if (isSideBySide_) {
+            halvesPublisher_ = std::make_unique<lirs::StereoHalvesPublisher>(
+                    nodeHandle_, imageTransport_, cameraName_, frameId_, imageFormat_,
+                    std::array<std::string, 2>{leftCameraInfoUrl_, rightCameraInfoUrl_}, *capture_, isZeroCopy_,
+                    callbacks, [this](uint8_t const *src, size_t srcStep, size_t srcSize, sensor_msgs::Image &msg) {
+                        convertYuv(src, srcStep, srcSize, msg);
+                    });
+        }
+
+        latencyReporter_ = std::make_unique<ros_utils::LatencyReporter>(
+                cameraName_ + " capture-to-publish latency", latencyReportPeriod_);
+
+        if (decodedFormat_) {
+            imageMsg_->data = {};  // images are decoded into the workers' buffers
+
+            if (isZeroCopy_) {
+                imagePool_ = std::make_unique<ros_utils::ImageMessagePool>(*imageMsg_);
+            }
+
+            // decoded image is swapped into the message and published right from the worker thread (in order)
+            auto publishDecoded = [this, imageTemplate = *imageMsg_, cameraInfo = cameraInfoMsg_]
+                    (lirs::FrameInfo const &info, std::vector<uint8_t> &image) mutable {
+                auto stamp = ros_utils::rosTimeFrom(info.timestamp);
+
+                if (imagePool_) {
+                    // worker decodes the next image into the buffer of the released message
+                    auto imageMsg = imagePool_->acquire();
+                    imageMsg->data.swap(image);
+                    ros_utils::publishShared(publisher_, cameraInfo, imageMsg, stamp);
+                } else {
+                    imageTemplate.data.swap(image);
+                    publisher_.publish(imageTemplate, cameraInfo, stamp);
+                    imageTemplate.data.swap(image);
+                }
+
+                latencyReporter_->add(stamp);
+            };
+
+            // frames being decoded are copied off the v4l2 buffers (one per worker plus the submitted one)
+            decodeFramePool_ = std::make_unique<lirs::FramePool>(static_cast<size_t>(capture_->imageSize()),
+                                                                 static_cast<size_t>(decodeThreads_) + 1);
+
+            decodePool_ = std::make_unique<lirs::JpegDecodePool>(static_cast<size_t>(decodeThreads_), *decodedFormat_,
+                                                                 static_cast<int>(imageMsg_->width),
+                                                                 static_cast<int>(imageMsg_->height),
+                                                                 std::move(publishDecoded));
+        }
+
+        // access units are published as is (no decoding)
+        if (encodedSource_) {
+            packetPublisher_ = std::make_unique<lirs::PacketPublisher>(
+                    nodeHandle_, frameId_, encodedSource_->codec,
+                    static_cast<uint32_t >(capture_->Get(lirs::CaptureParam::FRAME_WIDTH)),
+                    static_cast<uint32_t >(capture_->Get(lirs::CaptureParam::FRAME_HEIGHT)), callbacks);
+        }
+
+        if (bayerPattern_) {
+            auto isMono = debayerFormat_ == sensor_msgs::image_encodings::MONO8;
+
+            debayerPublisher_ = imageTransport_.advertise(isMono ? "image_mono" : "image_color", 10,
+                                                          callbacks.onImageConnect, callbacks.onImageDisconnect);
+            debayerMsg_ = ros_utils::convertedImageMessageFrom(frameId_, debayerFormat_, *capture_);
+
+            if (isZeroCopy_) {
+                debayerPool_ = std::make_unique<ros_utils::ImageMessagePool>(*debayerMsg_);
+            }
+        }
+
+        // published messages are held by the intra-process subscribers, thus are not overwritten (see convert())
+        if (isZeroCopy_ && !decodedFormat_ && !encodedSource_ && !isSideBySide_) {
+            imagePool_ = std::make_unique<ros_utils::ImageMessagePool>(*imageMsg_);
+        }
+    }
+
+    void CameraStreamer::onSubscriberConnected() {
+        connectedAt_ = std::chrono::steady_clock::now().time_since_epoch().count();
+        isSubscriptionChanged_ = true;
+    }
+
+    void CameraStreamer::onSubscriberDisconnected() {
+        isSubscriptionChanged_ = true;
+    }
+
+    bool CameraStreamer::UpdateSubscribers() {
+        if (isSubscriptionChanged_.exchange(false)) {
+            hasRawSubscribers_ = halvesPublisher_ ? halvesPublisher_->UpdateSubscribers()
+                                                  : publisher_.getNumSubscribers() > 0;
+            hasDebayerSubscribers_ = bayerPattern_ && debayerPublisher_.getNumSubscribers() > 0;
+
+            if (compressedPublisher_) {
+                compressedPublisher_->UpdateSubscribers();
+            }
+
+            if (packetPublisher_) {
+                packetPublisher_->UpdateSubscribers();
+            }
+        }
+
+        auto hasDmaBufClients = dmabufPublisher_ && dmabufPublisher_->UpdateClients();
+
+        auto isActive = hasRawSubscribers_ || hasDebayerSubscribers_ || hasDmaBufClients
+                        || (compressedPublisher_ && compressedPublisher_->hasSubscribers())
+                        || (packetPublisher_ && packetPublisher_->hasSubscribers());
+
+        if (!isActive && packetPublisher_) {
+            packetPublisher_->AwaitKeyframe();
+        }
+
+        return isLazy_ ? updateStreaming(isActive) : isActive;
+    }
+
+    bool CameraStreamer::updateStreaming(bool isActive) {
+        if (isActive) {
+            idleSince_.reset();
+
+            if (capture_->IsPaused()) {
+                if (!capture_->ResumeStreaming()) {
+                    ROS_ERROR_STREAM("Couldn't resume streaming on: " << capture_->device());
+                    return false;
+                }
+
+                isResumed_ = true;
+            }
+
+            isAwaitingFirstFrame_ = isAwaitingFirstFrame_ || !wasActive_;
+            wasActive_ = true;
+
+            return true;
+        }
+
+        wasActive_ = false;
+
+        if (!capture_->IsStreaming()) return false;
+
+        auto now = std::chrono::steady_clock::now();
+
+        // warm standby: subscribers often reconnect shortly, thus streaming is kept for a while
+        if (!idleSince_) {
+            idleSince_ = now;
+        }
+
+        // nobody reads frames, thus the filled buffers are released in order the reconnected subscriber gets fresh ones
+        capture_->DiscardReadyFrames();
+
+        if (now - *idleSince_ >= std::chrono::duration<double>{standbyDelay_}) {
+            if (capture_->PauseStreaming()) {
+                ROS_INFO_STREAM(cameraName_ << " has no subscribers, streaming is paused");
+            } else {
+                ROS_ERROR_STREAM("Couldn't pause streaming on: " << capture_->device());
+            }
+        }
+
+        return false;
+    }
+
+    std::optional<Frame> CameraStreamer::ReadFrame() {
+        // frames are shared with the connected processes (no copy) before being published
+        return dmabufPublisher_ ? dmabufPublisher_->ReadFrame() : capture_->ReadFrame();
+    }
+
+    void CameraStreamer::Publish(Frame frame) {
+        auto captured = convert(std::move(frame));
+
+        if (!captured) return;
+
+        auto stamp = ros_utils::rosTimeFrom(*captured);
+
+        if (hasRawSubscribers_ && halvesPublisher_) {
+            halvesPublisher_->Publish(stamp);
+        } else if (hasRawSubscribers_ && !decodePool_) {
+            if (imagePool_) {
+                ros_utils::publishShared(publisher_, cameraInfoMsg_, imageMsg_, stamp);
+            } else {
+                publisher_.publish(*imageMsg_, cameraInfoMsg_, stamp);
+            }
+        }
+
+        if (hasDebayerSubscribers_) {
+            debayerMsg_->header.stamp = stamp;
+            debayerPublisher_.publish(debayerMsg_);
+        }
+
+        // decoded images are reported by the workers
+        if (!decodePool_ || !hasRawSubscribers_) {
+            latencyReporter_->add(stamp);
+        }
+
+        // lazy streaming: from the subscriber's connection till the first published frame
+        if (isAwaitingFirstFrame_) {
+            auto connectedAt = std::chrono::steady_clock::time_point{std::chrono::steady_clock::duration{connectedAt_}};
+            auto elapsed = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - connectedAt};
+
+            ROS_INFO_STREAM(cameraName_ << " time to first frame: " << elapsed.count() << " ms"
+                                        << (isResumed_ ? " (streaming resumed)" : " (warm standby)"));
+
+            isAwaitingFirstFrame_ = false;
+            isResumed_ = false;
+        }
+    }
+
+    std::optional<std::chrono::nanoseconds> CameraStreamer::convert(Frame frame) {
+        auto captured = frame.timestamp();
+
+        // previous messages could still be held by the subscribers, thus are replaced with the released ones
+        if (imagePool_ && !decodePool_) {
+            imageMsg_.reset();
+            imageMsg_ = imagePool_->acquire();
+        }
+
+        if (debayerPool_ && hasDebayerSubscribers_) {
+            debayerMsg_.reset();
+            debayerMsg_ = debayerPool_->acquire();
+        }
+
+        if (packetPublisher_) {
+            if (!packetPublisher_->Publish(frame)) return std::nullopt;  // awaiting keyframe
+        } else if (decodePool_) {
+            if (compressedPublisher_->hasSubscribers()) {
+                compressedPublisher_->Publish(frame.data(), frame.size(), ros_utils::rosTimeFrom(captured));
+            }
+
+            // dropped if all the workers are busy
+            if (hasRawSubscribers_) {
+                decodePool_->Submit(detach(std::move(frame)));
+            }
+        } else if (rawSource_) {
+            if (imageMsg_->encoding == rawSource_->imageFormat16) {
+                lirs::PixelConversion::raw_to_16(rawSource_->format, frame.data(),
+                                                 static_cast<size_t>(capture_->imageStep()),
+                                                 imageMsg_->data.data(), imageMsg_->step,
+                                                 static_cast<int>(imageMsg_->width),
+                                                 static_cast<int>(imageMsg_->height));
+            } else {
+                lirs::PixelConversion::raw_to_8(rawSource_->format, rawWindow_, frame.data(),
+                                                static_cast<size_t>(capture_->imageStep()),
+                                                imageMsg_->data.data(), imageMsg_->step,
+                                                static_cast<int>(imageMsg_->width),
+                                                static_cast<int>(imageMsg_->height));
+            }
+
+            // windowed Bayer image is demosaiced
+            if (hasDebayerSubscribers_) {
+                ros_utils::debayer(*bayerPattern_, imageMsg_->data.data(), imageMsg_->step, *debayerMsg_);
+            }
+        } else if (bayerPattern_) {
+            if (hasRawSubscribers_) {
+                std::copy_n(frame.data(), std::min(frame.size(), imageMsg_->data.size()), imageMsg_->data.data());
+            }
+
+            // demosaiced once for all of the subscribers
+            if (hasDebayerSubscribers_) {
+                ros_utils::debayer(*bayerPattern_, frame.data(), static_cast<size_t>(capture_->imageStep()),
+                                   *debayerMsg_);
+            }
+        } else if (halvesPublisher_) {
+            if (hasRawSubscribers_) {
+                halvesPublisher_->Convert(frame, static_cast<size_t>(capture_->imageStep()));
+            }
+        } else if (pixFormat_ == V4L2_PIX_FMT_YUYV || yuvToRgb_ || jpegEncoding_) {
+            // frame is converted from the v4l2 buffer straight into the message
+            if (hasRawSubscribers_) {
+                convertYuv(frame.data(), static_cast<size_t>(capture_->imageStep()), frame.size(), *imageMsg_);
+            }
+
+            // compressed in parallel stripes by the encoder threads
+            if (compressedPublisher_ && compressedPublisher_->hasSubscribers()) {
+                compressedPublisher_->Encode(frame.data(), static_cast<size_t>(capture_->imageStep()),
+                                             static_cast<int>(imageMsg_->width), static_cast<int>(imageMsg_->height),
+                                             ros_utils::rosTimeFrom(captured));
+            }
+        } else {
+            // planes of the multi-planar v4l2 buffer reside apart, thus are gathered one after another
+            auto isGathered = capture_->isMultiPlanar() && isBorrowingFrames();
+
+            auto dst = imageMsg_->data.data();
+            auto capacity = imageMsg_->data.size();
+
+            for (auto i = size_t{0}; i < (isGathered ? frame.planeCount() : 1); ++i) {
+                auto plane = isGathered ? frame.plane(i) : FramePlane{frame.data(), 0, frame.size()};
+                auto size = std::min(plane.size, capacity);
+
+                lirs::MemoryCopy::from_device(plane.data, dst, size);
+
+                dst += size;
+                capacity -= size;
+            }
+        }
+
+        return captured;
+    }
+
+    void CameraStreamer::convertYuv(uint8_t const *src, size_t srcStep, size_t srcSize,
+                                    sensor_msgs::Image &imageMsg) const {
+        auto width = static_cast<int>(imageMsg.width);
+        auto height = static_cast<int>(imageMsg.height);
+
+        if (yuvToRgb_) {
+            lirs::PixelConversion::yuv422_to_rgb(*yuvToRgb_, src, srcStep, imageMsg.data.data(), imageMsg.step,
+                                                 width, height);
+        } else if (imageFormat_ == sensor_msgs::image_encodings::YUV422 && pixFormat_ == V4L2_PIX_FMT_UYVY) {
+            if (srcStep == imageMsg.step) {
+                std::copy_n(src, std::min(srcSize, imageMsg.data.size()), imageMsg.data.data());
+                return;
+            }
+
+            // strided view is copied row by row (rows which fit in the source only)
+            auto rows = srcSize < imageMsg.step ? size_t{0} : (srcSize - imageMsg.step) / srcStep + 1;
+
+            for (auto row = size_t{0}; row < std::min(rows, size_t{imageMsg.height}); ++row) {
+                std::copy_n(src + row * srcStep, imageMsg.step, imageMsg.data.data() + row * imageMsg.step);
+            }
+        } else if (imageFormat_ == sensor_msgs::image_encodings::YUV422) {
+            lirs::PixelConversion::yuyv_to_uyvy(src, srcStep, imageMsg.data.data(), imageMsg.step, width, height);
+        } else {
+            lirs::PixelConversion::yuyv_to_mono8(src, srcStep, imageMsg.data.data(), imageMsg.step, width, height);
+        }
+    }
+
+    bool CameraStreamer::isBorrowingFrames() const {
+        return capture_->Get(lirs::CaptureParam::CAPTURE_QUEUE_SIZE) == 0;
+    }
+
+    Frame CameraStreamer::detach(Frame frame) {
+        if (!isBorrowingFrames()) return frame;  // already copied by the capture thread
+
+        auto copy = decodeFramePool_->Acquire(frame.size());
+
+        if (!copy) {
+            copy.emplace(nullptr, 0);
+            copy->allocate(frame.size());  // pool is exhausted, fallback to the heap
+        }
+
+        lirs::MemoryCopy::from_device(frame.data(), copy->data(), frame.size());
+        copy->stamp(frame.info());
+
+        return std::move(*copy);
+    }
+
+}  // namespace lirs
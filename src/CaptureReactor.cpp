@@ -0,0 +1,165 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/CaptureReactor.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace lirs {
+
+    CaptureReactor::CaptureReactor()
+            : epoll_{epoll_create1(EPOLL_CLOEXEC)}, isDispatching_{false} {
+
+        if (epoll_ == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot create epoll instance - " << strerror(errno) << '\n';
+            epoll_ = v4l2_constants::CLOSED_HANDLE;
+        }
+    }
+
+    CaptureReactor::~CaptureReactor() {
+        if (IsOpened()) close(epoll_);
+    }
+
+    bool CaptureReactor::IsOpened() const {
+        return epoll_ != v4l2_constants::CLOSED_HANDLE;
+    }
+
+    bool CaptureReactor::Add(V4L2Capture &capture, FrameHandler handler) {
+        if (!IsOpened()) return false;
+
+        auto handle = capture.eventHandle();
+
+        if (handle == v4l2_constants::CLOSED_HANDLE) {
+            std::cerr << "ERROR: Capture of " << capture.device() << " is not streaming\n";
+            return false;
+        }
+
+        auto isRegistered = std::any_of(registrations_.cbegin(), registrations_.cend(), [&capture](auto const &r) {
+            return r->capture == &capture;
+        });
+
+        if (isRegistered) return false;
+
+        auto registration = std::make_unique<Registration>(Registration{&capture, handle, std::move(handler)});
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = registration.get();
+
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, handle, &event) == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot register " << capture.device() << " - " << strerror(errno) << '\n';
+            return false;
+        }
+
+        registrations_.push_back(std::move(registration));
+
+        return true;
+    }
+
+    bool CaptureReactor::Remove(V4L2Capture const &capture) {
+        auto found = std::find_if(registrations_.begin(), registrations_.end(), [&capture](auto const &r) {
+            return r->capture == &capture;
+        });
+
+        if (found == registrations_.end()) return false;
+
+        // closed handles (e.g. capture queue's event of the stopped capture) are unregistered by the kernel
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, (*found)->handle, nullptr);
+
+        (*found)->capture = nullptr;
+
+        if (!isDispatching_) eraseRemoved();
+
+        return true;
+    }
+
+    size_t CaptureReactor::Poll(std::chrono::milliseconds timeout) {
+        if (!IsOpened() || registrations_.empty()) return 0;
+
+        std::array<epoll_event, capture_reactor_defaults::MAX_EVENTS> events{};
+
+        auto const maxEvents = static_cast<int>(events.size());
+
+        int ready{0};
+        do {
+            ready = epoll_wait(epoll_, events.data(), maxEvents, static_cast<int>(timeout.count()));
+        } while (ready == V4L2Utils::ERROR_CODE && errno == EINTR);
+
+        if (ready == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: epoll_wait - " << strerror(errno) << '\n';
+            return 0;
+        }
+
+        auto dispatched = size_t{0};
+
+        isDispatching_ = true;
+
+        for (auto i = 0; i < ready; ++i) {
+            auto const &event = events[static_cast<size_t>(i)];
+
+            auto &registration = *static_cast<Registration *>(event.data.ptr);
+
+            if (!registration.capture) continue;  // removed by the previous handler
+
+            // device reports errors when streaming is stopped or the device is disconnected
+            if (event.events & (EPOLLERR | EPOLLHUP)) {
+                std::cerr << "WARNING: Capture of " << registration.capture->device() << " is removed on error\n";
+                Remove(*registration.capture);
+                continue;
+            }
+
+            if (auto frame = registration.capture->ReadReadyFrame()) {
+                registration.handler(std::move(*frame));
+                ++dispatched;
+            }
+        }
+
+        isDispatching_ = false;
+
+        eraseRemoved();
+
+        return dispatched;
+    }
+
+    size_t CaptureReactor::captureCount() const {
+        return static_cast<size_t>(std::count_if(registrations_.cbegin(), registrations_.cend(), [](auto const &r) {
+            return r->capture != nullptr;
+        }));
+    }
+
+    void CaptureReactor::eraseRemoved() {
+        registrations_.erase(std::remove_if(registrations_.begin(), registrations_.end(), [](auto const &r) {
+            return r->capture == nullptr;
+        }), registrations_.end());
+    }
+
+}  // namespace lirs
@@ -0,0 +1,80 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#include "lirs_ros_video_streaming/CompressedPublisher.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace lirs {
+
+    CompressedPublisher::CompressedPublisher(ros::NodeHandle &nodeHandle, std::string const &cameraName,
+                                             std::string const &frameId, std::optional<JpegEncoding> const &encoding,
+                                             size_t encodeThreads, double latencyReportPeriod,
+                                             ros_utils::SubscriberCallbacks const &callbacks)
+            : encodeReporter_{cameraName + " JPEG compression time", latencyReportPeriod}, hasSubscribers_{false} {
+
+        // JPEG images are published by the node, thus image_transport must not advertise the same topic
+        ros::param::set(nodeHandle.resolveName("image") + "/disable_pub_plugins",
+                        std::vector<std::string>{"image_transport/compressed"});
+
+        publisher_ = nodeHandle.advertise<sensor_msgs::CompressedImage>(
+                nodeHandle.resolveName("image") + "/compressed", 10, callbacks.onConnect, callbacks.onDisconnect);
+
+        compressedMsg_ = boost::make_shared<sensor_msgs::CompressedImage>();
+        compressedMsg_->header.frame_id = frameId;
+        compressedMsg_->format = "jpeg";
+
+        if (encoding) {
+            jpegEncoder_ = std::make_unique<lirs::JpegEncoder>(encodeThreads, *encoding);
+        }
+    }
+
+    bool CompressedPublisher::UpdateSubscribers() {
+        hasSubscribers_ = publisher_.getNumSubscribers() > 0;
+        return hasSubscribers_;
+    }
+
+    void CompressedPublisher::Publish(uint8_t const *jpeg, size_t size, ros::Time const &stamp) {
+        compressedMsg_->header.stamp = stamp;
+        compressedMsg_->data.assign(jpeg, jpeg + size);
+        publisher_.publish(*compressedMsg_);
+    }
+
+    void CompressedPublisher::Encode(uint8_t const *src, size_t srcStep, int width, int height,
+                                     ros::Time const &stamp) {
+        auto started = std::chrono::steady_clock::now();
+
+        if (!jpegEncoder_->Encode(src, srcStep, width, height, compressedMsg_->data)) return;
+
+        encodeReporter_.add(ros::Duration().fromNSec(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - started).count()));
+
+        compressedMsg_->header.stamp = stamp;
+        publisher_.publish(*compressedMsg_);
+    }
+
+}  // namespace lirs
@@ -0,0 +1,71 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#include "lirs_ros_video_streaming/DmaBufPublisher.hpp"
+
+namespace lirs {
+    namespace {
+
+        DmaBufFormat dmabufFormatOf(V4L2Capture const &capture) {
+            return DmaBufFormat{static_cast<uint32_t>(capture.Get(CaptureParam::FRAME_WIDTH)),
+                                static_cast<uint32_t>(capture.Get(CaptureParam::FRAME_HEIGHT)),
+                                static_cast<uint32_t>(capture.Get(CaptureParam::V4L2_PIX_FMT))};
+        }
+
+        // clients must not hold the buffers the streamer and the driver need
+        size_t maxTotalFramesInFlightOf(V4L2Capture const &capture) {
+            auto buffersNum = static_cast<size_t>(capture.Get(CaptureParam::V4L2_BUFFERS_NUM));
+
+            return buffersNum > dmabuf_defaults::RESERVED_BUFFERS ? buffersNum - dmabuf_defaults::RESERVED_BUFFERS
+                                                                  : size_t{1};
+        }
+
+    }  // namespace
+
+    DmaBufPublisher::DmaBufPublisher(V4L2Capture &capture, std::string socketPath, size_t framesInFlight)
+            : capture_{capture}, server_{std::move(socketPath), dmabufFormatOf(capture), framesInFlight,
+                                         maxTotalFramesInFlightOf(capture)} {
+    }
+
+    bool DmaBufPublisher::IsListening() const {
+        return server_.IsListening();
+    }
+
+    bool DmaBufPublisher::UpdateClients() {
+        server_.Poll();  // new clients and released frames
+
+        return server_.clientCount() > 0;
+    }
+
+    std::optional<Frame> DmaBufPublisher::ReadFrame() {
+        if (auto exported = capture_.ReadDmaBufFrame()) {
+            server_.Publish(*exported);
+            return {std::move(exported->frame)};
+        }
+
+        return std::nullopt;
+    }
+
+}  // namespace lirs
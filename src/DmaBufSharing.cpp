@@ -0,0 +1,390 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/DmaBufSharing.hpp"
+
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace lirs {
+
+    namespace {
+        /* Control message buffer large enough for the fds of all memory planes */
+        union ControlBuffer {
+            cmsghdr header;
+            char data[CMSG_SPACE(sizeof(int) * VIDEO_MAX_PLANES)];
+        };
+
+        struct MappedPlane final {
+            void *data;
+            size_t length;
+            int fd;
+        };
+
+        std::optional<sockaddr_un> socketAddressFrom(std::string const &socketPath) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+
+            if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+                std::cerr << "ERROR: Invalid socket path - " << socketPath << '\n';
+                return std::nullopt;
+            }
+
+            std::copy(socketPath.cbegin(), socketPath.cend(), address.sun_path);
+
+            return {address};
+        }
+
+        // Synchronizes CPU access to the dmabuf (caches are maintained by the exporter)
+        void syncPlane(int fd, uint64_t flags) {
+            dma_buf_sync sync{};
+            sync.flags = flags | DMA_BUF_SYNC_READ;
+
+            while (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) == V4L2Utils::ERROR_CODE && errno == EINTR);
+        }
+
+        // Unmaps and closes the received planes, then notifies the server
+        void releasePlanes(int socket, uint64_t frameId, std::vector<MappedPlane> const &planes) {
+            for (auto const &plane : planes) {
+                if (plane.data != MAP_FAILED) {
+                    syncPlane(plane.fd, DMA_BUF_SYNC_END);
+                    munmap(plane.data, plane.length);
+                }
+                close(plane.fd);
+            }
+
+            dmabuf_protocol::ReleaseMessage release{dmabuf_protocol::MAGIC, 0, frameId};
+
+            if (send(socket, &release, sizeof(release), MSG_NOSIGNAL) == V4L2Utils::ERROR_CODE && errno != EPIPE) {
+                std::cerr << "WARNING: Cannot release shared frame - " << strerror(errno) << '\n';
+            }
+        }
+    }
+
+    DmaBufServer::DmaBufServer(std::string socketPath, DmaBufFormat format, size_t maxFramesInFlight,
+                               size_t maxTotalFramesInFlight)
+            : socketPath_{std::move(socketPath)}, format_{format},
+              maxFramesInFlight_{std::max<size_t>(maxFramesInFlight, 1)},
+              maxTotalFramesInFlight_{std::max<size_t>(maxTotalFramesInFlight, 1)},
+              socket_{v4l2_constants::CLOSED_HANDLE}, nextFrameId_{0}, firstClient_{0} {
+
+        auto address = socketAddressFrom(socketPath_);
+
+        if (!address) return;
+
+        socket_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        if (socket_ == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot create socket - " << strerror(errno) << '\n';
+            socket_ = v4l2_constants::CLOSED_HANDLE;
+            return;
+        }
+
+        // socket file of the previous run
+        if (struct stat status{}; stat(socketPath_.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+            unlink(socketPath_.c_str());
+        }
+
+        if (bind(socket_, reinterpret_cast<sockaddr const *>(&*address), sizeof(*address)) == V4L2Utils::ERROR_CODE
+            || listen(socket_, static_cast<int>(dmabuf_defaults::MAX_CLIENTS)) == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot listen on " << socketPath_ << " - " << strerror(errno) << '\n';
+            close(socket_);
+            socket_ = v4l2_constants::CLOSED_HANDLE;
+        }
+    }
+
+    DmaBufServer::~DmaBufServer() {
+        for (auto const &client : clients_) {
+            close(client.socket);
+        }
+
+        if (IsListening()) {
+            close(socket_);
+            unlink(socketPath_.c_str());
+        }
+    }
+
+    bool DmaBufServer::IsListening() const {
+        return socket_ != v4l2_constants::CLOSED_HANDLE;
+    }
+
+    void DmaBufServer::Poll() {
+        if (!IsListening()) return;
+
+        // pending clients wait in the backlog if the limit is reached
+        while (clients_.size() < dmabuf_defaults::MAX_CLIENTS) {
+            auto client = accept4(socket_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (client == V4L2Utils::ERROR_CODE) break;
+
+            clients_.push_back(Client{client, {}});
+        }
+
+        // disconnected clients' frames are released
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(), [this](Client &client) {
+            if (receiveReleases(client)) return false;
+
+            close(client.socket);
+            return true;
+        }), clients_.end());
+    }
+
+    size_t DmaBufServer::Publish(DmaBufFrame const &frame) {
+        Poll();
+
+        auto const hasFds = std::none_of(frame.fds.cbegin(), frame.fds.cend(), [](int fd) {
+            return fd == v4l2_constants::CLOSED_HANDLE;
+        });
+
+        if (!hasFds || frame.fds.empty() || frame.fds.size() > VIDEO_MAX_PLANES
+            || frame.planes.empty() || frame.planes.size() > MAX_FRAME_PLANES) {
+            std::cerr << "ERROR: Frame is not exported, see CaptureParam::EXPORT_DMABUF\n";
+            return 0;
+        }
+
+        dmabuf_protocol::FrameMessage message{};
+        message.magic = dmabuf_protocol::MAGIC;
+        message.bufferIndex = frame.bufferIndex;
+        message.timestamp = frame.frame.timestamp().count();
+        message.sequence = frame.frame.sequence();
+        message.flags = frame.frame.flags();
+        message.width = format_.width;
+        message.height = format_.height;
+        message.pixelFormat = format_.pixelFormat;
+        message.fdCount = static_cast<uint32_t>(frame.fds.size());
+        message.planeCount = static_cast<uint32_t>(frame.planes.size());
+
+        for (auto i = size_t{0}; i < frame.planes.size(); ++i) {
+            auto const &plane = frame.planes[i];
+            message.planes[i] = dmabuf_protocol::PlaneDescriptor{static_cast<uint32_t>(plane.memoryPlane),
+                                                                 static_cast<uint32_t>(plane.offset),
+                                                                 static_cast<uint32_t>(plane.step),
+                                                                 static_cast<uint32_t>(plane.size)};
+        }
+
+        // fds are duplicated into the client by the kernel
+        ControlBuffer control{};
+        iovec data{&message, sizeof(message)};
+
+        msghdr header{};
+        header.msg_iov = &data;
+        header.msg_iovlen = 1;
+        header.msg_control = control.data;
+        header.msg_controllen = CMSG_SPACE(sizeof(int) * frame.fds.size());
+
+        auto fds = CMSG_FIRSTHDR(&header);
+        fds->cmsg_level = SOL_SOCKET;
+        fds->cmsg_type = SCM_RIGHTS;
+        fds->cmsg_len = CMSG_LEN(sizeof(int) * frame.fds.size());
+        std::memcpy(CMSG_DATA(fds), frame.fds.data(), sizeof(int) * frame.fds.size());
+
+        auto sent = size_t{0};
+        auto inFlight = framesInFlight();
+
+        for (auto i = size_t{0}; i < clients_.size() && inFlight < maxTotalFramesInFlight_; ++i) {
+            auto &client = clients_[(firstClient_ + i) % clients_.size()];
+
+            if (client.inFlight.size() >= maxFramesInFlight_) continue;  // slow client skips the frame
+
+            message.frameId = nextFrameId_++;
+
+            // NOTE: Broken connection is detected by the next Poll().
+            if (sendmsg(client.socket, &header, MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(message)) {
+                client.inFlight.emplace(message.frameId, frame.frame);
+                ++inFlight;
+                ++sent;
+            }
+        }
+
+        firstClient_ = clients_.empty() ? 0 : (firstClient_ + 1) % clients_.size();
+
+        return sent;
+    }
+
+    size_t DmaBufServer::framesInFlight() const {
+        return std::accumulate(clients_.cbegin(), clients_.cend(), size_t{0}, [](size_t count, Client const &client) {
+            return count + client.inFlight.size();
+        });
+    }
+
+    bool DmaBufServer::receiveReleases(Client &client) {
+        for (dmabuf_protocol::ReleaseMessage release{};;) {
+            auto received = recv(client.socket, &release, sizeof(release), MSG_DONTWAIT);
+
+            if (received == 0) return false;  // disconnected
+
+            if (received == V4L2Utils::ERROR_CODE) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+
+            if (received == sizeof(release) && release.magic == dmabuf_protocol::MAGIC) {
+                client.inFlight.erase(release.frameId);
+            }
+        }
+    }
+
+    DmaBufClient::DmaBufClient(std::string const &socketPath) {
+        auto address = socketAddressFrom(socketPath);
+
+        if (!address) return;
+
+        auto fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+        if (fd == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot create socket - " << strerror(errno) << '\n';
+            return;
+        }
+
+        if (connect(fd, reinterpret_cast<sockaddr const *>(&*address), sizeof(*address)) == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot connect to " << socketPath << " - " << strerror(errno) << '\n';
+            close(fd);
+            return;
+        }
+
+        socket_ = std::shared_ptr<int>{new int{fd}, [](int *socket) {
+            close(*socket);
+            delete socket;
+        }};
+    }
+
+    bool DmaBufClient::IsConnected() const {
+        return static_cast<bool>(socket_);
+    }
+
+    std::optional<SharedFrame> DmaBufClient::Receive(std::chrono::milliseconds timeout) {
+        if (!IsConnected()) return std::nullopt;
+
+        if (pollfd event{*socket_, POLLIN, 0}; poll(&event, 1, static_cast<int>(timeout.count())) <= 0) {
+            return std::nullopt;
+        }
+
+        dmabuf_protocol::FrameMessage message{};
+        ControlBuffer control{};
+        iovec data{&message, sizeof(message)};
+
+        msghdr header{};
+        header.msg_iov = &data;
+        header.msg_iovlen = 1;
+        header.msg_control = control.data;
+        header.msg_controllen = sizeof(control.data);
+
+        auto received = recvmsg(*socket_, &header, MSG_CMSG_CLOEXEC);
+
+        if (received <= 0) {
+            socket_.reset();  // disconnected, outstanding frames keep the socket till their release
+            return std::nullopt;
+        }
+
+        std::vector<MappedPlane> planes;
+
+        for (auto fds = CMSG_FIRSTHDR(&header); fds != nullptr; fds = CMSG_NXTHDR(&header, fds)) {
+            if (fds->cmsg_level != SOL_SOCKET || fds->cmsg_type != SCM_RIGHTS) continue;
+
+            auto count = (fds->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+            for (auto i = size_t{0}; i < count; ++i) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(fds) + i * sizeof(int), sizeof(int));
+                planes.push_back(MappedPlane{MAP_FAILED, 0, fd});
+            }
+        }
+
+        auto isValid = received == sizeof(message) && message.magic == dmabuf_protocol::MAGIC
+                       && !(header.msg_flags & MSG_CTRUNC) && message.fdCount == planes.size()
+                       && message.planeCount > 0 && message.planeCount <= MAX_FRAME_PLANES;
+
+        for (auto i = 0u; isValid && i < message.planeCount; ++i) {
+            auto const &plane = message.planes[i];
+
+            if (plane.memoryPlane >= planes.size()) {
+                isValid = false;
+                break;
+            }
+
+            // memory plane is mapped up to the end of its last image plane
+            auto &memoryPlane = planes[plane.memoryPlane];
+            memoryPlane.length = std::max(memoryPlane.length, size_t{plane.offset} + plane.size);
+        }
+
+        for (auto &plane : planes) {
+            if (!isValid) break;
+
+            if (plane.length == 0) continue;  // memory plane without image planes is not mapped (fd is closed)
+
+            plane.data = mmap(nullptr, plane.length, PROT_READ, MAP_SHARED, plane.fd, 0);
+
+            if (plane.data == MAP_FAILED) {
+                std::cerr << "ERROR: Cannot map shared frame - " << strerror(errno) << '\n';
+                isValid = false;
+            } else {
+                syncPlane(plane.fd, DMA_BUF_SYNC_START);
+            }
+        }
+
+        if (!isValid) {
+            std::cerr << "WARNING: Malformed shared frame is skipped\n";
+            releasePlanes(*socket_, message.frameId, planes);
+            return std::nullopt;
+        }
+
+        auto planeData = [&planes, &message](size_t index) {
+            auto const &plane = message.planes[index];
+            return static_cast<uint8_t *>(planes[plane.memoryPlane].data) + plane.offset;
+        };
+
+        auto lease = std::shared_ptr<void>{planeData(0), [socket = socket_, frameId = message.frameId, planes]
+                (void *) {
+            releasePlanes(*socket, frameId, planes);
+        }};
+
+        SharedFrame shared{Frame{planeData(0), message.planes[0].size, std::move(lease)},
+                           DmaBufFormat{message.width, message.height, message.pixelFormat}};
+
+        for (auto i = size_t{0}; i < message.planeCount; ++i) {
+            shared.frame.setExternalPlane(i, planeData(i), message.planes[i].step, message.planes[i].size);
+        }
+
+        auto info = FrameInfo{};
+        info.timestamp = std::chrono::nanoseconds{message.timestamp};
+        info.sequence = message.sequence;
+        info.flags = message.flags;
+        shared.frame.stamp(info);
+
+        return {std::move(shared)};
+    }
+
+}  // namespace lirs
@@ -0,0 +1,136 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/FramePool.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+namespace lirs {
+
+    template<typename T>
+    struct FramePool::LeaseAllocator final {
+        using value_type = T;
+
+        /* Frames keep the slot alive if they outlive the pool */
+        std::shared_ptr<Slot> slot;
+
+        explicit LeaseAllocator(std::shared_ptr<Slot> slot) : slot{std::move(slot)} {}
+
+        template<typename U>
+        LeaseAllocator(LeaseAllocator<U> const &other) : slot{other.slot} {}
+
+        T *allocate(size_t count) {
+            static_assert(sizeof(T) <= frame_pool_defaults::LEASE_STORAGE_SIZE, "Lease storage is too small");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Lease storage is misaligned");
+
+            if (count != 1) throw std::bad_alloc{};
+
+            return reinterpret_cast<T *>(slot->leaseStorage);
+        }
+
+        // NOTE: Control block is deallocated after the deleter, i.e. the storage is not used anymore.
+        void deallocate(T *, size_t) {
+            slot->isBorrowed.store(false, std::memory_order_release);
+        }
+
+        template<typename U>
+        bool operator==(LeaseAllocator<U> const &other) const {
+            return slot == other.slot;
+        }
+
+        template<typename U>
+        bool operator!=(LeaseAllocator<U> const &other) const {
+            return slot != other.slot;
+        }
+    };
+
+    FramePool::FramePool(size_t bufferSize, size_t capacity, size_t alignment)
+            : bufferSize_{bufferSize}, nextSlot_{0}, acquired_{0}, exhausted_{0} {
+
+        // aligned_alloc requires size to be a multiple of the alignment
+        auto allocationSize = (bufferSize + alignment - 1) / alignment * alignment;
+
+        slots_.reserve(capacity);
+
+        for (auto i = size_t{0}; i < capacity; ++i) {
+            auto data = static_cast<uint8_t *>(std::aligned_alloc(alignment, allocationSize));
+
+            if (data == nullptr) throw std::bad_alloc{};
+
+            slots_.push_back(std::make_shared<Slot>());
+            slots_.back()->data.reset(data);
+        }
+    }
+
+    std::optional<Frame> FramePool::Acquire(uint8_t const *data, size_t size) {
+        auto frame = Acquire(size);
+
+        if (frame) {
+            std::memcpy(frame->data(), data, size);
+        }
+
+        return frame;
+    }
+
+    std::optional<Frame> FramePool::Acquire(size_t size) {
+        if (size > bufferSize_) return std::nullopt;
+
+        // round-robin search starting right after the last acquired buffer
+        for (auto i = size_t{0}; i < slots_.size(); ++i) {
+            auto &slot = slots_[(nextSlot_ + i) % slots_.size()];
+
+            // synchronizes with the release of the frame's last copy (made in any thread)
+            if (auto isBorrowed = false;
+                    slot->isBorrowed.compare_exchange_strong(isBorrowed, true, std::memory_order_acquire,
+                                                             std::memory_order_relaxed)) {
+                nextSlot_ = (nextSlot_ + i + 1) % slots_.size();
+
+                ++acquired_;
+
+                auto lease = std::shared_ptr<void>{slot->data.get(), [](void *) {}, LeaseAllocator<void>{slot}};
+
+                return Frame{slot->data.get(), size, std::move(lease)};
+            }
+        }
+
+        ++exhausted_;
+
+        return std::nullopt;
+    }
+
+    size_t FramePool::available() const {
+        auto count = size_t{0};
+
+        for (auto const &slot : slots_) {
+            if (!slot->isBorrowed.load(std::memory_order_acquire)) ++count;
+        }
+
+        return count;
+    }
+
+}  // namespace lirs
@@ -0,0 +1,128 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/JpegDecodePool.hpp"
+
+#include <algorithm>
+
+namespace lirs {
+
+    JpegDecodePool::JpegDecodePool(size_t threads, DecodedFormat format, int width, int height, Callback callback)
+            : width_{width}, height_{height},
+              step_{static_cast<size_t>(std::max(width, 0) * decoded_channels(format))},
+              callback_{std::move(callback)},
+              busy_{0}, nextTicket_{0}, nextDelivery_{0}, isStopping_{false},
+              dropped_{0}, failed_{0} {
+
+        auto const count = std::max<size_t>(threads, 1);
+
+        workers_.reserve(count);
+
+        for (auto i = size_t{0}; i < count; ++i) {
+            workers_.emplace_back(&JpegDecodePool::run, this, JpegDecoder{format});
+        }
+    }
+
+    JpegDecodePool::~JpegDecodePool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            isStopping_ = true;
+        }
+
+        jobsChanged_.notify_all();
+
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    bool JpegDecodePool::Submit(Frame &&frame) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            if (isStopping_ || jobs_.size() + busy_ >= workers_.size()) {
+                ++dropped_;
+                return false;
+            }
+
+            jobs_.push_back(Job{std::move(frame), nextTicket_++});
+        }
+
+        jobsChanged_.notify_one();
+
+        return true;
+    }
+
+    void JpegDecodePool::run(JpegDecoder decoder) {
+        auto image = std::vector<uint8_t>{};
+
+        while (true) {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            jobsChanged_.wait(lock, [this] { return isStopping_ || !jobs_.empty(); });
+
+            if (jobs_.empty()) return;  // stopping, pending jobs are finished
+
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            ++busy_;
+
+            lock.unlock();
+
+            image.resize(step_ * static_cast<size_t>(std::max(height_, 0)));
+
+            auto const isDecoded = decoder.Decode(job.frame.data(), job.frame.size(),
+                                                  image.data(), step_, width_, height_);
+            auto const info = job.frame.info();
+
+            // release the frame's memory as soon as possible
+            job.frame = Frame{nullptr, 0};
+
+            lock.lock();
+
+            // deliver in the submission order
+            delivered_.wait(lock, [this, &job] { return nextDelivery_ == job.ticket; });
+
+            lock.unlock();
+
+            if (isDecoded) {
+                callback_(info, image);
+            } else {
+                ++failed_;
+            }
+
+            lock.lock();
+
+            ++nextDelivery_;
+            --busy_;
+
+            lock.unlock();
+
+            delivered_.notify_all();
+        }
+    }
+
+}  // namespace lirs
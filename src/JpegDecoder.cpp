@@ -0,0 +1,133 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/JpegDecoder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+
+namespace lirs {
+
+    namespace {
+        constexpr auto MAX_SCANLINES_PER_READ = 16;  // enough for any sampling factors (rec_outbuf_height <= 4)
+
+        J_COLOR_SPACE to_color_space(DecodedFormat format) {
+            switch (format) {
+                case DecodedFormat::RGB8:
+                    return JCS_EXT_RGB;
+                case DecodedFormat::BGR8:
+                    return JCS_EXT_BGR;
+                case DecodedFormat::MONO8:
+                default:
+                    return JCS_GRAYSCALE;
+            }
+        }
+    }
+
+    /* libjpeg reports fatal errors by the error_exit callback which must not return (longjmp) */
+    struct JpegDecoder::Decompressor final {
+        jpeg_decompress_struct info{};
+
+        jpeg_error_mgr errorManager{};
+
+        std::jmp_buf jumpBuffer{};
+
+        Decompressor() {
+            info.err = jpeg_std_error(&errorManager);
+            errorManager.error_exit = [](j_common_ptr common) {
+                std::longjmp(static_cast<Decompressor *>(common->client_data)->jumpBuffer, 1);
+            };
+            // corrupted MJPEG frames are common, warnings are not printed
+            errorManager.output_message = [](j_common_ptr) {};
+
+            jpeg_create_decompress(&info);
+            info.client_data = this;
+        }
+
+        ~Decompressor() {
+            jpeg_destroy_decompress(&info);
+        }
+
+        Decompressor(Decompressor const &) = delete;
+
+        Decompressor &operator=(Decompressor const &) = delete;
+    };
+
+    JpegDecoder::JpegDecoder(DecodedFormat format)
+            : format_{format}, decompressor_{std::make_unique<Decompressor>()} {}
+
+    JpegDecoder::~JpegDecoder() = default;
+
+    JpegDecoder::JpegDecoder(JpegDecoder &&) noexcept = default;
+
+    JpegDecoder &JpegDecoder::operator=(JpegDecoder &&) noexcept = default;
+
+    bool JpegDecoder::Decode(uint8_t const *jpeg, size_t size, uint8_t *dst, size_t dstStep, int width, int height) {
+        if (jpeg == nullptr || size == 0 || dst == nullptr || width <= 0 || height <= 0) return false;
+
+        auto &info = decompressor_->info;
+
+        if (setjmp(decompressor_->jumpBuffer) != 0) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+
+        jpeg_mem_src(&info, const_cast<uint8_t *>(jpeg), static_cast<unsigned long>(size));
+
+        if (jpeg_read_header(&info, TRUE) != JPEG_HEADER_OK) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+
+        if (static_cast<int>(info.image_width) != width || static_cast<int>(info.image_height) != height) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+
+        info.out_color_space = to_color_space(format_);
+
+        jpeg_start_decompress(&info);
+
+        JSAMPROW rows[MAX_SCANLINES_PER_READ];
+
+        while (info.output_scanline < info.output_height) {
+            auto const count = std::min<JDIMENSION>(info.output_height - info.output_scanline, MAX_SCANLINES_PER_READ);
+
+            for (auto i = JDIMENSION{0}; i < count; ++i) {
+                rows[i] = dst + (info.output_scanline + i) * dstStep;
+            }
+
+            jpeg_read_scanlines(&info, rows, count);
+        }
+
+        jpeg_finish_decompress(&info);
+
+        return true;
+    }
+
+}  // namespace lirs
@@ -0,0 +1,417 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/JpegEncoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+
+namespace lirs {
+
+    namespace {
+        constexpr auto MAX_RESTART_INTERVAL = 65535u;  // DRI marker field (MCUs)
+        constexpr auto MCU_HEIGHT = DCTSIZE;           // 4:2:2 and grayscale are not subsampled vertically
+        constexpr auto INITIAL_OUTPUT_SIZE = size_t{64 * 1024};
+
+        constexpr auto MARKER_SOF0 = uint8_t{0xC0};
+        constexpr auto MARKER_RST0 = uint8_t{0xD0};
+        constexpr auto MARKER_EOI = uint8_t{0xD9};
+        constexpr auto MARKER_SOS = uint8_t{0xDA};
+
+        // Maps limited range luma ([16, 235]) or chroma ([16, 240]) values onto the full range
+        std::array<uint8_t, 256> range_lut(ColorRange range, bool isChroma) {
+            std::array<uint8_t, 256> lut{};
+
+            for (auto value = 0; value < 256; ++value) {
+                auto mapped = static_cast<long>(value);
+
+                if (range == ColorRange::LIMITED) {
+                    mapped = isChroma ? std::lround((value - 128) * 255.0 / 224.0 + 128.0)
+                                      : std::lround((value - 16) * 255.0 / 219.0);
+                }
+
+                lut[value] = static_cast<uint8_t>(std::clamp(mapped, 0l, 255l));
+            }
+
+            return lut;
+        }
+
+        /**
+         * @brief Location of the entropy-coded data in a single scan baseline JPEG.
+         */
+        struct Scan final {
+            size_t begin = 0;       // right after the SOS segment
+            size_t end = 0;         // EOI marker
+            size_t heightAt = 0;    // frame height field of the SOF0 segment
+        };
+
+        bool find_scan(std::vector<uint8_t> const &jpeg, Scan &scan) {
+            auto const size = jpeg.size();
+
+            if (size < 4 || jpeg[size - 2] != 0xFF || jpeg[size - 1] != MARKER_EOI) return false;
+
+            // segments following the SOI marker
+            for (auto pos = size_t{2}; pos + 4 <= size;) {
+                if (jpeg[pos] != 0xFF) return false;
+
+                auto const marker = jpeg[pos + 1];
+                auto const length = size_t{jpeg[pos + 2]} << 8u | jpeg[pos + 3];
+
+                if (marker == MARKER_SOF0) scan.heightAt = pos + 5;
+
+                if (marker == MARKER_SOS) {
+                    scan.begin = pos + 2 + length;
+                    scan.end = size - 2;
+                    return scan.heightAt != 0 && scan.begin <= scan.end;
+                }
+
+                pos += 2 + length;
+            }
+
+            return false;
+        }
+    }
+
+    /* libjpeg reports fatal errors by the error_exit callback which must not return (longjmp) */
+    struct JpegEncoder::Compressor final {
+        jpeg_compress_struct info{};
+
+        jpeg_error_mgr errorManager{};
+
+        jpeg_destination_mgr destination{};
+
+        std::jmp_buf jumpBuffer{};
+
+        /* Encoded data, capacity is reused */
+        std::vector<uint8_t> *output = nullptr;
+
+        /* Planar MCU row: Y, Cb and Cr lines (padded to the MCU width) */
+        std::array<std::vector<uint8_t>, 3> planes;
+        std::array<std::array<JSAMPROW, MCU_HEIGHT>, 3> rows{};
+
+        Compressor() {
+            info.err = jpeg_std_error(&errorManager);
+            errorManager.error_exit = [](j_common_ptr common) {
+                std::longjmp(static_cast<Compressor *>(common->client_data)->jumpBuffer, 1);
+            };
+
+            jpeg_create_compress(&info);
+            info.client_data = this;
+
+            destination.init_destination = [](j_compress_ptr compress) {
+                auto &self = *static_cast<Compressor *>(compress->client_data);
+                self.output->resize(std::max(self.output->capacity(), INITIAL_OUTPUT_SIZE));
+                self.destination.next_output_byte = self.output->data();
+                self.destination.free_in_buffer = self.output->size();
+            };
+            destination.empty_output_buffer = [](j_compress_ptr compress) -> boolean {
+                auto &self = *static_cast<Compressor *>(compress->client_data);
+                auto const used = self.output->size();
+                self.output->resize(used * 2);
+                self.destination.next_output_byte = self.output->data() + used;
+                self.destination.free_in_buffer = self.output->size() - used;
+                return TRUE;
+            };
+            destination.term_destination = [](j_compress_ptr compress) {
+                auto &self = *static_cast<Compressor *>(compress->client_data);
+                self.output->resize(self.output->size() - self.destination.free_in_buffer);
+            };
+
+            info.dest = &destination;
+        }
+
+        ~Compressor() {
+            jpeg_destroy_compress(&info);
+        }
+
+        Compressor(Compressor const &) = delete;
+
+        Compressor &operator=(Compressor const &) = delete;
+    };
+
+    JpegEncoder::JpegEncoder(size_t threads, JpegEncoding encoding)
+            : encoding_{encoding},
+              lumaLut_{range_lut(encoding.range, false)},
+              chromaLut_{range_lut(encoding.range, true)},
+              src_{nullptr}, srcStep_{0}, width_{0}, restartInterval_{0}, nextStripe_{0},
+              job_{0}, doneStripes_{0}, isStopping_{false} {
+
+        auto const count = std::max<size_t>(threads, 1);
+
+        for (auto i = size_t{0}; i < count; ++i) {
+            compressors_.push_back(std::make_unique<Compressor>());
+        }
+
+        // the calling thread encodes as well
+        for (auto i = size_t{1}; i < count; ++i) {
+            workers_.emplace_back(&JpegEncoder::run, this, i);
+        }
+    }
+
+    JpegEncoder::~JpegEncoder() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            isStopping_ = true;
+        }
+
+        jobStarted_.notify_all();
+
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    bool JpegEncoder::Encode(uint8_t const *src, size_t srcStep, int width, int height, std::vector<uint8_t> &jpeg) {
+        if (src == nullptr || width <= 0 || height <= 0 || width % 2 != 0) return false;
+
+        auto const mcuWidth = encoding_.isGray ? DCTSIZE : 2 * DCTSIZE;
+        auto const mcusPerRow = static_cast<unsigned>((width + mcuWidth - 1) / mcuWidth);
+        auto const mcuRows = static_cast<unsigned>((height + MCU_HEIGHT - 1) / MCU_HEIGHT);
+
+        // a stripe per thread, the restart interval (MCUs per stripe) is limited
+        auto stripeMcuRows = static_cast<unsigned>((mcuRows + threads() - 1) / threads());
+        stripeMcuRows = std::clamp(stripeMcuRows, 1u, std::max(MAX_RESTART_INTERVAL / mcusPerRow, 1u));
+
+        auto const stripeCount = (mcuRows + stripeMcuRows - 1) / stripeMcuRows;
+        auto const stripeHeight = static_cast<int>(stripeMcuRows * MCU_HEIGHT);
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            stripes_.resize(stripeCount);
+
+            for (auto i = 0u; i < stripeCount; ++i) {
+                stripes_[i].firstRow = static_cast<int>(i) * stripeHeight;
+                stripes_[i].rows = std::min(stripeHeight, height - stripes_[i].firstRow);
+                stripes_[i].isEncoded = false;
+            }
+
+            src_ = src;
+            srcStep_ = srcStep;
+            width_ = width;
+            restartInterval_ = stripeCount > 1 ? stripeMcuRows * mcusPerRow : 0;
+        }
+
+        // single stripe is encoded right into the destination
+        if (stripeCount == 1) {
+            jpeg.swap(stripes_[0].jpeg);
+            auto isEncoded = encodeStripe(*compressors_[0], stripes_[0]);
+            jpeg.swap(stripes_[0].jpeg);
+
+            return isEncoded;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            nextStripe_ = 0;
+            doneStripes_ = 0;
+            ++job_;
+        }
+
+        jobStarted_.notify_all();
+
+        encodeStripes(*compressors_[0]);
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            stripesDone_.wait(lock, [this] { return doneStripes_ == stripes_.size(); });
+        }
+
+        return join(jpeg, height);
+    }
+
+    void JpegEncoder::encodeStripes(Compressor &compressor) {
+        while (true) {
+            Stripe *stripe;
+
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+
+                if (nextStripe_ >= stripes_.size()) return;
+
+                stripe = &stripes_[nextStripe_++];
+            }
+
+            stripe->isEncoded = encodeStripe(compressor, *stripe);
+
+            auto isLast = false;
+
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                isLast = ++doneStripes_ == stripes_.size();
+            }
+
+            if (isLast) stripesDone_.notify_one();
+        }
+    }
+
+    bool JpegEncoder::encodeStripe(Compressor &compressor, Stripe &stripe) {
+        auto &info = compressor.info;
+        auto const componentCount = encoding_.isGray ? 1 : 3;
+
+        compressor.output = &stripe.jpeg;
+
+        if (setjmp(compressor.jumpBuffer) != 0) {
+            jpeg_abort_compress(&info);
+            return false;
+        }
+
+        info.image_width = static_cast<JDIMENSION>(width_);
+        info.image_height = static_cast<JDIMENSION>(stripe.rows);
+        info.input_components = componentCount;
+        info.in_color_space = encoding_.isGray ? JCS_GRAYSCALE : JCS_YCbCr;
+
+        jpeg_set_defaults(&info);
+        jpeg_set_quality(&info, std::clamp(encoding_.quality, 1, 100), TRUE);
+
+        // YUV 4:2:2 planes are passed as is (no color conversion and downsampling)
+        info.raw_data_in = TRUE;
+        info.comp_info[0].h_samp_factor = encoding_.isGray ? 1 : 2;
+        info.comp_info[0].v_samp_factor = 1;
+
+        for (auto c = 1; c < componentCount; ++c) {
+            info.comp_info[c].h_samp_factor = 1;
+            info.comp_info[c].v_samp_factor = 1;
+        }
+
+        info.restart_interval = restartInterval_;
+
+        // lines are padded to the MCU width by the last pixel
+        auto const lumaWidth = encoding_.isGray ? (width_ + DCTSIZE - 1) / DCTSIZE * DCTSIZE
+                                                : (width_ + 2 * DCTSIZE - 1) / (2 * DCTSIZE) * (2 * DCTSIZE);
+        auto const chromaWidth = lumaWidth / 2;
+
+        for (auto c = 0; c < componentCount; ++c) {
+            auto const planeWidth = c == 0 ? lumaWidth : chromaWidth;
+
+            compressor.planes[c].resize(static_cast<size_t>(planeWidth) * MCU_HEIGHT);
+
+            for (auto line = 0; line < MCU_HEIGHT; ++line) {
+                compressor.rows[c][line] = compressor.planes[c].data() + line * planeWidth;
+            }
+        }
+
+        JSAMPARRAY planes[3] = {compressor.rows[0].data(), compressor.rows[1].data(), compressor.rows[2].data()};
+
+        auto const isYuyv = encoding_.layout == YuvLayout::YUYV;
+        auto const lumaOffset = isYuyv ? 0 : 1;
+        auto const uOffset = isYuyv ? 1 : 0;
+        auto const vOffset = isYuyv ? 3 : 2;
+
+        jpeg_start_compress(&info, TRUE);
+
+        for (auto row = 0; row < stripe.rows; row += MCU_HEIGHT) {
+            for (auto line = 0; line < MCU_HEIGHT; ++line) {
+                // rows below the image are padded by the last one
+                auto const srcRow = stripe.firstRow + std::min(row + line, stripe.rows - 1);
+                auto const src = src_ + static_cast<size_t>(srcRow) * srcStep_;
+
+                auto luma = compressor.rows[0][line];
+
+                if (encoding_.isGray) {
+                    for (auto x = 0; x < width_; ++x) {
+                        luma[x] = lumaLut_[src[2 * x + lumaOffset]];
+                    }
+                } else {
+                    auto u = compressor.rows[1][line];
+                    auto v = compressor.rows[2][line];
+
+                    for (auto x = 0; x < width_ / 2; ++x) {
+                        luma[2 * x] = lumaLut_[src[4 * x + lumaOffset]];
+                        luma[2 * x + 1] = lumaLut_[src[4 * x + lumaOffset + 2]];
+                        u[x] = chromaLut_[src[4 * x + uOffset]];
+                        v[x] = chromaLut_[src[4 * x + vOffset]];
+                    }
+
+                    std::fill(u + width_ / 2, u + chromaWidth, u[width_ / 2 - 1]);
+                    std::fill(v + width_ / 2, v + chromaWidth, v[width_ / 2 - 1]);
+                }
+
+                std::fill(luma + width_, luma + lumaWidth, luma[width_ - 1]);
+            }
+
+            jpeg_write_raw_data(&info, planes, MCU_HEIGHT);
+        }
+
+        jpeg_finish_compress(&info);
+
+        return true;
+    }
+
+    void JpegEncoder::run(size_t compressorIndex) {
+        auto lastJob = uint64_t{0};
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+
+                jobStarted_.wait(lock, [this, lastJob] { return isStopping_ || job_ != lastJob; });
+
+                if (isStopping_) return;
+
+                lastJob = job_;
+            }
+
+            encodeStripes(*compressors_[compressorIndex]);
+        }
+    }
+
+    bool JpegEncoder::join(std::vector<uint8_t> &jpeg, int height) const {
+        Scan first{};
+
+        for (auto const &stripe : stripes_) {
+            if (!stripe.isEncoded) return false;
+        }
+
+        if (!find_scan(stripes_[0].jpeg, first)) return false;
+
+        // headers of the first stripe (with the restart interval) describe the whole image
+        jpeg.assign(stripes_[0].jpeg.begin(), stripes_[0].jpeg.begin() + first.end);
+        jpeg[first.heightAt] = static_cast<uint8_t>(height >> 8);
+        jpeg[first.heightAt + 1] = static_cast<uint8_t>(height & 0xFF);
+
+        // stripes are restart intervals: entropy coding is byte-aligned and DC prediction is reset
+        for (auto i = size_t{1}; i < stripes_.size(); ++i) {
+            Scan scan{};
+
+            if (!find_scan(stripes_[i].jpeg, scan)) return false;
+
+            jpeg.push_back(0xFF);
+            jpeg.push_back(static_cast<uint8_t>(MARKER_RST0 + (i - 1) % 8));
+            jpeg.insert(jpeg.end(), stripes_[i].jpeg.begin() + scan.begin, stripes_[i].jpeg.begin() + scan.end);
+        }
+
+        jpeg.push_back(0xFF);
+        jpeg.push_back(MARKER_EOI);
+
+        return true;
+    }
+
+}  // namespace lirs
@@ -0,0 +1,240 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/MemoryCopy.hpp"
+
+#include <initializer_list>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LIRS_MEMORY_COPY_X86
+
+#include <immintrin.h>
+
+#endif
+
+namespace lirs {
+
+    namespace {
+
+        using CopyFunction = void (*)(uint8_t const *src, uint8_t *dst, size_t size);
+
+        constexpr auto CACHE_LINE_SIZE = size_t{64};
+
+        /* Smaller copies are not worth the alignment and the store fence */
+        constexpr auto MIN_STREAMING_SIZE = size_t{256};
+
+        void copy_generic(uint8_t const *src, uint8_t *dst, size_t size) {
+            std::memcpy(dst, src, size);
+        }
+
+        /* Number of bytes until the aligned address */
+        size_t bytes_to_alignment(void const *ptr, size_t alignment) {
+            return (alignment - reinterpret_cast<uintptr_t>(ptr) % alignment) % alignment;
+        }
+
+#ifdef LIRS_MEMORY_COPY_X86
+
+        /* Copies whole cache lines, source is aligned (non-temporal stores require the aligned destination too) */
+        template<bool IsDstAligned>
+        __attribute__((target("sse4.1")))
+        void copy_lines_sse41(uint8_t const *src, uint8_t *dst, size_t lines) {
+            for (auto line = size_t{0}; line < lines; ++line) {
+                auto in = reinterpret_cast<__m128i *>(const_cast<uint8_t *>(src));
+                auto out = reinterpret_cast<__m128i *>(dst);
+
+                // the whole line is loaded at once, i.e. from a single streaming load buffer
+                auto x0 = _mm_stream_load_si128(in);
+                auto x1 = _mm_stream_load_si128(in + 1);
+                auto x2 = _mm_stream_load_si128(in + 2);
+                auto x3 = _mm_stream_load_si128(in + 3);
+
+                if (IsDstAligned) {
+                    _mm_stream_si128(out, x0);
+                    _mm_stream_si128(out + 1, x1);
+                    _mm_stream_si128(out + 2, x2);
+                    _mm_stream_si128(out + 3, x3);
+                } else {
+                    _mm_storeu_si128(out, x0);
+                    _mm_storeu_si128(out + 1, x1);
+                    _mm_storeu_si128(out + 2, x2);
+                    _mm_storeu_si128(out + 3, x3);
+                }
+
+                src += CACHE_LINE_SIZE;
+                dst += CACHE_LINE_SIZE;
+            }
+        }
+
+        __attribute__((target("sse4.1")))
+        void copy_streaming_sse41(uint8_t const *src, uint8_t *dst, size_t size) {
+            if (size < MIN_STREAMING_SIZE) return copy_generic(src, dst, size);
+
+            auto head = bytes_to_alignment(src, sizeof(__m128i));
+            std::memcpy(dst, src, head);
+
+            src += head;
+            dst += head;
+            size -= head;
+
+            auto lines = size / CACHE_LINE_SIZE;
+
+            if (bytes_to_alignment(dst, sizeof(__m128i)) == 0) {
+                copy_lines_sse41<true>(src, dst, lines);
+            } else {
+                copy_lines_sse41<false>(src, dst, lines);
+            }
+
+            _mm_sfence();  // non-temporal stores are weakly ordered
+
+            auto copied = lines * CACHE_LINE_SIZE;
+            std::memcpy(dst + copied, src + copied, size - copied);
+        }
+
+        template<bool IsDstAligned>
+        __attribute__((target("avx2")))
+        void copy_lines_avx2(uint8_t const *src, uint8_t *dst, size_t lines) {
+            for (auto line = size_t{0}; line < lines; ++line) {
+                auto in = reinterpret_cast<__m256i const *>(src);
+                auto out = reinterpret_cast<__m256i *>(dst);
+
+                auto y0 = _mm256_stream_load_si256(in);
+                auto y1 = _mm256_stream_load_si256(in + 1);
+
+                if (IsDstAligned) {
+                    _mm256_stream_si256(out, y0);
+                    _mm256_stream_si256(out + 1, y1);
+                } else {
+                    _mm256_storeu_si256(out, y0);
+                    _mm256_storeu_si256(out + 1, y1);
+                }
+
+                src += CACHE_LINE_SIZE;
+                dst += CACHE_LINE_SIZE;
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void copy_streaming_avx2(uint8_t const *src, uint8_t *dst, size_t size) {
+            if (size < MIN_STREAMING_SIZE) return copy_generic(src, dst, size);
+
+            auto const distance = reinterpret_cast<uintptr_t>(src) - reinterpret_cast<uintptr_t>(dst);
+
+            // 16-byte aligned destination (e.g. heap allocation) still allows the non-temporal stores
+            if (distance % sizeof(__m256i) != 0 && distance % sizeof(__m128i) == 0) {
+                return copy_streaming_sse41(src, dst, size);
+            }
+
+            auto head = bytes_to_alignment(src, sizeof(__m256i));
+            std::memcpy(dst, src, head);
+
+            src += head;
+            dst += head;
+            size -= head;
+
+            auto lines = size / CACHE_LINE_SIZE;
+
+            if (bytes_to_alignment(dst, sizeof(__m256i)) == 0) {
+                copy_lines_avx2<true>(src, dst, lines);
+            } else {
+                copy_lines_avx2<false>(src, dst, lines);
+            }
+
+            _mm_sfence();
+
+            auto copied = lines * CACHE_LINE_SIZE;
+            std::memcpy(dst + copied, src + copied, size - copied);
+        }
+
+#endif
+
+        bool is_supported(CopyKernel kernel) {
+            switch (kernel) {
+                case CopyKernel::GENERIC:
+                    return true;
+#ifdef LIRS_MEMORY_COPY_X86
+                case CopyKernel::STREAMING_SSE41:
+                    return __builtin_cpu_supports("sse4.1");
+                case CopyKernel::STREAMING_AVX2:
+                    return __builtin_cpu_supports("avx2");
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        CopyFunction copy_function(CopyKernel kernel) {
+            switch (kernel) {
+#ifdef LIRS_MEMORY_COPY_X86
+                case CopyKernel::STREAMING_SSE41:
+                    return copy_streaming_sse41;
+                case CopyKernel::STREAMING_AVX2:
+                    return copy_streaming_avx2;
+#endif
+                default:
+                    return copy_generic;
+            }
+        }
+
+    }  // namespace
+
+    CopyKernel MemoryCopy::copy_kernel() {
+        static auto const kernel = [] {
+            for (auto kernel : {CopyKernel::STREAMING_AVX2, CopyKernel::STREAMING_SSE41}) {
+                if (is_supported(kernel)) return kernel;
+            }
+            return CopyKernel::GENERIC;
+        }();
+
+        return kernel;
+    }
+
+    char const *MemoryCopy::copy_kernel_name(CopyKernel kernel) {
+        switch (kernel) {
+            case CopyKernel::STREAMING_SSE41:
+                return "streaming SSE4.1";
+            case CopyKernel::STREAMING_AVX2:
+                return "streaming AVX2";
+            default:
+                return "generic";
+        }
+    }
+
+    void MemoryCopy::from_device(uint8_t const *src, uint8_t *dst, size_t size) {
+        static auto const copy = copy_function(copy_kernel());
+
+        copy(src, dst, size);
+    }
+
+    bool MemoryCopy::from_device(CopyKernel kernel, uint8_t const *src, uint8_t *dst, size_t size) {
+        if (!is_supported(kernel)) return false;
+
+        copy_function(kernel)(src, dst, size);
+
+        return true;
+    }
+
+}  // namespace lirs
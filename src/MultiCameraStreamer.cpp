@@ -0,0 +1,130 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "lirs_ros_video_streaming/CameraStreamer.hpp"
+#include "lirs_ros_video_streaming/CaptureReactor.hpp"
+#include "lirs_ros_video_streaming/PixelConversion.hpp"
+
+namespace lirs {
+    namespace ros_utils {
+
+        /* node shutdown is checked between the polls */
+        constexpr auto REACTOR_POLL_TIMEOUT = std::chrono::milliseconds{100};
+
+    }  // namespace ros_utils
+}  // namespace lirs
+
+/*
+ * Serves many cameras in one process: cameras are listed in the ~cameras parameter, each camera is configured
+ * by the video_streamer parameters in the ~<camera> namespace and published in the <camera> namespace
+ * (image_raw, camera_info, etc.). All of the devices are captured on a single thread by the capture reactor.
+ */
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "lirs_ros_multi_camera_streaming");
+
+    ros::NodeHandle nodeHandle;
+    ros::NodeHandle nodeHandle_{"~"};
+
+    std::vector<std::string> cameraNames;
+
+    if (!nodeHandle_.getParam("cameras", cameraNames) || cameraNames.empty()) {
+        ROS_ERROR_STREAM("No cameras are listed in the ~cameras parameter");
+        return -1;
+    }
+
+    // streamers outlive the reactor referencing their captures
+    std::vector<std::unique_ptr<lirs::CameraStreamer>> streamers;
+
+    lirs::CaptureReactor reactor;
+
+    if (!reactor.IsOpened()) {
+        ROS_ERROR_STREAM("Couldn't create the capture reactor");
+        return -1;
+    }
+
+    for (auto const &cameraName : cameraNames) {
+        auto paramHandle = ros::NodeHandle{nodeHandle_, cameraName};
+
+        // shared buffers are dequeued by the streamer itself, i.e. not by the reactor
+        if (std::string dmabufSocket; paramHandle.getParam("dmabuf_socket", dmabufSocket) && !dmabufSocket.empty()) {
+            ROS_ERROR_STREAM("Buffers sharing is not supported by the multi-camera host (camera " << cameraName << ")");
+            return -1;
+        }
+
+        // captures are registered with the reactor for good, i.e. streaming is never paused
+        if (bool isLazy; paramHandle.getParam("lazy_streaming", isLazy) && isLazy) {
+            ROS_ERROR_STREAM("Lazy streaming is not supported by the multi-camera host (camera " << cameraName << ")");
+            return -1;
+        }
+
+        // topics are named as by the video_streamer nodes of the launch files
+        auto topicHandle = ros::NodeHandle{nodeHandle, cameraName, ros::M_string{{"image", "image_raw"}}};
+
+        auto streamer = std::make_unique<lirs::CameraStreamer>(topicHandle, paramHandle);
+
+        if (!streamer->IsStreaming()) {
+            ROS_ERROR_STREAM("Couldn't start camera: " << cameraName);
+            return -1;
+        }
+
+        // frames of the cameras without subscribers are released right away
+        reactor.Add(streamer->capture(), [camera = streamer.get()](lirs::Frame &&frame) {
+            if (camera->UpdateSubscribers()) {
+                camera->Publish(std::move(frame));
+            }
+        });
+
+        streamers.push_back(std::move(streamer));
+    }
+
+    // ROS callbacks are served in the background, thus publishing is driven by the frame arrival only
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    ROS_INFO_STREAM("Serving " << streamers.size() << " cameras, pixel conversion: "
+                               << lirs::PixelConversion::simd_level_name(lirs::PixelConversion::simd_level()));
+
+    auto cameraCount = reactor.captureCount();
+
+    while (nodeHandle.ok()) {
+        reactor.Poll(lirs::ros_utils::REACTOR_POLL_TIMEOUT);
+
+        // cameras are removed on the device errors (e.g. disconnection), the rest are still served
+        if (reactor.captureCount() < cameraCount) {
+            cameraCount = reactor.captureCount();
+            ROS_ERROR_STREAM("Camera is lost, " << cameraCount << " of " << streamers.size() << " cameras left");
+        }
+    }
+
+    spinner.stop();
+}
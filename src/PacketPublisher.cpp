@@ -0,0 +1,68 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#include "lirs_ros_video_streaming/PacketPublisher.hpp"
+
+#include <linux/videodev2.h>
+
+namespace lirs {
+
+    PacketPublisher::PacketPublisher(ros::NodeHandle &nodeHandle, std::string const &frameId, VideoCodec codec,
+                                     uint32_t width, uint32_t height, ros_utils::SubscriberCallbacks const &callbacks)
+            : codec_{codec}, isAwaitingKeyframe_{true}, hasSubscribers_{false} {
+
+        publisher_ = nodeHandle.advertise<lirs_ros_video_streaming::Packet>("packets", 10, callbacks.onConnect,
+                                                                            callbacks.onDisconnect);
+
+        packetMsg_ = boost::make_shared<lirs_ros_video_streaming::Packet>();
+        packetMsg_->header.frame_id = frameId;
+        packetMsg_->codec = lirs::VideoBitstream::codec_name(codec);
+        packetMsg_->width = width;
+        packetMsg_->height = height;
+    }
+
+    bool PacketPublisher::UpdateSubscribers() {
+        hasSubscribers_ = publisher_.getNumSubscribers() > 0;
+        return hasSubscribers_;
+    }
+
+    bool PacketPublisher::Publish(Frame const &frame) {
+        // not all the drivers flag keyframes, thus the bitstream is inspected as well
+        packetMsg_->keyframe = (frame.flags() & V4L2_BUF_FLAG_KEYFRAME) != 0
+                               || lirs::VideoBitstream::is_keyframe(codec_, frame.data(), frame.size());
+
+        isAwaitingKeyframe_ = isAwaitingKeyframe_ && !packetMsg_->keyframe;
+
+        if (isAwaitingKeyframe_) return false;
+
+        packetMsg_->header.stamp = ros_utils::rosTimeFrom(frame.timestamp());
+        packetMsg_->sequence = frame.sequence();
+        packetMsg_->data.assign(frame.data(), frame.data() + frame.size());
+        publisher_.publish(*packetMsg_);
+
+        return true;
+    }
+
+}  // namespace lirs
@@ -0,0 +1,1282 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/PixelConversion.hpp"
+
+#include <initializer_list>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LIRS_PIXEL_CONVERSION_X86
+
+#include <immintrin.h>
+
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define LIRS_PIXEL_CONVERSION_NEON
+
+#include <arm_neon.h>
+
+#endif
+
+namespace lirs {
+
+    namespace {
+
+        /* Converts a single line, returns number of processed pixels */
+        using LineKernel = size_t (*)(uint8_t const *src, uint8_t *dst, size_t width);
+
+        size_t yuyv_to_mono8_line_scalar(uint8_t const *src, uint8_t *dst, size_t width) {
+            for (auto x = size_t{0}; x < width; ++x) {
+                dst[x] = src[2 * x];
+            }
+            return width;
+        }
+
+        size_t yuyv_to_uyvy_line_scalar(uint8_t const *src, uint8_t *dst, size_t width) {
+            for (auto x = size_t{0}; x < width; ++x) {
+                dst[2 * x] = src[2 * x + 1];
+                dst[2 * x + 1] = src[2 * x];
+            }
+            return width;
+        }
+
+        /* Fixed-point YCbCr to RGB coefficients (see compute_rgb_coefficients()) */
+        struct RgbCoefficients final {
+            uint16_t yOffset;
+            uint16_t yScale;  // 14 fractional bits (unsigned)
+            int16_t rv;       // 6 fractional bits
+            int16_t gu;
+            int16_t gv;
+            int16_t bu;
+        };
+
+        constexpr auto RGB_FRACTION_BITS = 6;
+        constexpr auto RGB_ROUNDING = 1 << (RGB_FRACTION_BITS - 1);
+        constexpr auto CHROMA_OFFSET = 128;
+
+        RgbCoefficients compute_rgb_coefficients(YuvToRgb const &conversion) {
+            auto kr = conversion.matrix == ColorMatrix::BT709 ? 0.2126 : 0.299;
+            auto kb = conversion.matrix == ColorMatrix::BT709 ? 0.0722 : 0.114;
+            auto kg = 1.0 - kr - kb;
+
+            auto isLimited = conversion.range == ColorRange::LIMITED;
+            auto yScale = isLimited ? 255.0 / 219.0 : 1.0;
+            auto cScale = isLimited ? 255.0 / 224.0 : 1.0;
+
+            auto fixed = [](double value) {
+                return static_cast<int16_t>(std::lround(value * (1 << RGB_FRACTION_BITS)));
+            };
+
+            return RgbCoefficients{
+                    static_cast<uint16_t>(isLimited ? 16 : 0),
+                    static_cast<uint16_t>(std::lround(yScale * (1 << 14))),
+                    fixed(2.0 * (1.0 - kr) * cScale),
+                    fixed(2.0 * (1.0 - kb) * kb / kg * cScale),
+                    fixed(2.0 * (1.0 - kr) * kr / kg * cScale),
+                    fixed(2.0 * (1.0 - kb) * cScale)
+            };
+        }
+
+        /* Byte offsets of the components within the YUV 4:2:2 pixel pair */
+        struct YuvOffsets final {
+            size_t y0, u, y1, v;
+        };
+
+        constexpr YuvOffsets yuv_offsets(YuvLayout layout) {
+            return layout == YuvLayout::YUYV ? YuvOffsets{0, 1, 2, 3} : YuvOffsets{1, 0, 3, 2};
+        }
+
+        inline int saturate_int16(int value) {
+            return std::clamp(value, INT16_MIN, INT16_MAX);
+        }
+
+        // Mirrors SIMD kernels' 16-bit saturating arithmetic in order to produce identical results
+        inline void yuv_to_rgb_pixel(RgbCoefficients const &c, int y, int u, int v,
+                                     uint8_t *rgb, size_t rIndex, size_t bIndex) {
+            auto luma = static_cast<int>((static_cast<uint32_t>(std::max(y - c.yOffset, 0) << 8) * c.yScale) >> 16)
+                        + RGB_ROUNDING;
+            u -= CHROMA_OFFSET;
+            v -= CHROMA_OFFSET;
+
+            auto r = saturate_int16(luma + v * c.rv);
+            auto g = saturate_int16(saturate_int16(luma - u * c.gu) - v * c.gv);
+            auto b = saturate_int16(luma + u * c.bu);
+
+            rgb[rIndex] = static_cast<uint8_t>(std::clamp(r >> RGB_FRACTION_BITS, 0, 255));
+            rgb[1] = static_cast<uint8_t>(std::clamp(g >> RGB_FRACTION_BITS, 0, 255));
+            rgb[bIndex] = static_cast<uint8_t>(std::clamp(b >> RGB_FRACTION_BITS, 0, 255));
+        }
+
+        /* Converts a single line starting from the given pixel (even), returns number of processed pixels */
+        using RgbLineKernel = size_t (*)(RgbCoefficients const &c, YuvLayout layout, uint8_t const *src,
+                                         uint8_t *dst, size_t width, size_t rIndex, size_t bIndex);
+
+        size_t yuv422_to_rgb_line_scalar(RgbCoefficients const &c, YuvLayout layout, uint8_t const *src,
+                                         uint8_t *dst, size_t width, size_t rIndex, size_t bIndex) {
+            auto offsets = yuv_offsets(layout);
+
+            for (auto x = size_t{0}; x + 2 <= width; x += 2, src += 4, dst += 6) {
+                yuv_to_rgb_pixel(c, src[offsets.y0], src[offsets.u], src[offsets.v], dst, rIndex, bIndex);
+                yuv_to_rgb_pixel(c, src[offsets.y1], src[offsets.u], src[offsets.v], dst + 3, rIndex, bIndex);
+            }
+            return width;
+        }
+
+        // Interleaves converted planes into the packed RGB line
+        inline void interleave_rgb(uint8_t const *r, uint8_t const *g, uint8_t const *b, size_t count,
+                                   uint8_t *dst, size_t rIndex, size_t bIndex) {
+            for (auto i = size_t{0}; i < count; ++i, dst += 3) {
+                dst[rIndex] = r[i];
+                dst[1] = g[i];
+                dst[bIndex] = b[i];
+            }
+        }
+
+        /* Demosaicing output */
+        enum class BayerTarget : uint8_t {
+            RGB,
+            BGR,
+            MONO8
+        };
+
+        /* Bayer line with its neighbours (borders are reflected) */
+        struct BayerLine final {
+            uint8_t const *above;
+            uint8_t const *current;
+            uint8_t const *below;
+            bool greenFirst;  // green at even pixels
+            bool redLine;     // red (otherwise blue) pixels in the line
+        };
+
+        BayerLine bayer_line(BayerPattern pattern, uint8_t const *src, size_t srcStep, int y, int height) {
+            auto above = y == 0 ? 1 : y - 1;
+            auto below = y == height - 1 ? height - 2 : y + 1;
+
+            auto greenFirst = pattern == BayerPattern::GRBG || pattern == BayerPattern::GBRG;
+            auto redLine = pattern == BayerPattern::RGGB || pattern == BayerPattern::GRBG;
+
+            // odd lines have the opposite phase
+            auto isOdd = y % 2 != 0;
+
+            return BayerLine{src + static_cast<size_t>(above) * srcStep, src + static_cast<size_t>(y) * srcStep,
+                             src + static_cast<size_t>(below) * srcStep, greenFirst != isOdd, redLine != isOdd};
+        }
+
+        // Rounding average (as in SIMD instructions)
+        inline uint8_t average(uint8_t a, uint8_t b) {
+            return static_cast<uint8_t>((a + b + 1) >> 1);
+        }
+
+        // Demosaics pixels in [begin, end) of the line (width is at least 2)
+        void bayer_pixels_scalar(BayerLine const &line, BayerTarget target, uint8_t *dst,
+                                 size_t begin, size_t end, size_t width) {
+            auto rIndex = target == BayerTarget::BGR ? 2 : 0;
+
+            for (auto x = begin; x < end; ++x) {
+                auto left = x == 0 ? 1 : x - 1;
+                auto right = x == width - 1 ? width - 2 : x + 1;
+
+                auto center = line.current[x];
+                auto horizontal = average(line.current[left], line.current[right]);
+                auto vertical = average(line.above[x], line.below[x]);
+                auto cross = average(horizontal, vertical);
+                auto diagonal = average(average(line.above[left], line.above[right]),
+                                        average(line.below[left], line.below[right]));
+
+                auto isGreen = (x % 2 == 0) == line.greenFirst;
+
+                // line color is horizontally interpolated at the green pixels
+                auto own = isGreen ? horizontal : center;
+                auto green = isGreen ? center : cross;
+                auto other = isGreen ? vertical : diagonal;
+
+                auto red = line.redLine ? own : other;
+                auto blue = line.redLine ? other : own;
+
+                if (target == BayerTarget::MONO8) {
+                    dst[x] = average(average(red, blue), green);
+                } else {
+                    dst[3 * x + rIndex] = red;
+                    dst[3 * x + 1] = green;
+                    dst[3 * x + 2 - rIndex] = blue;
+                }
+            }
+        }
+
+        /* Demosaics a single line starting from the second pixel, returns the end of processed pixels */
+        using BayerLineKernel = size_t (*)(BayerLine const &line, BayerTarget target, uint8_t *dst, size_t width);
+
+        size_t bayer_line_scalar(BayerLine const &line, BayerTarget target, uint8_t *dst, size_t width) {
+            bayer_pixels_scalar(line, target, dst, 1, width, width);
+            return width;
+        }
+
+        // Packed formats have the fixed number of significant bits
+        RawFormat normalized(RawFormat format) {
+            switch (format.packing) {
+                case RawPacking::MIPI10:
+                    return RawFormat{format.packing, 10};
+                case RawPacking::MIPI12:
+                    return RawFormat{format.packing, 12};
+                default:
+                    return RawFormat{format.packing, std::clamp<uint8_t>(format.bits, 8, 16)};
+            }
+        }
+
+        template<RawPacking Packing>
+        inline uint16_t raw_pixel(uint8_t const *src, size_t x) {
+            if constexpr (Packing == RawPacking::MIPI10) {
+                auto group = src + 5 * (x / 4);
+                auto index = x % 4;
+                return static_cast<uint16_t>(group[index] << 2 | ((group[4] >> (2 * index)) & 0x3));
+            } else if constexpr (Packing == RawPacking::MIPI12) {
+                auto group = src + 3 * (x / 2);
+                auto index = x % 2;
+                return static_cast<uint16_t>(group[index] << 4 | ((group[2] >> (4 * index)) & 0xF));
+            } else {
+                return static_cast<uint16_t>(src[2 * x] | src[2 * x + 1] << 8);
+            }
+        }
+
+        template<RawPacking Packing>
+        void raw_pixels_scalar(int alignment, uint8_t const *src, uint8_t *dst, size_t begin, size_t end) {
+            for (auto x = begin; x < end; ++x) {
+                auto value = static_cast<uint16_t>(raw_pixel<Packing>(src, x) << alignment);
+                dst[2 * x] = static_cast<uint8_t>(value & 0xFF);
+                dst[2 * x + 1] = static_cast<uint8_t>(value >> 8);
+            }
+        }
+
+        // Unpacks pixels in [begin, end) of the line into MSB-aligned little-endian 16-bit words
+        void raw_pixels_scalar(RawFormat format, uint8_t const *src, uint8_t *dst, size_t begin, size_t end) {
+            auto alignment = 16 - format.bits;
+
+            switch (format.packing) {
+                case RawPacking::MIPI10:
+                    return raw_pixels_scalar<RawPacking::MIPI10>(alignment, src, dst, begin, end);
+                case RawPacking::MIPI12:
+                    return raw_pixels_scalar<RawPacking::MIPI12>(alignment, src, dst, begin, end);
+                default:
+                    return raw_pixels_scalar<RawPacking::UNPACKED>(alignment, src, dst, begin, end);
+            }
+        }
+
+        /* Unpacks a single line, returns number of processed pixels */
+        using RawLineKernel = size_t (*)(RawFormat format, uint8_t const *src, uint8_t *dst, size_t width);
+
+        size_t raw_line_scalar(RawFormat format, uint8_t const *src, uint8_t *dst, size_t width) {
+            raw_pixels_scalar(format, src, dst, 0, width);
+            return width;
+        }
+
+        /* Fixed-point mapping of the MSB-aligned window onto [0, 255] (see compute_window_coefficients()) */
+        struct WindowCoefficients final {
+            uint16_t min;
+            uint16_t range;
+            int shift;       // normalizes range into [2^15, 2^16)
+            uint16_t scale;  // 23 fractional bits
+        };
+
+        constexpr auto WINDOW_FRACTION_BITS = 23;
+
+        WindowCoefficients compute_window_coefficients(RawFormat format, RawWindow window) {
+            auto alignment = 16 - format.bits;
+
+            auto min = std::min(uint32_t{window.min} << alignment, uint32_t{UINT16_MAX});
+            auto range = window.max > window.min ? uint32_t{window.max} - window.min : 1u;
+            range = std::min(range << alignment, uint32_t{UINT16_MAX});
+
+            auto shift = 0;
+            while ((range << shift) < 0x8000) ++shift;
+
+            // rounded up, thus the window's maximum is mapped onto 255
+            auto normalized = range << shift;
+            auto scale = ((uint64_t{255} << WINDOW_FRACTION_BITS) + normalized - 1) / normalized;
+
+            return WindowCoefficients{static_cast<uint16_t>(min), static_cast<uint16_t>(range), shift,
+                                      static_cast<uint16_t>(scale)};
+        }
+
+        inline uint8_t window_pixel(WindowCoefficients const &c, uint16_t value) {
+            auto offset = std::min<uint32_t>(value > c.min ? value - c.min : 0, c.range);
+            auto scaled = ((offset << c.shift) * c.scale) >> WINDOW_FRACTION_BITS;
+            return static_cast<uint8_t>(std::min<uint32_t>(scaled, 255));
+        }
+
+        // Windows pixels in [begin, end) of the unpacked 16-bit line
+        void window_pixels_scalar(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst,
+                                  size_t begin, size_t end) {
+            for (auto x = begin; x < end; ++x) {
+                dst[x] = window_pixel(c, static_cast<uint16_t>(src[2 * x] | src[2 * x + 1] << 8));
+            }
+        }
+
+        /* Windows a single unpacked line, returns number of processed pixels */
+        using WindowLineKernel = size_t (*)(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst,
+                                            size_t width);
+
+        size_t window_line_scalar(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst, size_t width) {
+            window_pixels_scalar(c, src, dst, 0, width);
+            return width;
+        }
+
+#ifdef LIRS_PIXEL_CONVERSION_X86
+
+        size_t yuyv_to_mono8_line_sse2(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto const lumaMask = _mm_set1_epi16(0x00FF);
+
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                auto lo = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 2 * x));
+                auto hi = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 2 * x + 16));
+
+                auto luma = _mm_packus_epi16(_mm_and_si128(lo, lumaMask), _mm_and_si128(hi, lumaMask));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), luma);
+            }
+            return x;
+        }
+
+        __attribute__((target("avx2")))
+        size_t yuyv_to_mono8_line_avx2(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto const lumaMask = _mm256_set1_epi16(0x00FF);
+
+            auto x = size_t{0};
+            for (; x + 32 <= width; x += 32) {
+                auto lo = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 2 * x));
+                auto hi = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 2 * x + 32));
+
+                // packing works within 128-bit lanes, thus 64-bit quarters are reordered afterwards
+                auto luma = _mm256_packus_epi16(_mm256_and_si256(lo, lumaMask), _mm256_and_si256(hi, lumaMask));
+                luma = _mm256_permute4x64_epi64(luma, 0xD8);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), luma);
+            }
+            return x;
+        }
+
+        size_t yuyv_to_uyvy_line_sse2(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                for (auto offset = 0; offset < 32; offset += 16) {
+                    auto pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 2 * x + offset));
+
+                    // swap bytes within 16-bit words
+                    auto swapped = _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8));
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * x + offset), swapped);
+                }
+            }
+            return x;
+        }
+
+        __attribute__((target("avx2")))
+        size_t yuyv_to_uyvy_line_avx2(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto const swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+            auto x = size_t{0};
+            for (; x + 32 <= width; x += 32) {
+                for (auto offset = 0; offset < 64; offset += 32) {
+                    auto pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 2 * x + offset));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * x + offset),
+                                        _mm256_shuffle_epi8(pixels, swap));
+                }
+            }
+            return x;
+        }
+
+        inline __m128i select_sse2(__m128i mask, __m128i a, __m128i b) {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        size_t bayer_line_sse2(BayerLine const &line, BayerTarget target, uint8_t *dst, size_t width) {
+            alignas(16) uint8_t r[16], g[16], b[16];
+
+            auto load = [](uint8_t const *ptr) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr)); };
+
+            // processing starts from the odd pixel
+            auto const greenMask = _mm_set1_epi16(line.greenFirst ? static_cast<int16_t>(0xFF00) : 0x00FF);
+
+            auto x = size_t{1};
+            for (; x + 17 <= width; x += 16) {
+                auto center = load(line.current + x);
+                auto horizontal = _mm_avg_epu8(load(line.current + x - 1), load(line.current + x + 1));
+                auto vertical = _mm_avg_epu8(load(line.above + x), load(line.below + x));
+                auto cross = _mm_avg_epu8(horizontal, vertical);
+                auto diagonal = _mm_avg_epu8(_mm_avg_epu8(load(line.above + x - 1), load(line.above + x + 1)),
+                                             _mm_avg_epu8(load(line.below + x - 1), load(line.below + x + 1)));
+
+                auto own = select_sse2(greenMask, horizontal, center);
+                auto green = select_sse2(greenMask, center, cross);
+                auto other = select_sse2(greenMask, vertical, diagonal);
+
+                auto red = line.redLine ? own : other;
+                auto blue = line.redLine ? other : own;
+
+                if (target == BayerTarget::MONO8) {
+                    auto mono = _mm_avg_epu8(_mm_avg_epu8(red, blue), green);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), mono);
+                } else {
+                    _mm_store_si128(reinterpret_cast<__m128i *>(r), red);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(g), green);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(b), blue);
+
+                    auto rIndex = target == BayerTarget::BGR ? size_t{2} : size_t{0};
+                    interleave_rgb(r, g, b, 16, dst + 3 * x, rIndex, 2 - rIndex);
+                }
+            }
+            return x;
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i select_avx2(__m256i mask, __m256i a, __m256i b) {
+            return _mm256_blendv_epi8(b, a, mask);
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i load_avx2(uint8_t const *ptr) {
+            return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(ptr));
+        }
+
+        __attribute__((target("avx2")))
+        size_t bayer_line_avx2(BayerLine const &line, BayerTarget target, uint8_t *dst, size_t width) {
+            alignas(32) uint8_t r[32], g[32], b[32];
+
+            // processing starts from the odd pixel
+            auto const greenMask = _mm256_set1_epi16(line.greenFirst ? static_cast<int16_t>(0xFF00) : 0x00FF);
+
+            auto x = size_t{1};
+            for (; x + 33 <= width; x += 32) {
+                auto center = load_avx2(line.current + x);
+                auto horizontal = _mm256_avg_epu8(load_avx2(line.current + x - 1), load_avx2(line.current + x + 1));
+                auto vertical = _mm256_avg_epu8(load_avx2(line.above + x), load_avx2(line.below + x));
+                auto cross = _mm256_avg_epu8(horizontal, vertical);
+                auto diagonalAbove = _mm256_avg_epu8(load_avx2(line.above + x - 1), load_avx2(line.above + x + 1));
+                auto diagonalBelow = _mm256_avg_epu8(load_avx2(line.below + x - 1), load_avx2(line.below + x + 1));
+                auto diagonal = _mm256_avg_epu8(diagonalAbove, diagonalBelow);
+
+                auto own = select_avx2(greenMask, horizontal, center);
+                auto green = select_avx2(greenMask, center, cross);
+                auto other = select_avx2(greenMask, vertical, diagonal);
+
+                auto red = line.redLine ? own : other;
+                auto blue = line.redLine ? other : own;
+
+                if (target == BayerTarget::MONO8) {
+                    auto mono = _mm256_avg_epu8(_mm256_avg_epu8(red, blue), green);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), mono);
+                } else {
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(r), red);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(g), green);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(b), blue);
+
+                    auto rIndex = target == BayerTarget::BGR ? size_t{2} : size_t{0};
+                    interleave_rgb(r, g, b, 32, dst + 3 * x, rIndex, 2 - rIndex);
+                }
+            }
+            return x;
+        }
+
+        size_t raw_line_sse2(RawFormat format, uint8_t const *src, uint8_t *dst, size_t width) {
+            if (format.packing != RawPacking::UNPACKED) return 0;  // byte shuffles are not available
+
+            auto const alignment = _mm_cvtsi32_si128(16 - format.bits);
+
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                for (auto offset = 0; offset < 32; offset += 16) {
+                    auto words = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 2 * x + offset));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * x + offset),
+                                     _mm_sll_epi16(words, alignment));
+                }
+            }
+            return x;
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i load_lanes_avx2(uint8_t const *lo, uint8_t const *hi) {
+            auto low = _mm_loadu_si128(reinterpret_cast<__m128i const *>(lo));
+            auto high = _mm_loadu_si128(reinterpret_cast<__m128i const *>(hi));
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        }
+
+        // Composes MSB-aligned words from the high bytes and the low bits moved into the top of the low bytes
+        __attribute__((target("avx2")))
+        inline __m256i unpack_mipi_avx2(__m256i raw, __m256i highBytes, __m256i lowBytes,
+                                        __m256i lowShifts, __m256i lowMask) {
+            auto high = _mm256_shuffle_epi8(raw, highBytes);
+            auto low = _mm256_mullo_epi16(_mm256_shuffle_epi8(raw, lowBytes), lowShifts);
+            return _mm256_or_si256(high, _mm256_and_si256(low, lowMask));
+        }
+
+        __attribute__((target("avx2")))
+        size_t raw_line_avx2(RawFormat format, uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+
+            switch (format.packing) {
+                case RawPacking::MIPI10: {
+                    // 8 pixels (10 bytes) per lane, 2-bit low parts are shifted by multiplication
+                    auto const highBytes = _mm256_setr_epi8(-1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8,
+                                                            -1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8);
+                    auto const lowBytes = _mm256_setr_epi8(4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1,
+                                                           4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1);
+                    auto const lowShifts = _mm256_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1,
+                                                             64, 16, 4, 1, 64, 16, 4, 1);
+                    auto const lowMask = _mm256_set1_epi16(0x00C0);
+
+                    // lanes are loaded as 16 bytes (overlapping the next pixels)
+                    for (; x + 24 <= width; x += 16) {
+                        auto raw = load_lanes_avx2(src + 5 * x / 4, src + 5 * x / 4 + 10);
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * x),
+                                            unpack_mipi_avx2(raw, highBytes, lowBytes, lowShifts, lowMask));
+                    }
+                    break;
+                }
+                case RawPacking::MIPI12: {
+                    // 8 pixels (12 bytes) per lane
+                    auto const highBytes = _mm256_setr_epi8(-1, 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10,
+                                                            -1, 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10);
+                    auto const lowBytes = _mm256_setr_epi8(2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1,
+                                                           2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1);
+                    auto const lowShifts = _mm256_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1,
+                                                             16, 1, 16, 1, 16, 1, 16, 1);
+                    auto const lowMask = _mm256_set1_epi16(0x00F0);
+
+                    for (; x + 24 <= width; x += 16) {
+                        auto raw = load_lanes_avx2(src + 3 * x / 2, src + 3 * x / 2 + 12);
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * x),
+                                            unpack_mipi_avx2(raw, highBytes, lowBytes, lowShifts, lowMask));
+                    }
+                    break;
+                }
+                default: {
+                    auto const alignment = _mm_cvtsi32_si128(16 - format.bits);
+
+                    for (; x + 16 <= width; x += 16) {
+                        auto words = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 2 * x));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * x),
+                                            _mm256_sll_epi16(words, alignment));
+                    }
+                }
+            }
+            return x;
+        }
+
+        size_t window_line_sse2(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst, size_t width) {
+            auto const minimum = _mm_set1_epi16(static_cast<int16_t>(c.min));
+            auto const range = _mm_set1_epi16(static_cast<int16_t>(c.range));
+            auto const scale = _mm_set1_epi16(static_cast<int16_t>(c.scale));
+            auto const shift = _mm_cvtsi32_si128(c.shift);
+
+            auto window = [&](uint8_t const *words) {
+                auto offset = _mm_subs_epu16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(words)), minimum);
+                offset = _mm_sub_epi16(offset, _mm_subs_epu16(offset, range));  // min(offset, range)
+
+                auto scaled = _mm_mulhi_epu16(_mm_sll_epi16(offset, shift), scale);
+                return _mm_srli_epi16(scaled, WINDOW_FRACTION_BITS - 16);
+            };
+
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                auto values = _mm_packus_epi16(window(src + 2 * x), window(src + 2 * x + 16));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), values);
+            }
+            return x;
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i window_avx2(uint8_t const *words, WindowCoefficients const &c) {
+            auto offset = _mm256_subs_epu16(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(words)),
+                                            _mm256_set1_epi16(static_cast<int16_t>(c.min)));
+            offset = _mm256_min_epu16(offset, _mm256_set1_epi16(static_cast<int16_t>(c.range)));
+
+            auto scaled = _mm256_mulhi_epu16(_mm256_sll_epi16(offset, _mm_cvtsi32_si128(c.shift)),
+                                             _mm256_set1_epi16(static_cast<int16_t>(c.scale)));
+            return _mm256_srli_epi16(scaled, WINDOW_FRACTION_BITS - 16);
+        }
+
+        // Packs 16-bit lanes into bytes (packing works within 128-bit lanes, thus quarters are reordered)
+        __attribute__((target("avx2")))
+        inline __m256i pack_avx2(__m256i lo, __m256i hi) {
+            return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        }
+
+        __attribute__((target("avx2")))
+        size_t window_line_avx2(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+            for (; x + 32 <= width; x += 32) {
+                auto values = pack_avx2(window_avx2(src + 2 * x, c), window_avx2(src + 2 * x + 32, c));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), values);
+            }
+            return x;
+        }
+
+        /* Converts 8 pixels (16 bytes) of YUV 4:2:2 into 16-bit R, G and B */
+        template<YuvLayout Layout>
+        inline void yuv422_to_rgb16_sse2(__m128i pixels, RgbCoefficients const &c,
+                                         __m128i &r, __m128i &g, __m128i &b) {
+            auto const lowBytes = _mm_set1_epi16(0x00FF);
+            auto const lowWords = _mm_set1_epi32(0xFFFF);
+
+            auto y = Layout == YuvLayout::YUYV ? _mm_and_si128(pixels, lowBytes) : _mm_srli_epi16(pixels, 8);
+            auto uv = Layout == YuvLayout::YUYV ? _mm_srli_epi16(pixels, 8) : _mm_and_si128(pixels, lowBytes);
+
+            // duplicate chroma for both pixels of the pair
+            auto u = _mm_and_si128(uv, lowWords);
+            u = _mm_sub_epi16(_mm_or_si128(u, _mm_slli_epi32(u, 16)), _mm_set1_epi16(CHROMA_OFFSET));
+
+            auto v = _mm_srli_epi32(uv, 16);
+            v = _mm_sub_epi16(_mm_or_si128(v, _mm_slli_epi32(v, 16)), _mm_set1_epi16(CHROMA_OFFSET));
+
+            auto luma = _mm_subs_epu16(y, _mm_set1_epi16(static_cast<int16_t>(c.yOffset)));
+            luma = _mm_mulhi_epu16(_mm_slli_epi16(luma, 8), _mm_set1_epi16(static_cast<int16_t>(c.yScale)));
+            luma = _mm_add_epi16(luma, _mm_set1_epi16(RGB_ROUNDING));
+
+            r = _mm_adds_epi16(luma, _mm_mullo_epi16(v, _mm_set1_epi16(c.rv)));
+            g = _mm_subs_epi16(_mm_subs_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(c.gu))),
+                               _mm_mullo_epi16(v, _mm_set1_epi16(c.gv)));
+            b = _mm_adds_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(c.bu)));
+
+            r = _mm_srai_epi16(r, RGB_FRACTION_BITS);
+            g = _mm_srai_epi16(g, RGB_FRACTION_BITS);
+            b = _mm_srai_epi16(b, RGB_FRACTION_BITS);
+        }
+
+        template<YuvLayout Layout>
+        size_t yuv422_to_rgb_line_sse2(RgbCoefficients const &c, uint8_t const *src,
+                                       uint8_t *dst, size_t width, size_t rIndex, size_t bIndex) {
+            alignas(16) uint8_t r[16], g[16], b[16];
+
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                __m128i r16[2], g16[2], b16[2];
+
+                for (auto half = 0; half < 2; ++half) {
+                    auto pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + 2 * x + 16 * half));
+                    yuv422_to_rgb16_sse2<Layout>(pixels, c, r16[half], g16[half], b16[half]);
+                }
+
+                _mm_store_si128(reinterpret_cast<__m128i *>(r), _mm_packus_epi16(r16[0], r16[1]));
+                _mm_store_si128(reinterpret_cast<__m128i *>(g), _mm_packus_epi16(g16[0], g16[1]));
+                _mm_store_si128(reinterpret_cast<__m128i *>(b), _mm_packus_epi16(b16[0], b16[1]));
+
+                interleave_rgb(r, g, b, 16, dst + 3 * x, rIndex, bIndex);
+            }
+            return x;
+        }
+
+        size_t yuv422_to_rgb_line_sse2(RgbCoefficients const &c, YuvLayout layout, uint8_t const *src,
+                                       uint8_t *dst, size_t width, size_t rIndex, size_t bIndex) {
+            return layout == YuvLayout::YUYV
+                   ? yuv422_to_rgb_line_sse2<YuvLayout::YUYV>(c, src, dst, width, rIndex, bIndex)
+                   : yuv422_to_rgb_line_sse2<YuvLayout::UYVY>(c, src, dst, width, rIndex, bIndex);
+        }
+
+        /* Converts 16 pixels (32 bytes) of YUV 4:2:2 into 16-bit R, G and B */
+        template<YuvLayout Layout>
+        __attribute__((target("avx2")))
+        inline void yuv422_to_rgb16_avx2(__m256i pixels, RgbCoefficients const &c,
+                                         __m256i &r, __m256i &g, __m256i &b) {
+            auto const lowBytes = _mm256_set1_epi16(0x00FF);
+            auto const lowWords = _mm256_set1_epi32(0xFFFF);
+
+            auto y = Layout == YuvLayout::YUYV ? _mm256_and_si256(pixels, lowBytes) : _mm256_srli_epi16(pixels, 8);
+            auto uv = Layout == YuvLayout::YUYV ? _mm256_srli_epi16(pixels, 8) : _mm256_and_si256(pixels, lowBytes);
+
+            // duplicate chroma for both pixels of the pair
+            auto u = _mm256_and_si256(uv, lowWords);
+            u = _mm256_sub_epi16(_mm256_or_si256(u, _mm256_slli_epi32(u, 16)), _mm256_set1_epi16(CHROMA_OFFSET));
+
+            auto v = _mm256_srli_epi32(uv, 16);
+            v = _mm256_sub_epi16(_mm256_or_si256(v, _mm256_slli_epi32(v, 16)), _mm256_set1_epi16(CHROMA_OFFSET));
+
+            auto luma = _mm256_subs_epu16(y, _mm256_set1_epi16(static_cast<int16_t>(c.yOffset)));
+            luma = _mm256_mulhi_epu16(_mm256_slli_epi16(luma, 8), _mm256_set1_epi16(static_cast<int16_t>(c.yScale)));
+            luma = _mm256_add_epi16(luma, _mm256_set1_epi16(RGB_ROUNDING));
+
+            r = _mm256_adds_epi16(luma, _mm256_mullo_epi16(v, _mm256_set1_epi16(c.rv)));
+            g = _mm256_subs_epi16(_mm256_subs_epi16(luma, _mm256_mullo_epi16(u, _mm256_set1_epi16(c.gu))),
+                                  _mm256_mullo_epi16(v, _mm256_set1_epi16(c.gv)));
+            b = _mm256_adds_epi16(luma, _mm256_mullo_epi16(u, _mm256_set1_epi16(c.bu)));
+
+            r = _mm256_srai_epi16(r, RGB_FRACTION_BITS);
+            g = _mm256_srai_epi16(g, RGB_FRACTION_BITS);
+            b = _mm256_srai_epi16(b, RGB_FRACTION_BITS);
+        }
+
+        template<YuvLayout Layout>
+        __attribute__((target("avx2")))
+        size_t yuv422_to_rgb_line_avx2(RgbCoefficients const &c, uint8_t const *src,
+                                       uint8_t *dst, size_t width, size_t rIndex, size_t bIndex) {
+            alignas(32) uint8_t r[32], g[32], b[32];
+
+            auto x = size_t{0};
+            for (; x + 32 <= width; x += 32) {
+                __m256i r16[2], g16[2], b16[2];
+
+                for (auto half = 0; half < 2; ++half) {
+                    auto pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + 2 * x + 32 * half));
+                    yuv422_to_rgb16_avx2<Layout>(pixels, c, r16[half], g16[half], b16[half]);
+                }
+
+                _mm256_store_si256(reinterpret_cast<__m256i *>(r), pack_avx2(r16[0], r16[1]));
+                _mm256_store_si256(reinterpret_cast<__m256i *>(g), pack_avx2(g16[0], g16[1]));
+                _mm256_store_si256(reinterpret_cast<__m256i *>(b), pack_avx2(b16[0], b16[1]));
+
+                interleave_rgb(r, g, b, 32, dst + 3 * x, rIndex, bIndex);
+            }
+            return x;
+        }
+
+        size_t yuv422_to_rgb_line_avx2(RgbCoefficients const &c, YuvLayout layout, uint8_t const *src,
+                                       uint8_t *dst, size_t width, size_t rIndex, size_t bIndex) {
+            return layout == YuvLayout::YUYV
+                   ? yuv422_to_rgb_line_avx2<YuvLayout::YUYV>(c, src, dst, width, rIndex, bIndex)
+                   : yuv422_to_rgb_line_avx2<YuvLayout::UYVY>(c, src, dst, width, rIndex, bIndex);
+        }
+
+#endif
+
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+
+        size_t yuyv_to_mono8_line_neon(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                auto pixels = vld2q_u8(src + 2 * x);  // deinterleaves Y and UV
+                vst1q_u8(dst + x, pixels.val[0]);
+            }
+            return x;
+        }
+
+        size_t yuyv_to_uyvy_line_neon(uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                vst1q_u8(dst + 2 * x, vrev16q_u8(vld1q_u8(src + 2 * x)));
+                vst1q_u8(dst + 2 * x + 16, vrev16q_u8(vld1q_u8(src + 2 * x + 16)));
+            }
+            return x;
+        }
+
+        /* Converts 8 pixels into R, G and B, chroma is shared by the even and odd pixels */
+        inline void yuv_to_rgb8_neon(uint8x8_t y, int16x8_t u, int16x8_t v, RgbCoefficients const &c,
+                                     uint8x8_t &r, uint8x8_t &g, uint8x8_t &b) {
+            auto luma16 = vshlq_n_u16(vqsubq_u16(vmovl_u8(y), vdupq_n_u16(c.yOffset)), 8);
+
+            auto lumaLo = vshrn_n_u32(vmull_u16(vget_low_u16(luma16), vdup_n_u16(c.yScale)), 16);
+            auto lumaHi = vshrn_n_u32(vmull_u16(vget_high_u16(luma16), vdup_n_u16(c.yScale)), 16);
+
+            auto luma = vaddq_s16(vreinterpretq_s16_u16(vcombine_u16(lumaLo, lumaHi)), vdupq_n_s16(RGB_ROUNDING));
+
+            auto r16 = vqaddq_s16(luma, vmulq_n_s16(v, c.rv));
+            auto g16 = vqsubq_s16(vqsubq_s16(luma, vmulq_n_s16(u, c.gu)), vmulq_n_s16(v, c.gv));
+            auto b16 = vqaddq_s16(luma, vmulq_n_s16(u, c.bu));
+
+            r = vqshrun_n_s16(r16, RGB_FRACTION_BITS);
+            g = vqshrun_n_s16(g16, RGB_FRACTION_BITS);
+            b = vqshrun_n_s16(b16, RGB_FRACTION_BITS);
+        }
+
+        size_t bayer_line_neon(BayerLine const &line, BayerTarget target, uint8_t *dst, size_t width) {
+            // processing starts from the odd pixel
+            auto const greenMask = vreinterpretq_u8_u16(vdupq_n_u16(line.greenFirst ? 0xFF00 : 0x00FF));
+
+            auto x = size_t{1};
+            for (; x + 17 <= width; x += 16) {
+                auto center = vld1q_u8(line.current + x);
+                auto horizontal = vrhaddq_u8(vld1q_u8(line.current + x - 1), vld1q_u8(line.current + x + 1));
+                auto vertical = vrhaddq_u8(vld1q_u8(line.above + x), vld1q_u8(line.below + x));
+                auto cross = vrhaddq_u8(horizontal, vertical);
+                auto diagonal = vrhaddq_u8(vrhaddq_u8(vld1q_u8(line.above + x - 1), vld1q_u8(line.above + x + 1)),
+                                           vrhaddq_u8(vld1q_u8(line.below + x - 1), vld1q_u8(line.below + x + 1)));
+
+                auto own = vbslq_u8(greenMask, horizontal, center);
+                auto green = vbslq_u8(greenMask, center, cross);
+                auto other = vbslq_u8(greenMask, vertical, diagonal);
+
+                auto red = line.redLine ? own : other;
+                auto blue = line.redLine ? other : own;
+
+                if (target == BayerTarget::MONO8) {
+                    vst1q_u8(dst + x, vrhaddq_u8(vrhaddq_u8(red, blue), green));
+                } else if (target == BayerTarget::RGB) {
+                    vst3q_u8(dst + 3 * x, uint8x16x3_t{{red, green, blue}});
+                } else {
+                    vst3q_u8(dst + 3 * x, uint8x16x3_t{{blue, green, red}});
+                }
+            }
+            return x;
+        }
+
+        size_t raw_line_neon(RawFormat format, uint8_t const *src, uint8_t *dst, size_t width) {
+            auto x = size_t{0};
+
+            switch (format.packing) {
+                case RawPacking::MIPI10: {
+                    // 8 pixels (10 bytes) per table lookup, 2-bit low parts are moved into the top of the low bytes
+                    static constexpr uint8_t highBytes[8] = {0, 1, 2, 3, 5, 6, 7, 8};
+                    static constexpr uint8_t lowBytes[8] = {4, 4, 4, 4, 9, 9, 9, 9};
+                    static constexpr int8_t lowShifts[8] = {6, 4, 2, 0, 6, 4, 2, 0};
+
+                    for (; x + 16 <= width; x += 8) {
+                        auto raw = vld1q_u8(src + 5 * x / 4);
+                        auto table = uint8x8x2_t{{vget_low_u8(raw), vget_high_u8(raw)}};
+
+                        auto high = vtbl2_u8(table, vld1_u8(highBytes));
+                        auto low = vand_u8(vshl_u8(vtbl2_u8(table, vld1_u8(lowBytes)), vld1_s8(lowShifts)),
+                                           vdup_n_u8(0xC0));
+
+                        vst1q_u8(dst + 2 * x, vreinterpretq_u8_u16(vorrq_u16(vshll_n_u8(high, 8), vmovl_u8(low))));
+                    }
+                    break;
+                }
+                case RawPacking::MIPI12: {
+                    for (; x + 16 <= width; x += 16) {
+                        auto groups = vld3_u8(src + 3 * x / 2);  // even high, odd high and low bytes
+
+                        auto even = vorrq_u16(vshll_n_u8(groups.val[0], 8), vmovl_u8(vshl_n_u8(groups.val[2], 4)));
+                        auto odd = vorrq_u16(vshll_n_u8(groups.val[1], 8),
+                                             vmovl_u8(vand_u8(groups.val[2], vdup_n_u8(0xF0))));
+
+                        vst2q_u16(reinterpret_cast<uint16_t *>(dst + 2 * x), uint16x8x2_t{{even, odd}});
+                    }
+                    break;
+                }
+                default: {
+                    auto const alignment = vdupq_n_s16(static_cast<int16_t>(16 - format.bits));
+
+                    for (; x + 8 <= width; x += 8) {
+                        auto words = vreinterpretq_u16_u8(vld1q_u8(src + 2 * x));
+                        vst1q_u8(dst + 2 * x, vreinterpretq_u8_u16(vshlq_u16(words, alignment)));
+                    }
+                }
+            }
+            return x;
+        }
+
+        size_t window_line_neon(WindowCoefficients const &c, uint8_t const *src, uint8_t *dst, size_t width) {
+            auto const minimum = vdupq_n_u16(c.min);
+            auto const range = vdupq_n_u16(c.range);
+            auto const scale = vdup_n_u16(c.scale);
+            auto const shift = vdupq_n_s16(static_cast<int16_t>(c.shift));
+
+            auto x = size_t{0};
+            for (; x + 8 <= width; x += 8) {
+                auto offset = vminq_u16(vqsubq_u16(vreinterpretq_u16_u8(vld1q_u8(src + 2 * x)), minimum), range);
+                offset = vshlq_u16(offset, shift);
+
+                auto lo = vshrq_n_u32(vmull_u16(vget_low_u16(offset), scale), WINDOW_FRACTION_BITS);
+                auto hi = vshrq_n_u32(vmull_u16(vget_high_u16(offset), scale), WINDOW_FRACTION_BITS);
+
+                vst1_u8(dst + x, vqmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi))));
+            }
+            return x;
+        }
+
+        size_t yuv422_to_rgb_line_neon(RgbCoefficients const &c, YuvLayout layout, uint8_t const *src,
+                                       uint8_t *dst, size_t width, size_t rIndex, size_t /* bIndex */) {
+            auto isYuyv = layout == YuvLayout::YUYV;
+
+            auto x = size_t{0};
+            for (; x + 16 <= width; x += 16) {
+                auto pixels = vld4_u8(src + 2 * x);  // 8 pixel pairs deinterleaved by component
+
+                auto y0 = pixels.val[isYuyv ? 0 : 1];
+                auto y1 = pixels.val[isYuyv ? 2 : 3];
+
+                auto chromaOffset = vdupq_n_s16(CHROMA_OFFSET);
+                auto u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(pixels.val[isYuyv ? 1 : 0])), chromaOffset);
+                auto v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(pixels.val[isYuyv ? 3 : 2])), chromaOffset);
+
+                uint8x8_t r0, g0, b0, r1, g1, b1;
+                yuv_to_rgb8_neon(y0, u, v, c, r0, g0, b0);
+                yuv_to_rgb8_neon(y1, u, v, c, r1, g1, b1);
+
+                // interleave even and odd pixels
+                auto r = vzip_u8(r0, r1);
+                auto g = vzip_u8(g0, g1);
+                auto b = vzip_u8(b0, b1);
+
+                auto isRgb = rIndex == 0;
+
+                vst3q_u8(dst + 3 * x, uint8x16x3_t{{isRgb ? vcombine_u8(r.val[0], r.val[1])
+                                                          : vcombine_u8(b.val[0], b.val[1]),
+                                                    vcombine_u8(g.val[0], g.val[1]),
+                                                    isRgb ? vcombine_u8(b.val[0], b.val[1])
+                                                          : vcombine_u8(r.val[0], r.val[1])}});
+            }
+            return x;
+        }
+
+#endif
+
+        bool is_supported(SimdLevel level) {
+            switch (level) {
+                case SimdLevel::SCALAR:
+                    return true;
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return __builtin_cpu_supports("sse2");
+                case SimdLevel::AVX2:
+                    return __builtin_cpu_supports("avx2");
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return true;
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        LineKernel yuyv_to_mono8_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return yuyv_to_mono8_line_sse2;
+                case SimdLevel::AVX2:
+                    return yuyv_to_mono8_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return yuyv_to_mono8_line_neon;
+#endif
+                default:
+                    return yuyv_to_mono8_line_scalar;
+            }
+        }
+
+        LineKernel yuyv_to_uyvy_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return yuyv_to_uyvy_line_sse2;
+                case SimdLevel::AVX2:
+                    return yuyv_to_uyvy_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return yuyv_to_uyvy_line_neon;
+#endif
+                default:
+                    return yuyv_to_uyvy_line_scalar;
+            }
+        }
+
+        void yuyv_to_uyvy_image(LineKernel kernel, uint8_t const *src, size_t srcStep,
+                                uint8_t *dst, size_t dstStep, int width, int height) {
+            auto lineWidth = static_cast<size_t>(width);
+
+            for (auto y = 0; y < height; ++y, src += srcStep, dst += dstStep) {
+                auto processed = kernel(src, dst, lineWidth);
+                yuyv_to_uyvy_line_scalar(src + 2 * processed, dst + 2 * processed, lineWidth - processed);  // tail
+            }
+        }
+
+        RgbLineKernel yuv422_to_rgb_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return yuv422_to_rgb_line_sse2;
+                case SimdLevel::AVX2:
+                    return yuv422_to_rgb_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return yuv422_to_rgb_line_neon;
+#endif
+                default:
+                    return yuv422_to_rgb_line_scalar;
+            }
+        }
+
+        void yuv422_to_rgb_image(RgbLineKernel kernel, YuvToRgb const &conversion, uint8_t const *src,
+                                 size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+            auto coefficients = compute_rgb_coefficients(conversion);
+
+            auto rIndex = size_t{conversion.order == RgbOrder::RGB ? 0u : 2u};
+            auto bIndex = 2 - rIndex;
+
+            auto lineWidth = static_cast<size_t>(width);
+
+            for (auto y = 0; y < height; ++y, src += srcStep, dst += dstStep) {
+                auto processed = kernel(coefficients, conversion.layout, src, dst, lineWidth, rIndex, bIndex);
+
+                yuv422_to_rgb_line_scalar(coefficients, conversion.layout, src + 2 * processed,
+                                          dst + 3 * processed, lineWidth - processed, rIndex, bIndex);  // tail
+            }
+        }
+
+        RawLineKernel raw_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return raw_line_sse2;
+                case SimdLevel::AVX2:
+                    return raw_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return raw_line_neon;
+#endif
+                default:
+                    return raw_line_scalar;
+            }
+        }
+
+        WindowLineKernel window_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return window_line_sse2;
+                case SimdLevel::AVX2:
+                    return window_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return window_line_neon;
+#endif
+                default:
+                    return window_line_scalar;
+            }
+        }
+
+        void raw_to_16_image(RawLineKernel kernel, RawFormat format, uint8_t const *src, size_t srcStep,
+                             uint8_t *dst, size_t dstStep, int width, int height) {
+            auto lineWidth = static_cast<size_t>(width);
+
+            for (auto y = 0; y < height; ++y, src += srcStep, dst += dstStep) {
+                auto processed = kernel(format, src, dst, lineWidth);
+                raw_pixels_scalar(format, src, dst, processed, lineWidth);  // tail
+            }
+        }
+
+        void raw_to_8_image(RawLineKernel unpack, WindowLineKernel window, RawFormat format, RawWindow rawWindow,
+                            uint8_t const *src, size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+            auto coefficients = compute_window_coefficients(format, rawWindow);
+            auto lineWidth = static_cast<size_t>(width);
+
+            // unpacked line (stays in cache), reused between frames
+            thread_local std::vector<uint8_t> line;
+            line.resize(2 * lineWidth);
+
+            for (auto y = 0; y < height; ++y, src += srcStep, dst += dstStep) {
+                auto unpacked = unpack(format, src, line.data(), lineWidth);
+                raw_pixels_scalar(format, src, line.data(), unpacked, lineWidth);  // tail
+
+                auto processed = window(coefficients, line.data(), dst, lineWidth);
+                window_pixels_scalar(coefficients, line.data(), dst, processed, lineWidth);  // tail
+            }
+        }
+
+        BayerLineKernel bayer_kernel(SimdLevel level) {
+            switch (level) {
+#ifdef LIRS_PIXEL_CONVERSION_X86
+                case SimdLevel::SSE2:
+                    return bayer_line_sse2;
+                case SimdLevel::AVX2:
+                    return bayer_line_avx2;
+#endif
+#ifdef LIRS_PIXEL_CONVERSION_NEON
+                case SimdLevel::NEON:
+                    return bayer_line_neon;
+#endif
+                default:
+                    return bayer_line_scalar;
+            }
+        }
+
+        void bayer_image(BayerLineKernel kernel, BayerPattern pattern, BayerTarget target, uint8_t const *src,
+                         size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+            if (width < 2 || height < 2) return;  // no neighbours to interpolate from
+
+            auto lineWidth = static_cast<size_t>(width);
+
+            for (auto y = 0; y < height; ++y, dst += dstStep) {
+                auto line = bayer_line(pattern, src, srcStep, y, height);
+
+                bayer_pixels_scalar(line, target, dst, 0, 1, lineWidth);  // left border
+
+                auto processed = kernel(line, target, dst, lineWidth);
+                bayer_pixels_scalar(line, target, dst, processed, lineWidth, lineWidth);  // tail
+            }
+        }
+
+        void yuyv_to_mono8_image(LineKernel kernel, uint8_t const *src, size_t srcStep,
+                                 uint8_t *dst, size_t dstStep, int width, int height) {
+            auto lineWidth = static_cast<size_t>(width);
+
+            for (auto y = 0; y < height; ++y, src += srcStep, dst += dstStep) {
+                auto processed = kernel(src, dst, lineWidth);
+                yuyv_to_mono8_line_scalar(src + 2 * processed, dst + processed, lineWidth - processed);  // tail
+            }
+        }
+
+    }  // namespace
+
+    SimdLevel PixelConversion::simd_level() {
+        static auto const level = [] {
+            for (auto level : {SimdLevel::AVX2, SimdLevel::NEON, SimdLevel::SSE2}) {
+                if (is_supported(level)) return level;
+            }
+            return SimdLevel::SCALAR;
+        }();
+
+        return level;
+    }
+
+    char const *PixelConversion::simd_level_name(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::SSE2:
+                return "SSE2";
+            case SimdLevel::AVX2:
+                return "AVX2";
+            case SimdLevel::NEON:
+                return "NEON";
+            default:
+                return "scalar";
+        }
+    }
+
+    void PixelConversion::yuyv_to_mono8(uint8_t const *src, size_t srcStep,
+                                        uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = yuyv_to_mono8_kernel(simd_level());
+
+        yuyv_to_mono8_image(kernel, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::yuyv_to_mono8(SimdLevel level, uint8_t const *src, size_t srcStep,
+                                        uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        yuyv_to_mono8_image(yuyv_to_mono8_kernel(level), src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::yuyv_to_uyvy(uint8_t const *src, size_t srcStep,
+                                       uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = yuyv_to_uyvy_kernel(simd_level());
+
+        yuyv_to_uyvy_image(kernel, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::yuyv_to_uyvy(SimdLevel level, uint8_t const *src, size_t srcStep,
+                                       uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        yuyv_to_uyvy_image(yuyv_to_uyvy_kernel(level), src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::yuv422_to_rgb(YuvToRgb const &conversion, uint8_t const *src, size_t srcStep,
+                                        uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = yuv422_to_rgb_kernel(simd_level());
+
+        yuv422_to_rgb_image(kernel, conversion, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::yuv422_to_rgb(SimdLevel level, YuvToRgb const &conversion, uint8_t const *src,
+                                        size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        yuv422_to_rgb_image(yuv422_to_rgb_kernel(level), conversion, src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::bayer_to_rgb(BayerPattern pattern, RgbOrder order, uint8_t const *src, size_t srcStep,
+                                       uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = bayer_kernel(simd_level());
+
+        auto target = order == RgbOrder::RGB ? BayerTarget::RGB : BayerTarget::BGR;
+        bayer_image(kernel, pattern, target, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::bayer_to_rgb(SimdLevel level, BayerPattern pattern, RgbOrder order, uint8_t const *src,
+                                       size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        auto target = order == RgbOrder::RGB ? BayerTarget::RGB : BayerTarget::BGR;
+        bayer_image(bayer_kernel(level), pattern, target, src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::bayer_to_mono8(BayerPattern pattern, uint8_t const *src, size_t srcStep,
+                                         uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = bayer_kernel(simd_level());
+
+        bayer_image(kernel, pattern, BayerTarget::MONO8, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::bayer_to_mono8(SimdLevel level, BayerPattern pattern, uint8_t const *src, size_t srcStep,
+                                         uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        bayer_image(bayer_kernel(level), pattern, BayerTarget::MONO8, src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::raw_to_16(RawFormat format, uint8_t const *src, size_t srcStep,
+                                    uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const kernel = raw_kernel(simd_level());
+
+        raw_to_16_image(kernel, normalized(format), src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::raw_to_16(SimdLevel level, RawFormat format, uint8_t const *src, size_t srcStep,
+                                    uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        raw_to_16_image(raw_kernel(level), normalized(format), src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+    void PixelConversion::raw_to_8(RawFormat format, RawWindow window, uint8_t const *src, size_t srcStep,
+                                   uint8_t *dst, size_t dstStep, int width, int height) {
+        static auto const unpack = raw_kernel(simd_level());
+        static auto const windowing = window_kernel(simd_level());
+
+        raw_to_8_image(unpack, windowing, normalized(format), window, src, srcStep, dst, dstStep, width, height);
+    }
+
+    bool PixelConversion::raw_to_8(SimdLevel level, RawFormat format, RawWindow window, uint8_t const *src,
+                                   size_t srcStep, uint8_t *dst, size_t dstStep, int width, int height) {
+        if (!is_supported(level)) return false;
+
+        raw_to_8_image(raw_kernel(level), window_kernel(level), normalized(format), window,
+                       src, srcStep, dst, dstStep, width, height);
+
+        return true;
+    }
+
+}  // namespace lirs
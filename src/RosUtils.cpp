@@ -0,0 +1,86 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#include "lirs_ros_video_streaming/RosUtils.hpp"
+
+#include <boost/assign/list_of.hpp>
+
+#include <sensor_msgs/image_encodings.h>
+
+namespace lirs {
+    namespace ros_utils {
+
+        sensor_msgs::CameraInfo defaultCameraInfoFrom(sensor_msgs::ImagePtr const &img) {
+            sensor_msgs::CameraInfo cam_info_msg;
+            cam_info_msg.header.frame_id = img->header.frame_id;
+            cam_info_msg.width = img->width;
+            cam_info_msg.height = img->height;
+            cam_info_msg.distortion_model = "plumb_bob";
+            cam_info_msg.D.resize(5, 0.0);
+            cam_info_msg.K = boost::assign::list_of(1.0)(0.0)(img->width / 2.0)
+                    (0.0)(1.0)(img->height / 2.0)
+                    (0.0)(0.0)(1.0);
+            cam_info_msg.R = boost::assign::list_of(1.0)(0.0)(0.0)
+                    (0.0)(1.0)(0.0)
+                    (0.0)(0.0)(1.0);
+            cam_info_msg.P = boost::assign::list_of(1.0)(0.0)(img->width / 2.0)(0.0)
+                    (0.0)(1.0)(img->height / 2.0)(0.0)
+                    (0.0)(0.0)(1.0)(0.0);
+            return cam_info_msg;
+        }
+
+        sensor_msgs::ImagePtr convertedImageMessageFrom(std::string const &frameId, std::string const &imageFormat,
+                                                        lirs::VideoCapture const &capture) {
+
+            auto imageMsg = boost::make_shared<sensor_msgs::Image>();
+            imageMsg->header.frame_id = frameId;
+            imageMsg->width = static_cast<uint32_t >(capture.Get(lirs::CaptureParam::FRAME_WIDTH));
+            imageMsg->height = static_cast<uint32_t >(capture.Get(lirs::CaptureParam::FRAME_HEIGHT));
+            imageMsg->is_bigendian = 0;
+            imageMsg->encoding = imageFormat;
+
+            auto pixelSize = sensor_msgs::image_encodings::numChannels(imageFormat)
+                             * sensor_msgs::image_encodings::bitDepth(imageFormat) / 8;
+
+            imageMsg->step = imageMsg->width * static_cast<uint32_t >(pixelSize);
+            imageMsg->data.resize(imageMsg->step * imageMsg->height);
+
+            return imageMsg;
+        }
+
+        void publishShared(image_transport::CameraPublisher const &publisher,
+                           sensor_msgs::CameraInfo const &cameraInfoMsg,
+                           sensor_msgs::ImagePtr const &imageMsg, ros::Time const &stamp) {
+            auto sharedCameraInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(cameraInfoMsg);
+
+            imageMsg->header.stamp = stamp;
+            sharedCameraInfoMsg->header.stamp = stamp;
+            sharedCameraInfoMsg->header.frame_id = imageMsg->header.frame_id;
+
+            publisher.publish(imageMsg, sharedCameraInfoMsg);
+        }
+
+    }  // namespace ros_utils
+}  // namespace lirs
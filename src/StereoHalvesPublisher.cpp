@@ -0,0 +1,120 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+#include "lirs_ros_video_streaming/StereoHalvesPublisher.hpp"
+
+namespace lirs {
+    namespace ros_utils {
+
+        /* YUV 4:2:2 pixel size in bytes (the halves are split by columns) */
+        constexpr auto YUV422_PIXEL_SIZE = size_t{2};
+
+    }  // namespace ros_utils
+
+    StereoHalvesPublisher::StereoHalvesPublisher(ros::NodeHandle const &nodeHandle,
+                                                 image_transport::ImageTransport &imageTransport,
+                                                 std::string const &cameraName, std::string const &frameId,
+                                                 std::string const &imageFormat,
+                                                 std::array<std::string, 2> const &cameraInfoUrls,
+                                                 lirs::VideoCapture const &capture, bool isZeroCopy,
+                                                 ros_utils::SubscriberCallbacks const &callbacks,
+                                                 ConvertCallback convert)
+            : convert_{std::move(convert)} {
+
+        auto const names = std::array<std::string, 2>{"left", "right"};
+
+        auto const width = static_cast<uint32_t>(capture.Get(lirs::CaptureParam::FRAME_WIDTH)) / 2;
+
+        for (auto i = size_t{0}; i < halves_.size(); ++i) {
+            auto &half = halves_[i];
+
+            half.imageMsg = ros_utils::convertedImageMessageFrom(frameId, imageFormat, capture);
+            half.imageMsg->step = half.imageMsg->step / half.imageMsg->width * width;
+            half.imageMsg->width = width;
+            half.imageMsg->data.resize(half.imageMsg->step * half.imageMsg->height);
+
+            half.offset = i * width * ros_utils::YUV422_PIXEL_SIZE;
+
+            // each half is calibrated as a separate camera (e.g. left/set_camera_info service)
+            half.cameraInfoManager = std::make_unique<camera_info_manager::CameraInfoManager>(
+                    ros::NodeHandle{nodeHandle, names[i]}, names[i] + "_" + cameraName, cameraInfoUrls[i]);
+            half.cameraInfoMsg = half.cameraInfoManager->getCameraInfo();
+
+            if (half.cameraInfoMsg.distortion_model.empty()) {
+                half.cameraInfoMsg = ros_utils::defaultCameraInfoFrom(half.imageMsg);
+                half.cameraInfoManager->setCameraInfo(half.cameraInfoMsg);
+            }
+
+            half.publisher = imageTransport.advertiseCamera(names[i] + "/image_raw", 10, callbacks.onImageConnect,
+                                                            callbacks.onImageDisconnect, callbacks.onConnect,
+                                                            callbacks.onDisconnect);
+
+            if (isZeroCopy) {
+                half.imagePool = std::make_unique<ros_utils::ImageMessagePool>(*half.imageMsg);
+            }
+        }
+    }
+
+    bool StereoHalvesPublisher::UpdateSubscribers() {
+        auto hasSubscribers = false;
+
+        for (auto &half : halves_) {
+            half.hasSubscribers = half.publisher.getNumSubscribers() > 0;
+            hasSubscribers = hasSubscribers || half.hasSubscribers;
+        }
+
+        return hasSubscribers;
+    }
+
+    void StereoHalvesPublisher::Convert(Frame const &frame, size_t srcStep) {
+        // halves are converted right from the strided views of the frame, i.e. the frame is read once
+        for (auto &half : halves_) {
+            if (!half.hasSubscribers) continue;
+
+            // previous message could still be held by the subscribers, thus is replaced with the released one
+            if (half.imagePool) {
+                half.imageMsg.reset();
+                half.imageMsg = half.imagePool->acquire();
+            }
+
+            auto srcSize = frame.size() > half.offset ? frame.size() - half.offset : 0;
+
+            convert_(frame.data() + half.offset, srcStep, srcSize, *half.imageMsg);
+        }
+    }
+
+    void StereoHalvesPublisher::Publish(ros::Time const &stamp) {
+        for (auto &half : halves_) {
+            if (!half.hasSubscribers) continue;
+
+            if (half.imagePool) {
+                ros_utils::publishShared(half.publisher, half.cameraInfoMsg, half.imageMsg, stamp);
+            } else {
+                half.publisher.publish(*half.imageMsg, half.cameraInfoMsg, stamp);
+            }
+        }
+    }
+
+}  // namespace lirs
@@ -0,0 +1,146 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/StereoPairing.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lirs {
+
+    namespace {
+
+        size_t indexOf(StereoSide side) {
+            return static_cast<size_t>(side);
+        }
+
+        std::chrono::nanoseconds absolute(std::chrono::nanoseconds duration) {
+            return duration < std::chrono::nanoseconds::zero() ? -duration : duration;
+        }
+
+    }  // namespace
+
+    StereoPairing::StereoPairing(std::chrono::nanoseconds tolerance, size_t maxPendingFrames)
+            : tolerance_{absolute(tolerance)}, maxPendingFrames_{std::max(maxPendingFrames, size_t{1})} {}
+
+    std::optional<StereoPair> StereoPairing::Push(StereoSide side, Frame frame) {
+        auto const index = indexOf(side);
+        auto const otherIndex = 1 - index;
+
+        // sequence numbers are counted by each driver, thus gaps are checked per camera
+        if (auto &last = lastSequence_[index]; last && frame.sequence() > *last + 1) {
+            stats_.dropped[index] += frame.sequence() - *last - 1;
+        }
+
+        lastSequence_[index] = frame.sequence();
+
+        auto &others = pending_[otherIndex];
+        auto const captured = frame.timestamp();
+
+        // closest frame of the other camera within the tolerance (frames are in the capture order)
+        auto mate = others.end();
+
+        for (auto it = others.begin(); it != others.end(); ++it) {
+            auto distance = absolute(it->timestamp() - captured);
+
+            if (distance > tolerance_) continue;
+
+            if (mate == others.end() || distance < absolute(mate->timestamp() - captured)) {
+                mate = it;
+            }
+        }
+
+        auto const isPaired = mate != others.end();
+
+        // frames captured before the mate (or too early to be paired) are never paired
+        auto discardedEnd = isPaired
+                            ? mate
+                            : std::find_if(others.begin(), others.end(), [&](Frame const &other) {
+                                  return other.timestamp() >= captured - tolerance_;
+                              });
+
+        stats_.unpaired[otherIndex] += static_cast<uint64_t>(std::distance(others.begin(), discardedEnd));
+        others.erase(others.begin(), discardedEnd);
+
+        if (!isPaired) {
+            auto &own = pending_[index];
+
+            own.push_back(std::move(frame));
+
+            if (own.size() > maxPendingFrames_) {
+                own.pop_front();
+                ++stats_.unpaired[index];
+            }
+
+            return std::nullopt;
+        }
+
+        auto other = std::move(others.front());  // mate is the first one left
+        others.pop_front();
+
+        auto pair = side == StereoSide::LEFT ? StereoPair{std::move(frame), std::move(other), {}}
+                                             : StereoPair{std::move(other), std::move(frame), {}};
+
+        pair.skew = pair.right.timestamp() - pair.left.timestamp();
+
+        // both images are published with the identical stamp
+        auto stamp = pair.left.timestamp() + pair.skew / 2;
+
+        pair.left.stamp(FrameInfo{pair.left.size(), stamp, pair.left.sequence(), pair.left.flags()});
+        pair.right.stamp(FrameInfo{pair.right.size(), stamp, pair.right.sequence(), pair.right.flags()});
+
+        ++stats_.pairs;
+        stats_.skewSum += absolute(pair.skew);
+        stats_.maxSkew = std::max(stats_.maxSkew, absolute(pair.skew));
+
+        return {std::move(pair)};
+    }
+
+    void StereoPairing::Reset() {
+        for (auto &pending : pending_) {
+            pending.clear();
+        }
+
+        lastSequence_ = {};
+    }
+
+    StereoPairingStats const &StereoPairing::stats() const {
+        return stats_;
+    }
+
+    void StereoPairing::resetStats() {
+        stats_ = StereoPairingStats{};
+    }
+
+    size_t StereoPairing::pendingCount(StereoSide side) const {
+        return pending_[indexOf(side)].size();
+    }
+
+    std::chrono::nanoseconds StereoPairing::tolerance() const {
+        return tolerance_;
+    }
+
+}  // namespace lirs
@@ -0,0 +1,183 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+
+#include "lirs_ros_video_streaming/CameraStreamer.hpp"
+#include "lirs_ros_video_streaming/CaptureReactor.hpp"
+#include "lirs_ros_video_streaming/StereoPairing.hpp"
+#include "lirs_ros_video_streaming/PixelConversion.hpp"
+
+namespace lirs {
+    namespace ros_utils {
+
+        /* defaults */
+        constexpr auto DEFAULT_SYNC_TOLERANCE = 10.0;  // ms
+        constexpr auto DEFAULT_PAIRING_REPORT_PERIOD = 10.0;  // seconds
+
+        /* node shutdown is checked between the polls */
+        constexpr auto STEREO_POLL_TIMEOUT = std::chrono::milliseconds{100};
+
+        static void reportPairing(lirs::StereoPairingStats const &stats) {
+            auto const left = static_cast<size_t>(lirs::StereoSide::LEFT);
+            auto const right = static_cast<size_t>(lirs::StereoSide::RIGHT);
+
+            using Milliseconds = std::chrono::duration<double, std::milli>;
+
+            auto meanSkew = stats.pairs > 0 ? Milliseconds{stats.skewSum}.count() / static_cast<double>(stats.pairs)
+                                            : 0.0;
+            auto maxSkew = Milliseconds{stats.maxSkew}.count();
+
+            ROS_INFO_STREAM("Stereo pairs: " << stats.pairs << ", skew (ms): mean = " << meanSkew << ", max = "
+                                             << maxSkew << ", unpaired: " << stats.unpaired[left] << " left, "
+                                             << stats.unpaired[right] << " right, dropped by the drivers: "
+                                             << stats.dropped[left] << " left, " << stats.dropped[right]
+                                             << " right");
+        }
+
+    }  // namespace ros_utils
+}  // namespace lirs
+
+/*
+ * Captures stereo pair in one process: left and right cameras are configured by the video_streamer parameters
+ * in the ~left and ~right namespaces and published in the namespaces named by their camera_name parameters
+ * (left and right by default) as image_raw, camera_info, etc.
+ * Frames are paired by the driver timestamps (within ~sync_tolerance ms), both images of the pair are published
+ * with the identical stamp (i.e. exact time synchronization of the subscribers), unpaired frames are discarded.
+ */
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "lirs_ros_stereo_streaming");
+
+    ros::NodeHandle nodeHandle;
+    ros::NodeHandle nodeHandle_{"~"};
+
+    double syncTolerance;
+    double reportPeriod;
+
+    nodeHandle_.param("sync_tolerance", syncTolerance, lirs::ros_utils::DEFAULT_SYNC_TOLERANCE);
+    nodeHandle_.param("pairing_report_period", reportPeriod, lirs::ros_utils::DEFAULT_PAIRING_REPORT_PERIOD);
+
+    if (syncTolerance < 0.0) {
+        ROS_ERROR_STREAM("Invalid sync tolerance: " << syncTolerance << " ms");
+        return -1;
+    }
+
+    lirs::StereoPairing pairing{std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::milli>{syncTolerance})};
+
+    // streamers outlive the reactor referencing their captures
+    std::unique_ptr<lirs::CameraStreamer> streamers[2];
+
+    lirs::CaptureReactor reactor;
+
+    if (!reactor.IsOpened()) {
+        ROS_ERROR_STREAM("Couldn't create the capture reactor");
+        return -1;
+    }
+
+    for (auto side : {lirs::StereoSide::LEFT, lirs::StereoSide::RIGHT}) {
+        auto name = std::string{side == lirs::StereoSide::LEFT ? "left" : "right"};
+        auto paramHandle = ros::NodeHandle{nodeHandle_, name};
+
+        // shared buffers are dequeued by the streamer itself, i.e. not by the reactor
+        if (std::string dmabufSocket; paramHandle.getParam("dmabuf_socket", dmabufSocket) && !dmabufSocket.empty()) {
+            ROS_ERROR_STREAM("Buffers sharing is not supported by the stereo node (" << name << " camera)");
+            return -1;
+        }
+
+        // captures are registered with the reactor for good, i.e. streaming is never paused
+        if (bool isLazy; paramHandle.getParam("lazy_streaming", isLazy) && isLazy) {
+            ROS_ERROR_STREAM("Lazy streaming is not supported by the stereo node (" << name << " camera)");
+            return -1;
+        }
+
+        // topics are named as by the video_streamer nodes of stereo.launch (camera name is the namespace)
+        std::string cameraName;
+        paramHandle.param("camera_name", cameraName, name);
+
+        auto topicHandle = ros::NodeHandle{nodeHandle, cameraName, ros::M_string{{"image", "image_raw"}}};
+
+        auto &streamer = streamers[static_cast<size_t>(side)];
+        streamer = std::make_unique<lirs::CameraStreamer>(topicHandle, paramHandle);
+
+        if (!streamer->IsStreaming()) {
+            ROS_ERROR_STREAM("Couldn't start " << name << " camera");
+            return -1;
+        }
+
+        // frames are released right away if no one is subscribed to the camera
+        reactor.Add(streamer->capture(), [&pairing, &streamers, side](lirs::Frame &&frame) {
+            auto pair = pairing.Push(side, std::move(frame));
+
+            if (!pair) return;
+
+            auto &left = *streamers[static_cast<size_t>(lirs::StereoSide::LEFT)];
+            auto &right = *streamers[static_cast<size_t>(lirs::StereoSide::RIGHT)];
+
+            if (left.UpdateSubscribers()) {
+                left.Publish(std::move(pair->left));
+            }
+
+            if (right.UpdateSubscribers()) {
+                right.Publish(std::move(pair->right));
+            }
+        });
+    }
+
+    // ROS callbacks are served in the background, thus publishing is driven by the frame arrival only
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    ROS_INFO_STREAM("Pairing stereo frames within " << syncTolerance << " ms, pixel conversion: "
+                                                    << lirs::PixelConversion::simd_level_name(
+                                                            lirs::PixelConversion::simd_level()));
+
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (nodeHandle.ok()) {
+        reactor.Poll(lirs::ros_utils::STEREO_POLL_TIMEOUT);
+
+        // the other camera's frames could not be paired anymore
+        if (reactor.captureCount() < 2) {
+            ROS_ERROR_STREAM("Stereo camera is lost");
+            return -1;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        if (reportPeriod > 0.0 && now - lastReport >= std::chrono::duration<double>{reportPeriod}) {
+            lirs::ros_utils::reportPairing(pairing.stats());
+            pairing.resetStats();
+            lastReport = now;
+        }
+    }
+
+    spinner.stop();
+}
@@ -27,10 +27,12 @@
  */
 
 #include "lirs_ros_video_streaming/V4L2VideoCapture.hpp"
+#include "lirs_ros_video_streaming/MemoryCopy.hpp"
 
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <cstdint>
@@ -44,14 +46,27 @@ namespace lirs {
                              int frameRate, int bufferSize)
             : handle_{v4l2_constants::CLOSED_HANDLE},
               imageStep_{0}, imageSize_{0},
+              isCompressed_{false},
+              bufferType_{V4L2_BUF_TYPE_VIDEO_CAPTURE},
               device_{std::move(device)},
-              isStreaming_{false} {
+              isStreaming_{false},
+              isPaused_{false},
+              streamingSession_{std::make_shared<StreamingSession>(0u)},
+              isCapturing_{false},
+              captureQueueEvent_{v4l2_constants::CLOSED_HANDLE},
+              captureSpaceEvent_{v4l2_constants::CLOSED_HANDLE},
+              droppedFrames_{0} {
         params_ = {
                 {CaptureParam::FRAME_WIDTH,      width},
                 {CaptureParam::FRAME_HEIGHT,     height},
                 {CaptureParam::FRAME_RATE,       frameRate},
                 {CaptureParam::V4L2_PIX_FMT,     v4l2PixFmt},
-                {CaptureParam::V4L2_BUFFERS_NUM, bufferSize}
+                {CaptureParam::V4L2_BUFFERS_NUM, bufferSize},
+                {CaptureParam::CAPTURE_QUEUE_SIZE, v4l2_defaults::DEFAULT_CAPTURE_QUEUE_SIZE},
+                {CaptureParam::OVERFLOW_POLICY, static_cast<int>(OverflowPolicy::DROP_OLDEST)},
+                {CaptureParam::LATEST_FRAME_ONLY, 0},
+                {CaptureParam::EXPORT_DMABUF, 0},
+                {CaptureParam::MEMORY_TYPE, static_cast<int>(MemoryType::MMAP)}
         };
 
         handle_ = V4L2Utils::open_device(device_);  // acquire resource
@@ -70,6 +85,8 @@ namespace lirs {
 
         if (IsStreaming()) return true; // ALREADY STREAMING
 
+        if (IsPaused()) return ResumeStreaming(); // FORMAT AND BUFFERS ARE KEPT
+
         if (!checkSupportedCapabilities()) return false; // UNSUPPORTED CAPABILITIES ERROR
 
         if (!negotiateFormat()) return false;  // FORMAT NEGOTIATION ERROR
@@ -81,7 +98,14 @@ namespace lirs {
             return false; // BUFFERS ALLOCATION ERROR
         }
 
-        return enableStreaming();
+        if (!enableStreaming()) return false;  // STREAMON ERROR
+
+        if (Get(CaptureParam::CAPTURE_QUEUE_SIZE) > 0 && !startCaptureThread()) {
+            StopStreaming();
+            return false;  // CAPTURE THREAD ERROR
+        }
+
+        return true;
     }
 
     bool V4L2Capture::StopStreaming() {
@@ -89,21 +113,52 @@ namespace lirs {
             return false; // CLOSED HANDLE ERROR
         }
 
-        if (!IsStreaming()) {
+        if (!IsStreaming() && !IsPaused()) {
             return true; // NOT STREAMING
         }
 
-        if (!disableSteaming()) {
+        if (IsStreaming() && !disableSteaming()) {
             return false;  // CANNOT STOP STREAMING
         };
 
         cleanupInternalBuffers();
 
+        isPaused_ = false;
+
+        return true;
+    }
+
+    bool V4L2Capture::PauseStreaming() {
+        if (!IsStreaming()) return IsPaused(); // NOT STREAMING
+
+        if (!disableSteaming()) return false;  // CANNOT STOP STREAMING
+
+        isPaused_ = true;
+
+        return true;
+    }
+
+    bool V4L2Capture::ResumeStreaming() {
+        if (!IsPaused()) return IsStreaming(); // NOT PAUSED
+
+        if (!enableStreaming()) return false;  // STREAMON ERROR
+
+        isPaused_ = false;
+
+        if (Get(CaptureParam::CAPTURE_QUEUE_SIZE) > 0 && !startCaptureThread()) {
+            StopStreaming();
+            return false;  // CAPTURE THREAD ERROR
+        }
+
         return true;
     }
 
+    bool V4L2Capture::IsPaused() const {
+        return isPaused_;
+    }
+
     bool V4L2Capture::Set(CaptureParam param, int value) {
-        if (IsStreaming()) return false;  // no change of params while streaming
+        if (IsStreaming() || IsPaused()) return false;  // no change of params while streaming (or paused)
 
         // TODO (Ramil Safin): Add parameters validation.
         switch (param) {
@@ -112,6 +167,29 @@ namespace lirs {
                     return false;
                 }
                 break;
+            case CaptureParam::CAPTURE_QUEUE_SIZE:
+                if (!V4L2Utils::is_in_range_inclusive(0, v4l2_constants::V4L2_MAX_BUFFER_SIZE, value)) {
+                    return false;
+                }
+                break;
+            case CaptureParam::OVERFLOW_POLICY:
+                if (!V4L2Utils::is_in_range_inclusive(static_cast<int>(OverflowPolicy::DROP_OLDEST),
+                                                      static_cast<int>(OverflowPolicy::BLOCK), value)) {
+                    return false;
+                }
+                break;
+            case CaptureParam::MEMORY_TYPE:
+                if (!V4L2Utils::is_in_range_inclusive(static_cast<int>(MemoryType::MMAP),
+                                                      static_cast<int>(MemoryType::USERPTR), value)) {
+                    return false;
+                }
+                break;
+            case CaptureParam::LATEST_FRAME_ONLY:
+            case CaptureParam::EXPORT_DMABUF:
+                if (!V4L2Utils::is_in_range_inclusive(0, 1, value)) {
+                    return false;
+                }
+                break;
             default:
                 break;
         }
@@ -125,6 +203,8 @@ namespace lirs {
     }
 
     std::optional<Frame> V4L2Capture::ReadFrame() {
+        if (isCaptureThreadEnabled()) return popCapturedFrame();
+
         if (IsStreaming()) {
             if (V4L2Utils::v4l2_is_readable(handle_)) {
                 return internalReadFrame();
@@ -133,17 +213,188 @@ namespace lirs {
         return std::nullopt;
     }
 
+    bool V4L2Capture::ReadFrame(Frame &frame) {
+        if (isCaptureThreadEnabled()) {
+            if (auto captured = popCapturedFrame()) {
+                frame.assign(*captured);
+                return true;
+            }
+            return false;
+        }
+
+        if (!IsStreaming() || !V4L2Utils::v4l2_is_readable(handle_)) return false;
+
+        if (auto buffer = dequeueReadyBuffer()) {
+            copyPlanes(*buffer, frame.allocate(buffer->payloadSize()));
+            describePlanes(frame, *buffer);
+            frame.stamp(frameInfoFrom(*buffer));
+            enqueueBuffer(*buffer);
+            return true;
+        }
+
+        return false;
+    }
+
+    std::optional<FrameInfo> V4L2Capture::ReadInto(uint8_t *dst, size_t capacity) {
+        if (isCaptureThreadEnabled()) {
+            auto captured = popCapturedFrame();
+
+            if (!captured) return std::nullopt;
+
+            if (captured->size() > capacity) {
+                std::cerr << "ERROR: Destination of " << capacity << " bytes is too small for the frame of "
+                          << captured->size() << " bytes\n";
+                return std::nullopt;
+            }
+
+            std::memcpy(dst, captured->data(), captured->size());
+
+            return {captured->info()};
+        }
+
+        if (!IsStreaming() || !V4L2Utils::v4l2_is_readable(handle_)) return std::nullopt;
+
+        if (auto buffer = dequeueReadyBuffer()) {
+            auto size = buffer->payloadSize();
+
+            if (size > capacity) {
+                std::cerr << "ERROR: Destination of " << capacity << " bytes is too small for the frame of "
+                          << size << " bytes\n";
+                enqueueBuffer(*buffer);
+                return std::nullopt;
+            }
+
+            copyPlanes(*buffer, dst);
+
+            auto info = frameInfoFrom(*buffer);
+            enqueueBuffer(*buffer);
+
+            return {info};
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<Frame> V4L2Capture::ReadFrameCopy() {
+        if (isCaptureThreadEnabled()) return popCapturedFrame();  // already copied
+
+        if (IsStreaming() && V4L2Utils::v4l2_is_readable(handle_)) {
+            return internalReadFrameCopy();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<DmaBufFrame> V4L2Capture::ReadDmaBufFrame() {
+        if (!Get(CaptureParam::EXPORT_DMABUF) || isCaptureThreadEnabled()) return std::nullopt;
+
+        if (!IsStreaming() || !V4L2Utils::v4l2_is_readable(handle_)) return std::nullopt;
+
+        auto buffer = dequeueReadyBuffer();
+
+        if (!buffer) return std::nullopt;
+
+        DmaBufFrame frame{borrowFrame(*buffer), buffer->v4l2.index, {}, {}};
+
+        for (auto const &plane : internalBuffers_[buffer->v4l2.index]->planes) {
+            frame.fds.push_back(plane.dmabufFd);
+        }
+
+        for (auto const &plane : imagePlanes_) {
+            // the only plane is as large as the payload (e.g. compressed frame)
+            auto size = imagePlanes_.size() == 1 ? buffer->payloadSize(plane.memoryPlane) : plane.size;
+
+            auto offset = buffer->dataOffset(plane.memoryPlane) + plane.offset;
+
+            frame.planes.push_back(V4L2ImagePlane{plane.memoryPlane, offset, plane.step, size});
+        }
+
+        return {std::move(frame)};
+    }
+
+    std::optional<Frame> V4L2Capture::ReadReadyFrame() {
+        if (isCaptureThreadEnabled()) return takeCapturedFrame();
+
+        if (IsStreaming()) return internalReadFrame();
+
+        return std::nullopt;
+    }
+
+    size_t V4L2Capture::DiscardReadyFrames() {
+        if (!IsStreaming()) return 0;
+
+        auto discarded = size_t{0};
+
+        if (isCaptureThreadEnabled()) {
+            for (eventfd_t counter{}; eventfd_read(captureQueueEvent_, &counter) != V4L2Utils::ERROR_CODE;) {
+                if (captureQueue_->TryPop()) ++discarded;
+            }
+
+            notifyCaptureQueueSpace();
+
+            return discarded;
+        }
+
+        while (V4L2Utils::v4l2_is_readable(handle_, {0, 0})) {
+            auto buffer = dequeueBuffer();
+
+            if (!buffer) break;
+
+            enqueueBuffer(*buffer);
+            ++discarded;
+        }
+
+        return discarded;
+    }
+
+    int V4L2Capture::eventHandle() const {
+        if (!IsStreaming()) return v4l2_constants::CLOSED_HANDLE;
+
+        return isCaptureThreadEnabled() ? captureQueueEvent_ : handle_;
+    }
+
+    std::optional<Frame> V4L2Capture::internalReadFrameCopy() {
+        if (auto buffer = dequeueReadyBuffer()) {
+            auto size = buffer->payloadSize();
+
+            auto frame = framePool_->Acquire(size);
+
+            if (!frame) {
+                frame.emplace(nullptr, 0);
+                frame->allocate(size);  // pool is exhausted, fallback to the heap
+            }
+
+            copyPlanes(*buffer, frame->data());
+            describePlanes(*frame, *buffer);
+
+            frame->stamp(frameInfoFrom(*buffer));
+
+            enqueueBuffer(*buffer);
+
+            return frame;
+        }
+
+        return std::nullopt;
+    }
+
     bool V4L2Capture::allocateInternalBuffers() {
+        auto const isUserMemory = v4l2Memory() == V4L2_MEMORY_USERPTR;
+
+        if (isUserMemory && Get(CaptureParam::EXPORT_DMABUF)) {
+            std::cerr << "ERROR: USERPTR buffers could not be exported\n";
+            return false;
+        }
+
         v4l2_requestbuffers requestBuffers{};
         requestBuffers.count = static_cast<uint32_t >(Get(CaptureParam::V4L2_BUFFERS_NUM));
-        requestBuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        requestBuffers.memory = V4L2_MEMORY_MMAP;
+        requestBuffers.type = bufferType_;
+        requestBuffers.memory = v4l2Memory();
 
         // enqueue requested buffers to the driver's queue
 
         if (V4L2Utils::xioctl(handle_, VIDIOC_REQBUFS, &requestBuffers) == V4L2Utils::ERROR_CODE) {
             if (errno == EINVAL) {
-                std::cerr << "ERROR: Device does not support memory mapping - " << strerror(errno) << '\n';
+                std::cerr << "ERROR: Device does not support " << (isUserMemory ? "user pointer" : "memory mapping")
+                          << " - " << strerror(errno) << '\n';
             } else {
                 std::cerr << "ERROR: VIDIOC_REQBUFS - " << strerror(errno) << '\n';
             }
@@ -159,27 +410,72 @@ namespace lirs {
 
         internalBuffers_.reserve(requestBuffers.count);
 
-        v4l2_buffer buffer{};
-        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buffer.memory = V4L2_MEMORY_MMAP;
+        if (isUserMemory) {
+            auto isLocked = true;
 
-        for (buffer.index = 0u; buffer.index < requestBuffers.count; ++buffer.index) {
-            if (V4L2Utils::xioctl(handle_, VIDIOC_QUERYBUF, &buffer) == V4L2Utils::ERROR_CODE) {
-                std::cerr << "ERROR: VIDIOC_QUERYBUF - " << strerror(errno) << '\n';
-                return false;
+            for (auto index = 0u; index < requestBuffers.count; ++index) {
+                auto const &mapping = internalBuffers_.emplace_back(std::make_shared<MappedBuffer>());
+
+                for (auto const &memoryPlane : memoryPlanes_) {
+                    auto plane = allocateUserPlane(memoryPlane.size, isLocked);
+
+                    if (!plane) return false;
+
+                    mapping->planes.push_back(*plane);
+                }
             }
 
-            auto bufferLength = buffer.length;
+            if (!isLocked) {
+                std::cerr << "WARNING: Capture buffers are not locked in memory (see RLIMIT_MEMLOCK)\n";
+            }
+        } else {
+            for (auto index = 0u; index < requestBuffers.count; ++index) {
+                V4L2Buffer buffer{bufferType_, V4L2_MEMORY_MMAP};
+                buffer.v4l2.index = index;
 
-            auto bufferData = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED,
-                                   handle_, buffer.m.offset);
+                if (V4L2Utils::xioctl(handle_, VIDIOC_QUERYBUF, &buffer.v4l2) == V4L2Utils::ERROR_CODE) {
+                    std::cerr << "ERROR: VIDIOC_QUERYBUF - " << strerror(errno) << '\n';
+                    return false;
+                }
 
-            if (bufferData == MAP_FAILED) {
-                std::cerr << "ERROR: Memory Mapping has failed - " << strerror(errno) << '\n';
-                return false;
+                // already mapped planes are unmapped on cleanup if mapping of the next one fails
+                auto const &mapping = internalBuffers_.emplace_back(std::make_shared<MappedBuffer>());
+
+                for (auto plane = size_t{0}; plane < buffer.planeCount(); ++plane) {
+                    auto bufferLength = buffer.length(plane);
+
+                    auto bufferData = mmap(nullptr, bufferLength, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                           handle_, buffer.memoryOffset(plane));
+
+                    if (bufferData == MAP_FAILED) {
+                        std::cerr << "ERROR: Memory Mapping has failed - " << strerror(errno) << '\n';
+                        return false;
+                    }
+
+                    mapping->planes.push_back(MappedBuffer::Plane{bufferData, bufferLength});
+
+                    if (Get(CaptureParam::EXPORT_DMABUF)) {
+                        auto fd = V4L2Utils::v4l2_export_buffer(handle_, bufferType_, index,
+                                                                static_cast<uint32_t>(plane));
+
+                        if (!fd) return false;
+
+                        mapping->planes.back().dmabufFd = *fd;
+                    }
+                }
             }
+        }
+
+        // capture queue (as rounded by the ring) and the frame being processed by the consumer are backed by the pool
+        auto poolCapacity = size_t{requestBuffers.count};
+
+        if (auto queueSize = Get(CaptureParam::CAPTURE_QUEUE_SIZE); queueSize > 0) {
+            poolCapacity += RingBuffer<Frame>::capacityFor(static_cast<size_t>(queueSize)) + 1;
+        }
 
-            internalBuffers_.emplace_back(bufferData, bufferLength);
+        if (!framePool_ || framePool_->bufferSize() != static_cast<size_t>(imageSize_)
+            || framePool_->capacity() != poolCapacity) {
+            framePool_ = std::make_unique<FramePool>(static_cast<size_t>(imageSize_), poolCapacity);
         }
 
         return true;
@@ -192,8 +488,8 @@ namespace lirs {
 
             v4l2_requestbuffers requestBuffers{};
             requestBuffers.count = uint32_t{0};
-            requestBuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            requestBuffers.memory = V4L2_MEMORY_MMAP;
+            requestBuffers.type = bufferType_;
+            requestBuffers.memory = v4l2Memory();
 
             if (V4L2Utils::xioctl(handle_, VIDIOC_REQBUFS, &requestBuffers) == V4L2Utils::ERROR_CODE) {
                 std::cerr << "ERROR: Cannot cleanup allocated buffers - " << strerror(errno) << '\n';
@@ -203,19 +499,29 @@ namespace lirs {
     }
 
     bool V4L2Capture::enableStreaming() {
-        v4l2_buffer buffer{};
-        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buffer.memory = V4L2_MEMORY_MMAP;
+        V4L2Buffer buffer{bufferType_, v4l2Memory()};
+
+        for (auto index = 0u; index < static_cast<uint32_t>(Get(CaptureParam::V4L2_BUFFERS_NUM)); ++index) {
+            buffer.v4l2.index = index;
+
+            // driver writes into the capture's memory
+            if (buffer.v4l2.memory == V4L2_MEMORY_USERPTR) {
+                auto const &mapping = internalBuffers_[index];
+
+                for (auto plane = size_t{0}; plane < mapping->planes.size(); ++plane) {
+                    buffer.setUserPointer(plane, mapping->planes[plane].rawDataPtr,
+                                          static_cast<uint32_t>(mapping->planes[plane].lengthBytes));
+                }
+            }
 
-        for (buffer.index = 0; buffer.index < static_cast<uint32_t>(Get(CaptureParam::V4L2_BUFFERS_NUM));
-             ++buffer.index) {
-            if (V4L2Utils::xioctl(handle_, VIDIOC_QBUF, &buffer) == V4L2Utils::ERROR_CODE) {
+            if (V4L2Utils::xioctl(handle_, VIDIOC_QBUF, &buffer.v4l2) == V4L2Utils::ERROR_CODE) {
                 std::cerr << "ERROR: VIDIOC_QBUF  - " << strerror(errno) << '\n';
                 return false;
             }
         }
 
-        if (V4L2Utils::xioctl(handle_, VIDIOC_STREAMON, &buffer.type) == V4L2Utils::ERROR_CODE) {
+        if (auto bufType = bufferType_;
+                V4L2Utils::xioctl(handle_, VIDIOC_STREAMON, &bufType) == V4L2Utils::ERROR_CODE) {
             std::cerr << "ERROR: Cannot enable streaming mode - " << strerror(errno) << '\n';
             return false;
         }
@@ -226,27 +532,54 @@ namespace lirs {
     }
 
     bool V4L2Capture::disableSteaming() {
-        if (auto bufType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        stopCaptureThread();
+
+        if (auto bufType = bufferType_;
                 V4L2Utils::xioctl(handle_, VIDIOC_STREAMOFF, &bufType) == V4L2Utils::ERROR_CODE) {
             std::cerr << "ERROR: Unable to stop streaming - " << strerror(errno) << '\n';
             return false;
         }
 
+        // STREAMOFF dequeues all buffers, outstanding leases must not enqueue them back
+        ++(*streamingSession_);
+
         isStreaming_ = false;
 
         return true;
     }
 
     bool V4L2Capture::negotiateFormat() {
-        if (V4L2Utils::v4l2_try_format(handle_, static_cast<uint32_t >(Get(CaptureParam::V4L2_PIX_FMT)),
-                                       Get(CaptureParam::FRAME_WIDTH), Get(CaptureParam::FRAME_HEIGHT))) {
+        auto const pixFmt = static_cast<uint32_t >(Get(CaptureParam::V4L2_PIX_FMT));
+
+        if (V4L2Utils::v4l2_try_format(handle_, pixFmt, Get(CaptureParam::FRAME_WIDTH),
+                                       Get(CaptureParam::FRAME_HEIGHT), bufferType_)) {
 
-            if (auto format = V4L2Utils::v4l2_set_format(handle_,
-                                                         static_cast<uint32_t >(Get(CaptureParam::V4L2_PIX_FMT)),
+            if (auto format = V4L2Utils::v4l2_set_format(handle_, pixFmt,
                                                          Get(CaptureParam::FRAME_WIDTH),
-                                                         Get(CaptureParam::FRAME_HEIGHT))) {
-                imageStep_ = format->fmt.pix.bytesperline;
-                imageSize_ = format->fmt.pix.sizeimage;
+                                                         Get(CaptureParam::FRAME_HEIGHT), bufferType_)) {
+                memoryPlanes_ = V4L2Utils::v4l2_plane_formats(*format);
+
+                if (memoryPlanes_.empty()) {
+                    std::cerr << "ERROR: Format of " << device_ << " has no planes\n";
+                    return false;
+                }
+
+                imagePlanes_ = V4L2Utils::v4l2_image_planes(pixFmt, Get(CaptureParam::FRAME_HEIGHT), memoryPlanes_);
+
+                if (imagePlanes_.size() > MAX_FRAME_PLANES) {
+                    std::cerr << "ERROR: Format of " << device_ << " has " << imagePlanes_.size() << " planes (up to "
+                              << MAX_FRAME_PLANES << " are supported)\n";
+                    return false;
+                }
+
+                imageStep_ = static_cast<int>(memoryPlanes_.front().step);
+                imageSize_ = 0;
+
+                for (auto const &plane : memoryPlanes_) {
+                    imageSize_ += static_cast<int>(plane.size);
+                }
+
+                isCompressed_ = V4L2Utils::v4l2_is_compressed_format(handle_, pixFmt, bufferType_);
                 return true;
             }
 
@@ -255,9 +588,55 @@ namespace lirs {
         return false;
     }
 
+    uint32_t V4L2Capture::v4l2Memory() const {
+        return static_cast<MemoryType>(Get(CaptureParam::MEMORY_TYPE)) == MemoryType::USERPTR ? V4L2_MEMORY_USERPTR
+                                                                                               : V4L2_MEMORY_MMAP;
+    }
+
+    std::optional<V4L2Capture::MappedBuffer::Plane> V4L2Capture::allocateUserPlane(size_t size, bool &isLocked) {
+        auto const hugePage = v4l2_user_memory::HUGE_PAGE_SIZE;
+        auto const length = (size + hugePage - 1) / hugePage * hugePage;
+
+        // reserved huge pages (hugetlbfs) are used if any
+        auto const protection = PROT_READ | PROT_WRITE;
+        auto data = mmap(nullptr, length, protection, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (data == MAP_FAILED) {
+            // otherwise region is aligned to the huge page, thus it could be backed by the transparent huge pages
+            auto reserved = mmap(nullptr, length + hugePage, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (reserved == MAP_FAILED) {
+                std::cerr << "ERROR: Cannot allocate capture buffer - " << strerror(errno) << '\n';
+                return std::nullopt;
+            }
+
+            auto const address = reinterpret_cast<uintptr_t>(reserved);
+            auto const aligned = (address + hugePage - 1) / hugePage * hugePage;
+
+            if (aligned > address) {
+                munmap(reserved, aligned - address);
+            }
+
+            if (auto tail = address + hugePage - aligned; tail > 0) {
+                munmap(reinterpret_cast<void *>(aligned + length), tail);
+            }
+
+            data = reinterpret_cast<void *>(aligned);
+
+            madvise(data, length, MADV_HUGEPAGE);
+        }
+
+        // locking faults in the pages, otherwise the driver does it on the first enqueue
+        if (mlock(data, length) == V4L2Utils::ERROR_CODE) {
+            isLocked = false;
+        }
+
+        return MappedBuffer::Plane{data, length};
+    }
+
     bool V4L2Capture::negotiateFrameRate() {
         auto num = 1u;
-        if (auto frameRate = V4L2Utils::v4l2_set_frame_rate(handle_, num, Get(CaptureParam::FRAME_RATE))) {
+        if (auto frameRate = V4L2Utils::v4l2_set_frame_rate(handle_, num, Get(CaptureParam::FRAME_RATE), bufferType_)) {
             params_[CaptureParam::FRAME_RATE] = frameRate->parm.capture.timeperframe.denominator;
             return true;
         }
@@ -267,9 +646,18 @@ namespace lirs {
 
     bool V4L2Capture::checkSupportedCapabilities() {
         // TODO (Ramil Safin): Cache queried capabilities.
-        auto requiredCapabilities = uint32_t{V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING};
+        auto requiredCapabilities = uint32_t{V4L2_CAP_STREAMING};
 
         if (auto caps = V4L2Utils::v4l2_query_capabilities(handle_)) {
+            auto bufferType = V4L2Utils::v4l2_capture_buffer_type(caps.value());
+
+            if (!bufferType) {
+                std::cerr << "ERROR: " << device_ << " does not support video capture\n";
+                return false;
+            }
+
+            bufferType_ = bufferType.value();
+
             return V4L2Utils::v4l2_check_input_capabilities(handle_)
                    && V4L2Utils::v4l2_check_capabilities(caps.value(), requiredCapabilities);
         }
@@ -277,16 +665,14 @@ namespace lirs {
         return true;
     }
 
-    std::optional<Frame> V4L2Capture::internalReadFrame() {
-        v4l2_buffer buffer{};
-        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buffer.memory = V4L2_MEMORY_MMAP;
+    std::optional<V4L2Capture::V4L2Buffer> V4L2Capture::dequeueBuffer() {
+        V4L2Buffer buffer{bufferType_, v4l2Memory()};
 
         int dequeryStatus{0};
 
         // dequery v4l2 buffers from the driver's outgoing queue
 
-        while ((dequeryStatus = V4L2Utils::xioctl(handle_, VIDIOC_DQBUF, &buffer)) < 0 && (errno == EINTR));
+        while ((dequeryStatus = V4L2Utils::xioctl(handle_, VIDIOC_DQBUF, &buffer.v4l2)) < 0 && (errno == EINTR));
 
         if (dequeryStatus < 0) {
             switch (errno) {
@@ -302,31 +688,320 @@ namespace lirs {
             }
         }
 
-        // skip corrupted v4l2 buffers
+        // skip corrupted v4l2 buffers (compressed frames are up to the image size), each plane is checked
 
-        if (buffer.flags & V4L2_BUF_FLAG_ERROR || buffer.bytesused != static_cast<uint32_t >(imageSize_)) {
-            std::cerr << "WARNING: Dequeued v4l2 buffer with size " << buffer.bytesused
-                      << '/' << imageSize_ << " (bytes) is corrupted\n";
+        auto isSizeValid = buffer.planeCount() == memoryPlanes_.size();
 
-            buffer.bytesused = 0;
+        for (auto plane = size_t{0}; isSizeValid && plane < buffer.planeCount(); ++plane) {
+            auto const size = buffer.payloadSize(plane);
+            auto const expectedSize = memoryPlanes_[plane].size;
 
-            if (V4L2Utils::xioctl(handle_, VIDIOC_QBUF, &buffer) == -1) {
-                std::cerr << "ERROR: VIDIOC_QBUF - " << strerror(errno) << '\n';
-            }
+            isSizeValid = isCompressed_ ? size > 0 && size <= expectedSize : size == expectedSize;
+        }
+
+        if (buffer.v4l2.flags & V4L2_BUF_FLAG_ERROR || !isSizeValid) {
+            std::cerr << "WARNING: Dequeued v4l2 buffer with size " << buffer.payloadSize()
+                      << '/' << imageSize_ << " (bytes) is corrupted\n";
+
+            enqueueBuffer(buffer);
 
             return std::nullopt;
         }
 
-        // TODO (Ramil Safin): Convert frame timestamp into absolute time.
+        return {buffer};
+    }
+
+    std::optional<V4L2Capture::V4L2Buffer> V4L2Capture::dequeueReadyBuffer() {
+        auto buffer = dequeueBuffer();
 
-        // copy buffer before querying it back
-        Frame frame{static_cast<uint8_t *>(internalBuffers_[buffer.index].rawDataPtr), buffer.bytesused};
+        if (!buffer || !Get(CaptureParam::LATEST_FRAME_ONLY)) return buffer;
 
-        if (V4L2Utils::xioctl(handle_, VIDIOC_QBUF, &buffer) == -1) {
+        // drain the driver's outgoing queue, stale buffers are enqueued back
+        while (V4L2Utils::v4l2_is_readable(handle_, {0, 0})) {
+            auto newer = dequeueBuffer();
+
+            if (!newer) break;
+
+            enqueueBuffer(*buffer);
+            ++droppedFrames_;
+
+            buffer = newer;
+        }
+
+        // all of the buffers were filled, the driver has been starved until the drained buffers were enqueued back
+        if (isStale(frameInfoFrom(*buffer)) &&
+            V4L2Utils::v4l2_is_readable(handle_, V4L2Utils::to_timeval(
+                    framePeriod() * v4l2_latest_frame::FRESH_FRAME_WAIT_PERIODS))) {
+            if (auto fresh = dequeueBuffer()) {
+                enqueueBuffer(*buffer);
+                ++droppedFrames_;
+
+                buffer = fresh;
+            }
+        }
+
+        return buffer;
+    }
+
+    bool V4L2Capture::enqueueBuffer(V4L2Buffer &buffer) {
+        buffer.resetBytesUsed();
+
+        if (V4L2Utils::xioctl(handle_, VIDIOC_QBUF, &buffer.v4l2) == V4L2Utils::ERROR_CODE) {
             std::cerr << "ERROR: VIDIOC_QBUF - " << strerror(errno) << '\n';
+            return false;
+        }
+
+        return true;
+    }
+
+    std::optional<Frame> V4L2Capture::internalReadFrame() {
+        if (auto buffer = dequeueReadyBuffer()) {
+            return borrowFrame(*buffer);
+        }
+
+        return std::nullopt;
+    }
+
+    Frame V4L2Capture::borrowFrame(V4L2Buffer const &buffer) {
+        auto const &mapping = internalBuffers_[buffer.v4l2.index];
+
+        Frame frame{mapping->data(0) + buffer.dataOffset(0), buffer.payloadSize(0), leaseBuffer(buffer)};
+
+        if (buffer.planeCount() == 1) {
+            describePlanes(frame, buffer);
+        } else {
+            // image planes reside in the separately mapped memory planes, frame's data is the first one
+            for (auto i = size_t{0}; i < imagePlanes_.size(); ++i) {
+                auto const &plane = imagePlanes_[i];
+                auto data = mapping->data(plane.memoryPlane) + buffer.dataOffset(plane.memoryPlane) + plane.offset;
+
+                frame.setExternalPlane(i, data, plane.step, plane.size);
+            }
+        }
+
+        frame.stamp(frameInfoFrom(buffer));
+
+        return frame;
+    }
+
+    bool V4L2Capture::startCaptureThread() {
+        captureQueueEvent_ = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (captureQueueEvent_ == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot create capture queue event - " << strerror(errno) << '\n';
+            captureQueueEvent_ = v4l2_constants::CLOSED_HANDLE;
+            return false;
+        }
+
+        captureSpaceEvent_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (captureSpaceEvent_ == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot create capture queue event - " << strerror(errno) << '\n';
+            captureSpaceEvent_ = v4l2_constants::CLOSED_HANDLE;
+
+            V4L2Utils::close_device(captureQueueEvent_);
+            captureQueueEvent_ = v4l2_constants::CLOSED_HANDLE;
+            return false;
+        }
+
+        captureQueue_ = std::make_unique<RingBuffer<Frame>>(static_cast<size_t>(Get(CaptureParam::CAPTURE_QUEUE_SIZE)));
+
+        isCapturing_ = true;
+        captureThread_ = std::thread{&V4L2Capture::captureLoop, this};
+
+        return true;
+    }
+
+    void V4L2Capture::stopCaptureThread() {
+        if (!isCaptureThreadEnabled()) return;
+
+        isCapturing_ = false;
+        notifyCaptureQueueSpace();  // capture thread could be blocked on the full queue
+        captureThread_.join();
+
+        captureQueue_.reset();
+
+        V4L2Utils::close_device(captureQueueEvent_);
+        captureQueueEvent_ = v4l2_constants::CLOSED_HANDLE;
+
+        V4L2Utils::close_device(captureSpaceEvent_);
+        captureSpaceEvent_ = v4l2_constants::CLOSED_HANDLE;
+    }
+
+    void V4L2Capture::captureLoop() {
+        while (isCapturing_) {
+            if (!V4L2Utils::v4l2_is_readable(handle_, {0, v4l2_capture_thread::POLL_TIMEOUT_MICROSECONDS})) {
+                continue;
+            }
+
+            if (auto frame = internalReadFrameCopy()) {
+                pushCapturedFrame(std::move(*frame));
+            }
         }
+    }
 
-        return {frame};
+    void V4L2Capture::pushCapturedFrame(Frame &&frame) {
+        auto policy = static_cast<OverflowPolicy>(Get(CaptureParam::OVERFLOW_POLICY));
+
+        while (!captureQueue_->TryPush(std::move(frame))) {
+            switch (policy) {
+                case OverflowPolicy::DROP_OLDEST:
+                    if (captureQueue_->TryPop()) {
+                        eventfd_t counter{};
+                        eventfd_read(captureQueueEvent_, &counter);  // consume dropped frame's notification
+                        ++droppedFrames_;
+                    }
+                    break;
+                case OverflowPolicy::DROP_NEWEST:
+                    ++droppedFrames_;
+                    return;
+                case OverflowPolicy::BLOCK:
+                    if (!isCapturing_) return;
+
+                    // waits for the consumer to pop a frame (notifications of the earlier pops are not lost)
+                    if (V4L2Utils::v4l2_is_readable(captureSpaceEvent_,
+                                                    {0, v4l2_capture_thread::POLL_TIMEOUT_MICROSECONDS})) {
+                        eventfd_t counter{};
+                        eventfd_read(captureSpaceEvent_, &counter);
+                    }
+                    break;
+            }
+        }
+
+        if (eventfd_write(captureQueueEvent_, 1) == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot notify about captured frame - " << strerror(errno) << '\n';
+        }
+    }
+
+    void V4L2Capture::notifyCaptureQueueSpace() {
+        if (static_cast<OverflowPolicy>(Get(CaptureParam::OVERFLOW_POLICY)) != OverflowPolicy::BLOCK) return;
+
+        if (eventfd_write(captureSpaceEvent_, 1) == V4L2Utils::ERROR_CODE) {
+            std::cerr << "ERROR: Cannot notify about capture queue space - " << strerror(errno) << '\n';
+        }
+    }
+
+    std::optional<Frame> V4L2Capture::popCapturedFrame() {
+        if (!V4L2Utils::v4l2_is_readable(captureQueueEvent_)) return std::nullopt;
+
+        return takeCapturedFrame();
+    }
+
+    std::optional<Frame> V4L2Capture::takeCapturedFrame() {
+        if (eventfd_t counter{}; eventfd_read(captureQueueEvent_, &counter) == V4L2Utils::ERROR_CODE) {
+            return std::nullopt;  // notification is consumed by the dropping capture thread
+        }
+
+        auto frame = captureQueue_->TryPop();
+
+        notifyCaptureQueueSpace();
+
+        if (!frame || !Get(CaptureParam::LATEST_FRAME_ONLY)) return frame;
+
+        // skip stale frames
+        for (eventfd_t counter{}; eventfd_read(captureQueueEvent_, &counter) != V4L2Utils::ERROR_CODE;) {
+            if (auto newer = captureQueue_->TryPop()) {
+                frame = std::move(newer);
+                ++droppedFrames_;
+            }
+        }
+
+        notifyCaptureQueueSpace();
+
+        // the capture queue was full, the capture thread has been dropping (or holding) the newer frames
+        if (isStale(frame->info()) &&
+            V4L2Utils::v4l2_is_readable(captureQueueEvent_, V4L2Utils::to_timeval(
+                    framePeriod() * v4l2_latest_frame::FRESH_FRAME_WAIT_PERIODS))) {
+            if (eventfd_t counter{}; eventfd_read(captureQueueEvent_, &counter) != V4L2Utils::ERROR_CODE) {
+                if (auto fresh = captureQueue_->TryPop()) {
+                    frame = std::move(fresh);
+                    ++droppedFrames_;
+                }
+
+                notifyCaptureQueueSpace();
+            }
+        }
+
+        return frame;
+    }
+
+    std::chrono::microseconds V4L2Capture::framePeriod() const {
+        auto frameRate = Get(CaptureParam::FRAME_RATE);
+
+        return frameRate > 0 ? std::chrono::microseconds{std::micro::den / frameRate} : std::chrono::microseconds{0};
+    }
+
+    bool V4L2Capture::isStale(FrameInfo const &info) const {
+        auto period = framePeriod();
+
+        if (period.count() == 0) return false;
+
+        auto age = std::chrono::system_clock::now().time_since_epoch() - info.timestamp;
+
+        return age > period * v4l2_latest_frame::STALE_FRAME_PERIODS;
+    }
+
+    FrameInfo V4L2Capture::frameInfoFrom(V4L2Buffer const &buffer) {
+        FrameInfo info{};
+        info.size = buffer.payloadSize();
+        info.sequence = buffer.v4l2.sequence;
+        info.flags = buffer.v4l2.flags;
+
+        if (V4L2Utils::v4l2_has_monotonic_timestamp(buffer.v4l2)) {
+            clockOffset_.update();
+            info.timestamp = clockOffset_.toSystemTime(V4L2Utils::v4l2_timestamp(buffer.v4l2));
+        } else {
+            // NOTE: Dequeue time is the best approximation for the unknown or copy timestamps.
+            info.timestamp = std::chrono::system_clock::now().time_since_epoch();
+        }
+
+        return info;
+    }
+
+    std::shared_ptr<void> V4L2Capture::leaseBuffer(V4L2Buffer const &buffer) {
+        auto handle = handle_;
+        auto session = streamingSession_;
+        auto sessionId = session->load();
+        auto mapping = internalBuffers_[buffer.v4l2.index];
+
+        // NOTE: Lease may outlive the capture, thus it shares only the required state
+        // (mapping is captured in order to keep the memory mapped until the frame is released).
+        return std::shared_ptr<void>{mapping->data(0), [handle, session, sessionId, mapping, buffer](void *) {
+            if (session->load() != sessionId) return;  // streaming has been stopped
+
+            auto released = V4L2Buffer{buffer};
+            released.resetBytesUsed();
+
+            if (V4L2Utils::xioctl(handle, VIDIOC_QBUF, &released.v4l2) == V4L2Utils::ERROR_CODE) {
+                std::cerr << "ERROR: VIDIOC_QBUF - " << strerror(errno) << '\n';
+            }
+        }};
+    }
+
+    void V4L2Capture::copyPlanes(V4L2Buffer const &buffer, uint8_t *dst) const {
+        auto const &mapping = internalBuffers_[buffer.v4l2.index];
+
+        for (auto plane = size_t{0}; plane < buffer.planeCount(); ++plane) {
+            auto size = buffer.payloadSize(plane);
+
+            MemoryCopy::from_device(mapping->data(plane) + buffer.dataOffset(plane), dst, size);
+            dst += size;
+        }
+    }
+
+    void V4L2Capture::describePlanes(Frame &frame, V4L2Buffer const &buffer) const {
+        if (imagePlanes_.size() < 2) return;  // frame's data is the only plane
+
+        for (auto i = size_t{0}; i < imagePlanes_.size(); ++i) {
+            auto const &plane = imagePlanes_[i];
+            auto offset = plane.offset;
+
+            for (auto memoryPlane = size_t{0}; memoryPlane < plane.memoryPlane; ++memoryPlane) {
+                offset += buffer.payloadSize(memoryPlane);
+            }
+
+            frame.setPlane(i, offset, plane.step, plane.size);
+        }
     }
 
 }  // namespace lirs
\ No newline at end of file
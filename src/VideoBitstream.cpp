@@ -0,0 +1,84 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "lirs_ros_video_streaming/VideoBitstream.hpp"
+
+namespace lirs {
+
+    namespace {
+
+        /* NAL unit types (ITU-T H.264 table 7-1, H.265 table 7-1) */
+        constexpr auto H264_NAL_SLICE_FIRST = 1;
+        constexpr auto H264_NAL_SLICE_IDR = 5;
+        constexpr auto HEVC_NAL_VCL_LAST = 31;
+        constexpr auto HEVC_NAL_IRAP_FIRST = 16;  // BLA_W_LP
+        constexpr auto HEVC_NAL_IRAP_LAST = 21;   // CRA_NUT
+
+        int nal_unit_type(VideoCodec codec, uint8_t header) {
+            return codec == VideoCodec::H264 ? header & 0x1F : (header >> 1) & 0x3F;
+        }
+
+        bool is_vcl(VideoCodec codec, int type) {
+            return codec == VideoCodec::H264 ? type >= H264_NAL_SLICE_FIRST && type <= H264_NAL_SLICE_IDR
+                                             : type <= HEVC_NAL_VCL_LAST;
+        }
+
+        bool is_random_access(VideoCodec codec, int type) {
+            return codec == VideoCodec::H264 ? type == H264_NAL_SLICE_IDR
+                                             : type >= HEVC_NAL_IRAP_FIRST && type <= HEVC_NAL_IRAP_LAST;
+        }
+    }
+
+    bool VideoBitstream::is_keyframe(VideoCodec codec, uint8_t const *data, size_t size) {
+        if (data == nullptr) return false;
+
+        // NAL unit header follows the 00 00 01 start code (4-byte start codes end the same way)
+        for (auto i = size_t{2}; i + 1 < size; ++i) {
+            if (data[i] != 0x01 || data[i - 1] != 0x00 || data[i - 2] != 0x00) continue;
+
+            auto type = nal_unit_type(codec, data[i + 1]);
+
+            // the first slice decides, parameter sets and SEI precede it
+            if (is_vcl(codec, type)) {
+                return is_random_access(codec, type);
+            }
+        }
+
+        return false;
+    }
+
+    char const *VideoBitstream::codec_name(VideoCodec codec) {
+        switch (codec) {
+            case VideoCodec::H264:
+                return "h264";
+            case VideoCodec::HEVC:
+                return "hevc";
+            default:
+                return "unknown";
+        }
+    }
+
+}  // namespace lirs
@@ -0,0 +1,106 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include <ros/ros.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "lirs_ros_video_streaming/CameraStreamer.hpp"
+
+namespace lirs {
+
+    /**
+     * @brief video_streamer node loaded into the nodelet manager (same parameters and topics).
+     *
+     * Images are published by shared pointers, thus the subscribers loaded into the same manager receive them
+     * without serialization and copies. Frames are published by the own thread (driven by the frame arrival),
+     * since onInit() should not block.
+     */
+    class VideoStreamerNodelet final : public nodelet::Nodelet {
+    public:
+        VideoStreamerNodelet() = default;
+
+        ~VideoStreamerNodelet() override {
+            isPublishing_ = false;
+
+            if (publishingThread_.joinable()) {
+                publishingThread_.join();
+            }
+        }
+
+        VideoStreamerNodelet(VideoStreamerNodelet const &) = delete;
+
+        VideoStreamerNodelet &operator=(VideoStreamerNodelet const &) = delete;
+
+        VideoStreamerNodelet(VideoStreamerNodelet &&) = delete;
+
+        VideoStreamerNodelet &operator=(VideoStreamerNodelet &&) = delete;
+
+    private:
+        void onInit() override {
+            streamer_ = std::make_unique<CameraStreamer>(getNodeHandle(), getPrivateNodeHandle(), true);
+
+            if (!streamer_->IsStreaming()) {
+                NODELET_ERROR_STREAM("Couldn't start streaming (see the errors above)");
+                return;
+            }
+
+            isPublishing_ = true;
+            publishingThread_ = std::thread{&VideoStreamerNodelet::publish, this};
+        }
+
+        void publish() {
+            // sleep while there are no subscribers
+            ros::Rate idleRate(streamer_->capture().Get(lirs::CaptureParam::FRAME_RATE));
+
+            while (isPublishing_ && ros::ok()) {
+                if (!streamer_->UpdateSubscribers()) {
+                    idleRate.sleep();
+                    continue;
+                }
+
+                // NOTE: Reading blocks until the device signals the frame is ready (or timeout).
+                if (auto frame = streamer_->ReadFrame(); frame.has_value()) {
+                    streamer_->Publish(std::move(*frame));
+                }
+            }
+        }
+
+    private:
+        std::unique_ptr<CameraStreamer> streamer_;
+
+        std::atomic_bool isPublishing_{false};
+        std::thread publishingThread_;
+    };
+
+}  // namespace lirs
+
+PLUGINLIB_EXPORT_CLASS(lirs::VideoStreamerNodelet, nodelet::Nodelet)
@@ -0,0 +1,188 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "lirs_ros_video_streaming/DmaBufSharing.hpp"
+
+namespace {
+
+    // memfd stands for the exported v4l2 buffer (NV12 4x2: Y and CbCr planes)
+    int nv12Memfd() {
+        auto fd = memfd_create("dmabuf_sharing_test", MFD_CLOEXEC);
+
+        uint8_t const image[12] = {1, 1, 1, 1, 1, 1, 1, 1, 2, 3, 2, 3};
+        EXPECT_EQ(write(fd, image, sizeof(image)), static_cast<ssize_t>(sizeof(image)));
+
+        return fd;
+    }
+
+    lirs::DmaBufFrame exportedFrame(int fd, bool &released) {
+        static uint8_t image[12] = {0};
+
+        lirs::Frame frame{image, sizeof(image), std::shared_ptr<void>{image, [&released](void *) {
+            released = true;
+        }}};
+
+        return lirs::DmaBufFrame{frame, 0, {fd}, {{0, 0, 4, 8}, {0, 8, 4, 4}}};
+    }
+
+    std::string socketPath() {
+        return "/tmp/lirs_dmabuf_sharing_test_" + std::to_string(getpid()) + ".sock";
+    }
+}
+
+TEST(DmaBufSharingTestCase, SharedFrameShouldBeReleasedByClient) {
+    lirs::DmaBufServer server{socketPath(), lirs::DmaBufFormat{4, 2, V4L2_PIX_FMT_NV12}};
+    ASSERT_TRUE(server.IsListening());
+
+    lirs::DmaBufClient client{server.socketPath()};
+    ASSERT_TRUE(client.IsConnected());
+
+    server.Poll();
+    EXPECT_EQ(server.clientCount(), 1u);
+
+    auto fd = nv12Memfd();
+    auto released = false;
+
+    auto skipped = false;
+
+    EXPECT_EQ(server.Publish(exportedFrame(fd, released)), 1u);
+    EXPECT_EQ(server.Publish(exportedFrame(fd, skipped)), 0u);  // previous frame is in flight
+    EXPECT_FALSE(released);
+    EXPECT_TRUE(skipped);
+
+    auto shared = client.Receive(std::chrono::milliseconds{1000});
+
+    ASSERT_TRUE(shared.has_value());
+    EXPECT_EQ(shared->format.pixelFormat, uint32_t{V4L2_PIX_FMT_NV12});
+    ASSERT_EQ(shared->frame.planeCount(), 2u);
+    EXPECT_EQ(shared->frame.plane(0).data[7], 1);
+    EXPECT_EQ(shared->frame.plane(1).data[1], 3);
+    EXPECT_EQ(shared->frame.plane(1).step, 4u);
+
+    shared.reset();  // release
+
+    server.Poll();
+    EXPECT_EQ(server.framesInFlight(), 0u);
+    EXPECT_TRUE(released);
+
+    close(fd);
+}
+
+TEST(DmaBufSharingTestCase, DisconnectedClientShouldReleaseFrames) {
+    lirs::DmaBufServer server{socketPath(), lirs::DmaBufFormat{4, 2, V4L2_PIX_FMT_NV12}};
+
+    auto fd = nv12Memfd();
+    auto released = false;
+    {
+        lirs::DmaBufClient client{server.socketPath()};
+        server.Poll();
+
+        EXPECT_EQ(server.Publish(exportedFrame(fd, released)), 1u);
+    }
+
+    server.Poll();
+    EXPECT_EQ(server.clientCount(), 0u);
+    EXPECT_TRUE(released);
+
+    close(fd);
+}
+
+TEST(DmaBufSharingTestCase, ClientsShouldNotHoldMoreFramesThanBuffers) {
+    // 4 v4l2 buffers, 2 of them are reserved for the streamer and the driver
+    lirs::DmaBufServer server{socketPath(), lirs::DmaBufFormat{4, 2, V4L2_PIX_FMT_NV12}, 1, 2};
+
+    lirs::DmaBufClient first{server.socketPath()};
+    lirs::DmaBufClient second{server.socketPath()};
+    lirs::DmaBufClient third{server.socketPath()};
+
+    server.Poll();
+    ASSERT_EQ(server.clientCount(), 3u);
+
+    auto fd = nv12Memfd();
+    auto released = false;
+
+    EXPECT_EQ(server.Publish(exportedFrame(fd, released)), 2u);
+    EXPECT_EQ(server.framesInFlight(), 2u);
+
+    EXPECT_EQ(server.Publish(exportedFrame(fd, released)), 0u);  // the limit is reached
+
+    auto frames = std::vector<lirs::SharedFrame>{};
+
+    for (auto client : {&first, &second, &third}) {
+        if (auto shared = client->Receive(std::chrono::milliseconds{100})) {
+            frames.push_back(std::move(*shared));
+        }
+    }
+
+    EXPECT_EQ(frames.size(), 2u);
+
+    frames.pop_back();  // release
+
+    server.Poll();
+    EXPECT_EQ(server.framesInFlight(), 1u);
+
+    EXPECT_EQ(server.Publish(exportedFrame(fd, released)), 1u);
+    EXPECT_EQ(server.framesInFlight(), 2u);
+
+    close(fd);
+}
+
+TEST(DmaBufSharingTestCase, UnreferencedMemoryPlaneShouldNotRejectFrame) {
+    lirs::DmaBufServer server{socketPath(), lirs::DmaBufFormat{4, 2, V4L2_PIX_FMT_NV12}};
+
+    lirs::DmaBufClient client{server.socketPath()};
+    server.Poll();
+
+    auto fd = nv12Memfd();
+    auto unused = nv12Memfd();
+    auto released = false;
+
+    // the second memory plane (e.g. driver's metadata) is not referenced by any image plane
+    auto frame = exportedFrame(fd, released);
+    frame.fds.push_back(unused);
+
+    EXPECT_EQ(server.Publish(frame), 1u);
+
+    auto shared = client.Receive(std::chrono::milliseconds{1000});
+
+    ASSERT_TRUE(shared.has_value());
+    ASSERT_EQ(shared->frame.planeCount(), 2u);
+    EXPECT_EQ(shared->frame.plane(1).data[1], 3);
+
+    close(unused);
+    close(fd);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,327 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "lirs_ros_video_streaming/VideoCapture.hpp"
+#include "lirs_ros_video_streaming/FramePool.hpp"
+#include "lirs_ros_video_streaming/RingBuffer.hpp"
+#include "lirs_ros_video_streaming/ClockOffsetEstimator.hpp"
+
+TEST(FrameTestCase, EmptyFrameShouldPass) {
+    lirs::Frame frame{nullptr, 0};
+
+    EXPECT_TRUE(frame.buffer().empty());
+    EXPECT_TRUE(frame.empty());
+    EXPECT_FALSE(frame.isBorrowed());
+}
+
+TEST(FrameTestCase, FrameShouldBeCopied) {
+    size_t bufferSize = 32;
+    uint8_t buffer[bufferSize] = {0};
+
+    lirs::Frame frame{buffer, bufferSize};
+
+    EXPECT_EQ(frame.buffer().size(), bufferSize);
+
+    auto copyFrame = frame;  // copy constructor
+
+    EXPECT_EQ(copyFrame.buffer().size(), frame.buffer().size());
+
+    lirs::Frame otherFrame {std::move(copyFrame)};  // move constructor
+
+    EXPECT_EQ(otherFrame.buffer().size(), bufferSize);
+    EXPECT_TRUE(copyFrame.buffer().empty());
+}
+
+TEST(FrameTestCase, BorrowedFrameShouldReleaseLeaseWithLastCopy) {
+    size_t bufferSize = 32;
+    uint8_t buffer[bufferSize] = {0};
+
+    auto released = false;
+    {
+        lirs::Frame frame{buffer, bufferSize, std::shared_ptr<void>{buffer, [&released](void *) {
+            released = true;
+        }}};
+
+        EXPECT_TRUE(frame.isBorrowed());
+        EXPECT_EQ(frame.data(), static_cast<uint8_t *>(buffer));  // no copy
+        EXPECT_EQ(frame.size(), bufferSize);
+
+        auto copyFrame = frame;
+        lirs::Frame otherFrame{std::move(frame)};
+
+        EXPECT_EQ(copyFrame.data(), otherFrame.data());
+        EXPECT_TRUE(frame.empty());
+        EXPECT_FALSE(released);
+    }
+    EXPECT_TRUE(released);
+}
+
+TEST(FrameTestCase, PlanesShouldBeLocatedInFrameData) {
+    uint8_t buffer[12] = {0};  // NV12 4x2: Y plane and CbCr plane
+
+    lirs::Frame frame{buffer, sizeof(buffer)};
+
+    EXPECT_EQ(frame.planeCount(), 1u);
+    EXPECT_EQ(frame.plane(0).data, frame.data());
+    EXPECT_EQ(frame.plane(0).size, sizeof(buffer));
+
+    frame.setPlane(0, 0, 4, 8);
+    frame.setPlane(1, 8, 4, 4);
+
+    auto copyFrame = frame;
+
+    ASSERT_EQ(copyFrame.planeCount(), 2u);
+    EXPECT_EQ(copyFrame.plane(1).data, copyFrame.data() + 8);
+    EXPECT_EQ(copyFrame.plane(1).step, 4u);
+    EXPECT_EQ(copyFrame.plane(1).size, 4u);
+
+    copyFrame.allocate(16);
+
+    EXPECT_EQ(copyFrame.planeCount(), 1u);
+    EXPECT_EQ(copyFrame.size(), 16u);
+}
+
+TEST(FrameTestCase, ExternalPlanesShouldBeGatheredOnAssign) {
+    uint8_t luma[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+    uint8_t chroma[4] = {2, 3, 2, 3};
+
+    lirs::Frame borrowed{luma, sizeof(luma), std::shared_ptr<void>{luma, [](void *) {}}};
+    borrowed.setExternalPlane(0, luma, 4, sizeof(luma));
+    borrowed.setExternalPlane(1, chroma, 4, sizeof(chroma));
+
+    EXPECT_EQ(borrowed.plane(1).data, static_cast<uint8_t *>(chroma));  // no copy
+
+    lirs::FramePool pool{16, 1};
+
+    auto frame = pool.Acquire(size_t{12});
+    ASSERT_TRUE(frame.has_value());
+
+    frame->assign(borrowed);
+
+    EXPECT_FALSE(frame->isBorrowed());
+    EXPECT_EQ(pool.available(), 1u);
+    ASSERT_EQ(frame->size(), 12u);
+    ASSERT_EQ(frame->planeCount(), 2u);
+    EXPECT_EQ(frame->plane(1).data, frame->data() + 8);
+    EXPECT_EQ(frame->data()[7], 1);
+    EXPECT_EQ(frame->data()[9], 3);
+}
+
+TEST(FramePoolTestCase, PoolBuffersShouldBeAligned) {
+    lirs::FramePool pool{100, 3};
+
+    uint8_t data[100] = {0};
+
+    std::vector<lirs::Frame> frames;
+
+    for (auto i = 0u; i < pool.capacity(); ++i) {
+        auto frame = pool.Acquire(data, sizeof(data));
+
+        ASSERT_TRUE(frame.has_value());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(frame->data()) % lirs::frame_pool_defaults::DEFAULT_ALIGNMENT, 0u);
+
+        frames.push_back(std::move(*frame));
+    }
+}
+
+TEST(FramePoolTestCase, ExhaustedPoolShouldBeCounted) {
+    lirs::FramePool pool{32, 2};
+
+    uint8_t data[32] = {1};
+
+    auto first = pool.Acquire(data, sizeof(data));
+    auto second = pool.Acquire(data, sizeof(data));
+
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(pool.available(), 0u);
+
+    EXPECT_FALSE(pool.Acquire(data, sizeof(data)));
+    EXPECT_EQ(pool.exhaustedCount(), 1u);
+    EXPECT_EQ(pool.acquiredCount(), 2u);
+
+    EXPECT_FALSE(pool.Acquire(data, 64));  // does not fit
+}
+
+TEST(FramePoolTestCase, ReleasedFrameShouldBeRecycled) {
+    lirs::FramePool pool{32, 1};
+
+    uint8_t data[32] = {42};
+
+    auto frame = pool.Acquire(data, sizeof(data));
+
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_TRUE(frame->isBorrowed());
+    EXPECT_EQ(frame->size(), sizeof(data));
+    EXPECT_EQ(frame->data()[0], 42);
+
+    auto recycled = frame->data();
+
+    auto copyFrame = *frame;
+    frame.reset();
+
+    EXPECT_EQ(pool.available(), 0u);  // copy still borrows the buffer
+
+    copyFrame = lirs::Frame{nullptr, 0};
+
+    EXPECT_EQ(pool.available(), 1u);
+
+    auto other = pool.Acquire(data, sizeof(data));
+
+    ASSERT_TRUE(other.has_value());
+    EXPECT_EQ(other->data(), recycled);
+}
+
+TEST(FramePoolTestCase, FramesReleasedByOtherThreadShouldBeRecycled) {
+    lirs::FramePool pool{32, 2};
+
+    lirs::RingBuffer<lirs::Frame> queue{2};
+
+    std::thread consumer{[&queue] {
+        for (auto received = 0; received < 1000;) {
+            if (auto frame = queue.TryPop()) {
+                frame->data()[1] = frame->data()[0];  // the last write before the release
+                ++received;
+            }
+        }
+    }};
+
+    for (auto sent = 0; sent < 1000;) {
+        auto value = static_cast<uint8_t>(sent);
+
+        if (auto frame = pool.Acquire(&value, 1)) {
+            while (!queue.TryPush(std::move(*frame)));
+            ++sent;
+        }
+    }
+
+    consumer.join();
+
+    EXPECT_EQ(pool.available(), pool.capacity());
+}
+
+TEST(FramePoolTestCase, FramesShouldOutlivePool) {
+    auto pool = std::make_unique<lirs::FramePool>(32, 1);
+
+    uint8_t data[32] = {7};
+
+    auto frame = pool->Acquire(data, sizeof(data));
+
+    ASSERT_TRUE(frame.has_value());
+
+    pool.reset();
+
+    EXPECT_EQ(frame->data()[0], 7);
+}
+
+TEST(ClockOffsetEstimatorTestCase, MonotonicTimeShouldBeConvertedToSystemTime) {
+    using std::chrono_literals::operator ""ms;
+
+    lirs::ClockOffsetEstimator estimator;
+
+    estimator.update();
+
+    auto monotonic = std::chrono::steady_clock::now().time_since_epoch();
+    auto system = std::chrono::system_clock::now().time_since_epoch();
+
+    auto converted = estimator.toSystemTime(monotonic);
+
+    EXPECT_LT(converted > system ? converted - system : system - converted, 1ms);
+}
+
+TEST(ClockOffsetEstimatorTestCase, OffsetShouldBeStableBetweenUpdates) {
+    using std::chrono_literals::operator ""ms;
+
+    lirs::ClockOffsetEstimator estimator;
+
+    auto initial = estimator.update();
+
+    for (auto i = 0; i < 100; ++i) {
+        estimator.update();
+    }
+
+    auto drift = estimator.offset() - initial;
+
+    EXPECT_LT(drift > drift.zero() ? drift : -drift, 1ms);
+}
+
+TEST(RingBufferTestCase, RingShouldPreserveOrder) {
+    lirs::RingBuffer<int> ring{3};
+
+    EXPECT_EQ(ring.capacity(), 4u);  // power of two
+    EXPECT_EQ(ring.capacity(), lirs::RingBuffer<int>::capacityFor(3));
+    EXPECT_EQ(lirs::RingBuffer<int>::capacityFor(5), 8u);
+    EXPECT_FALSE(ring.TryPop().has_value());
+
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.TryPush(int{i}));
+    }
+
+    EXPECT_FALSE(ring.TryPush(4));  // full
+    EXPECT_EQ(ring.size(), 4u);
+
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_EQ(ring.TryPop(), i);
+    }
+
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(RingBufferTestCase, ProducerAndConsumerThreadsShouldPass) {
+    constexpr auto count = 100'000;
+
+    lirs::RingBuffer<int> ring{8};
+
+    std::thread producer{[&ring] {
+        for (auto i = 0; i < count; ++i) {
+            while (!ring.TryPush(int{i})) std::this_thread::yield();
+        }
+    }};
+
+    auto expected = 0;
+
+    while (expected < count) {
+        if (auto value = ring.TryPop()) {
+            ASSERT_EQ(*value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <jpeglib.h>
+
+#include "lirs_ros_video_streaming/JpegDecoder.hpp"
+#include "lirs_ros_video_streaming/JpegDecodePool.hpp"
+
+namespace {
+
+    // Encodes uniform RGB image with libjpeg (4:2:0 chroma subsampling as produced by most of MJPEG cameras)
+    std::vector<uint8_t> encodeUniformJpeg(int width, int height, uint8_t r, uint8_t g, uint8_t b) {
+        jpeg_compress_struct info{};
+        jpeg_error_mgr errorManager{};
+
+        info.err = jpeg_std_error(&errorManager);
+        jpeg_create_compress(&info);
+
+        unsigned char *data = nullptr;
+        unsigned long size = 0;
+        jpeg_mem_dest(&info, &data, &size);
+
+        info.image_width = static_cast<JDIMENSION>(width);
+        info.image_height = static_cast<JDIMENSION>(height);
+        info.input_components = 3;
+        info.in_color_space = JCS_RGB;
+
+        jpeg_set_defaults(&info);
+        jpeg_set_quality(&info, 95, TRUE);
+        jpeg_start_compress(&info, TRUE);
+
+        std::vector<uint8_t> line(static_cast<size_t>(width) * 3);
+        for (auto x = 0; x < width; ++x) {
+            line[x * 3] = r;
+            line[x * 3 + 1] = g;
+            line[x * 3 + 2] = b;
+        }
+
+        while (info.next_scanline < info.image_height) {
+            JSAMPROW row = line.data();
+            jpeg_write_scanlines(&info, &row, 1);
+        }
+
+        jpeg_finish_compress(&info);
+        jpeg_destroy_compress(&info);
+
+        std::vector<uint8_t> jpeg(data, data + size);
+        std::free(data);
+
+        return jpeg;
+    }
+
+    TEST(JpegDecoderTestCase, ShouldDecodeUniformColor) {
+        constexpr auto width = 64, height = 48;
+
+        auto jpeg = encodeUniformJpeg(width, height, 200, 100, 50);
+
+        lirs::JpegDecoder rgbDecoder{lirs::DecodedFormat::RGB8};
+        lirs::JpegDecoder bgrDecoder{lirs::DecodedFormat::BGR8};
+
+        std::vector<uint8_t> rgb(width * 3 * height), bgr(width * 3 * height);
+
+        ASSERT_TRUE(rgbDecoder.Decode(jpeg.data(), jpeg.size(), rgb.data(), width * 3, width, height));
+        ASSERT_TRUE(bgrDecoder.Decode(jpeg.data(), jpeg.size(), bgr.data(), width * 3, width, height));
+
+        for (auto pixel = 0; pixel < width * height; ++pixel) {
+            ASSERT_NEAR(rgb[pixel * 3], 200, 3);
+            ASSERT_NEAR(rgb[pixel * 3 + 1], 100, 3);
+            ASSERT_NEAR(rgb[pixel * 3 + 2], 50, 3);
+
+            ASSERT_EQ(bgr[pixel * 3], rgb[pixel * 3 + 2]);
+            ASSERT_EQ(bgr[pixel * 3 + 2], rgb[pixel * 3]);
+        }
+
+        // decompressor is reusable
+        lirs::JpegDecoder monoDecoder{lirs::DecodedFormat::MONO8};
+        std::vector<uint8_t> mono(width * height);
+
+        for (auto i = 0; i < 2; ++i) {
+            ASSERT_TRUE(monoDecoder.Decode(jpeg.data(), jpeg.size(), mono.data(), width, width, height));
+            ASSERT_NEAR(mono[width * height / 2], 0.299 * 200 + 0.587 * 100 + 0.114 * 50, 3);
+        }
+    }
+
+    TEST(JpegDecoderTestCase, ShouldRejectInvalidImages) {
+        constexpr auto width = 32, height = 16;
+
+        auto jpeg = encodeUniformJpeg(width, height, 10, 20, 30);
+
+        lirs::JpegDecoder decoder{lirs::DecodedFormat::RGB8};
+        std::vector<uint8_t> image(width * 3 * height);
+
+        // unexpected size
+        EXPECT_FALSE(decoder.Decode(jpeg.data(), jpeg.size(), image.data(), width * 3, width / 2, height));
+
+        // not a JPEG
+        std::vector<uint8_t> garbage(jpeg.size(), 0xAB);
+        EXPECT_FALSE(decoder.Decode(garbage.data(), garbage.size(), image.data(), width * 3, width, height));
+
+        // decoder recovers after errors
+        EXPECT_TRUE(decoder.Decode(jpeg.data(), jpeg.size(), image.data(), width * 3, width, height));
+    }
+
+    TEST(JpegDecodePoolTestCase, ShouldDeliverInSubmissionOrder) {
+        constexpr auto width = 64, height = 32, frames = 64;
+
+        auto jpeg = encodeUniformJpeg(width, height, 1, 2, 3);
+
+        std::mutex mutex;
+        std::vector<uint32_t> delivered;
+        auto submitted = 0u;
+
+        {
+            lirs::JpegDecodePool pool{4, lirs::DecodedFormat::MONO8, width, height,
+                                      [&](lirs::FrameInfo const &info, std::vector<uint8_t> &image) {
+                                          std::lock_guard<std::mutex> lock{mutex};
+                                          EXPECT_EQ(image.size(), size_t{width * height});
+                                          delivered.push_back(info.sequence);
+                                      }};
+
+            for (auto sequence = 0u; sequence < frames; ++sequence) {
+                lirs::Frame frame{jpeg.data(), jpeg.size()};
+                frame.stamp(lirs::FrameInfo{jpeg.size(), {}, sequence, 0});
+
+                submitted += pool.Submit(std::move(frame)) ? 1 : 0;
+            }
+
+            EXPECT_EQ(pool.droppedCount(), frames - submitted);
+        }  // pool finishes pending decodes on destruction
+
+        ASSERT_EQ(delivered.size(), submitted);
+        EXPECT_TRUE(std::is_sorted(delivered.begin(), delivered.end()));
+        EXPECT_GT(submitted, 0u);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "lirs_ros_video_streaming/JpegEncoder.hpp"
+#include "lirs_ros_video_streaming/JpegDecoder.hpp"
+
+namespace {
+
+    std::vector<uint8_t> uniformYuyv(int width, int height, uint8_t y, uint8_t u, uint8_t v) {
+        std::vector<uint8_t> image(static_cast<size_t>(width) * 2 * height);
+
+        for (auto i = size_t{0}; i < image.size(); i += 4) {
+            image[i] = y;
+            image[i + 1] = u;
+            image[i + 2] = y;
+            image[i + 3] = v;
+        }
+        return image;
+    }
+
+    // Smooth gradient with noise, i.e. JPEG-like content
+    std::vector<uint8_t> gradientYuv422(int width, int height) {
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> noise{-8, 8};
+
+        std::vector<uint8_t> image(static_cast<size_t>(width) * 2 * height);
+
+        for (auto y = 0; y < height; ++y) {
+            for (auto x = 0; x < width * 2; ++x) {
+                auto value = (x / 2 + y) % 256 + noise(generator);
+                image[y * width * 2 + x] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+            }
+        }
+        return image;
+    }
+
+    TEST(JpegEncoderTestCase, ShouldEncodeUniformColor) {
+        constexpr auto width = 64, height = 40;
+
+        // BT.601 limited range red
+        auto yuyv = uniformYuyv(width, height, 81, 90, 240);
+
+        lirs::JpegEncoder encoder{2, lirs::JpegEncoding{lirs::YuvLayout::YUYV, lirs::ColorRange::LIMITED, false, 95}};
+        lirs::JpegDecoder decoder{lirs::DecodedFormat::RGB8};
+
+        std::vector<uint8_t> jpeg;
+        std::vector<uint8_t> rgb(width * 3 * height);
+
+        ASSERT_TRUE(encoder.Encode(yuyv.data(), width * 2, width, height, jpeg));
+        ASSERT_TRUE(decoder.Decode(jpeg.data(), jpeg.size(), rgb.data(), width * 3, width, height));
+
+        for (auto pixel = 0; pixel < width * height; ++pixel) {
+            ASSERT_NEAR(rgb[pixel * 3], 255, 4) << pixel;
+            ASSERT_NEAR(rgb[pixel * 3 + 1], 0, 4) << pixel;
+            ASSERT_NEAR(rgb[pixel * 3 + 2], 0, 4) << pixel;
+        }
+
+        EXPECT_FALSE(encoder.Encode(yuyv.data(), width * 2, width - 1, height, jpeg));
+    }
+
+    TEST(JpegEncoderTestCase, StripesShouldNotChangeImage) {
+        constexpr auto width = 200, height = 150;  // partial MCUs on both sides
+
+        auto yuv = gradientYuv422(width, height);
+
+        for (auto layout : {lirs::YuvLayout::YUYV, lirs::YuvLayout::UYVY}) {
+            for (auto isGray : {false, true}) {
+                auto encoding = lirs::JpegEncoding{layout, lirs::ColorRange::FULL, isGray, 80};
+                auto format = isGray ? lirs::DecodedFormat::MONO8 : lirs::DecodedFormat::RGB8;
+                auto step = static_cast<size_t>(width * lirs::decoded_channels(format));
+
+                lirs::JpegDecoder decoder{format};
+
+                std::vector<uint8_t> expected(step * height);
+                std::vector<uint8_t> jpeg;
+
+                lirs::JpegEncoder singleThreaded{1, encoding};
+                ASSERT_TRUE(singleThreaded.Encode(yuv.data(), width * 2, width, height, jpeg));
+                ASSERT_TRUE(decoder.Decode(jpeg.data(), jpeg.size(), expected.data(), step, width, height));
+
+                // more than 8 stripes wrap the restart marker numbers around
+                for (auto threads : {3, 12, 32}) {
+                    lirs::JpegEncoder encoder{static_cast<size_t>(threads), encoding};
+                    std::vector<uint8_t> decoded(step * height);
+
+                    for (auto repeat = 0; repeat < 2; ++repeat) {
+                        ASSERT_TRUE(encoder.Encode(yuv.data(), width * 2, width, height, jpeg));
+                        ASSERT_TRUE(decoder.Decode(jpeg.data(), jpeg.size(), decoded.data(), step, width, height));
+
+                        // restart intervals affect entropy coding only
+                        EXPECT_EQ(decoded, expected) << threads << " threads, gray = " << isGray;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "lirs_ros_video_streaming/MemoryCopy.hpp"
+
+namespace {
+
+    constexpr auto ALL_COPY_KERNELS = {lirs::CopyKernel::GENERIC, lirs::CopyKernel::STREAMING_SSE41,
+                                       lirs::CopyKernel::STREAMING_AVX2};
+
+    std::vector<uint8_t> randomData(size_t size) {
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> distribution{0, 255};
+
+        std::vector<uint8_t> data(size);
+        for (auto &byte : data) {
+            byte = static_cast<uint8_t>(distribution(generator));
+        }
+        return data;
+    }
+
+}  // namespace
+
+TEST(MemoryCopyTestCase, SelectedKernelShouldBeSupported) {
+    auto kernel = lirs::MemoryCopy::copy_kernel();
+
+    uint8_t src[] = {1, 2, 3};
+    uint8_t dst[3] = {};
+
+    EXPECT_TRUE(lirs::MemoryCopy::from_device(kernel, src, dst, sizeof(src)));
+    EXPECT_STRNE(lirs::MemoryCopy::copy_kernel_name(kernel), "");
+}
+
+TEST(MemoryCopyTestCase, KernelsShouldCopyMisalignedData) {
+    constexpr auto MAX_SIZE = size_t{4096 + 100};
+
+    auto const src = randomData(MAX_SIZE + 64);
+
+    for (auto kernel : ALL_COPY_KERNELS) {
+        std::vector<uint8_t> dst(MAX_SIZE + 64);
+
+        if (!lirs::MemoryCopy::from_device(kernel, src.data(), dst.data(), 0)) continue;  // not supported
+
+        // sizes around the streaming threshold and lines, all relative alignments of the source and destination
+        for (auto size : {size_t{1}, size_t{63}, size_t{255}, size_t{256}, size_t{1000}, MAX_SIZE}) {
+            for (auto srcOffset : {0, 1, 16, 32, 33}) {
+                for (auto dstOffset : {0, 7, 16, 48}) {
+                    std::fill(dst.begin(), dst.end(), uint8_t{0});
+
+                    lirs::MemoryCopy::from_device(kernel, src.data() + srcOffset, dst.data() + dstOffset, size);
+
+                    ASSERT_TRUE(std::equal(src.begin() + srcOffset, src.begin() + srcOffset + size,
+                                           dst.begin() + dstOffset))
+                                                << lirs::MemoryCopy::copy_kernel_name(kernel) << ", size " << size
+                                                << ", offsets " << srcOffset << " and " << dstOffset;
+
+                    // bytes around the destination are intact
+                    EXPECT_TRUE(std::all_of(dst.begin(), dst.begin() + dstOffset, [](uint8_t b) { return b == 0; }));
+                    EXPECT_TRUE(std::all_of(dst.begin() + dstOffset + size, dst.end(),
+                                            [](uint8_t b) { return b == 0; }));
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
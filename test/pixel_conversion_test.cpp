@@ -0,0 +1,421 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <array>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "lirs_ros_video_streaming/PixelConversion.hpp"
+
+namespace {
+
+    constexpr auto ALL_SIMD_LEVELS = {lirs::SimdLevel::SCALAR, lirs::SimdLevel::SSE2,
+                                      lirs::SimdLevel::AVX2, lirs::SimdLevel::NEON};
+
+    std::vector<uint8_t> randomImage(size_t size) {
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> distribution{0, 255};
+
+        std::vector<uint8_t> image(size);
+        for (auto &byte : image) {
+            byte = static_cast<uint8_t>(distribution(generator));
+        }
+        return image;
+    }
+
+    // Floating-point reference conversion of a single pixel
+    std::array<double, 3> referenceRgb(lirs::YuvToRgb const &conversion, int y, int u, int v) {
+        auto kr = conversion.matrix == lirs::ColorMatrix::BT709 ? 0.2126 : 0.299;
+        auto kb = conversion.matrix == lirs::ColorMatrix::BT709 ? 0.0722 : 0.114;
+        auto kg = 1.0 - kr - kb;
+
+        auto isLimited = conversion.range == lirs::ColorRange::LIMITED;
+
+        auto luma = isLimited ? std::max(y - 16, 0) * 255.0 / 219.0 : y;
+        auto cb = (u - 128) * (isLimited ? 255.0 / 224.0 : 1.0);
+        auto cr = (v - 128) * (isLimited ? 255.0 / 224.0 : 1.0);
+
+        auto clamp = [](double value) { return std::clamp(value, 0.0, 255.0); };
+
+        return {clamp(luma + 2.0 * (1.0 - kr) * cr),
+                clamp(luma - 2.0 * (1.0 - kb) * kb / kg * cb - 2.0 * (1.0 - kr) * kr / kg * cr),
+                clamp(luma + 2.0 * (1.0 - kb) * cb)};
+    }
+
+    std::vector<lirs::YuvToRgb> allConversions() {
+        std::vector<lirs::YuvToRgb> conversions;
+
+        for (auto layout : {lirs::YuvLayout::YUYV, lirs::YuvLayout::UYVY}) {
+            for (auto order : {lirs::RgbOrder::RGB, lirs::RgbOrder::BGR}) {
+                for (auto matrix : {lirs::ColorMatrix::BT601, lirs::ColorMatrix::BT709}) {
+                    for (auto range : {lirs::ColorRange::LIMITED, lirs::ColorRange::FULL}) {
+                        conversions.push_back(lirs::YuvToRgb{layout, order, matrix, range});
+                    }
+                }
+            }
+        }
+        return conversions;
+    }
+
+    // Packs raw values into the given format, returns image with the given line step
+    std::vector<uint8_t> packRaw(lirs::RawFormat format, std::vector<uint16_t> const &values,
+                                 int width, int height, size_t step) {
+        std::vector<uint8_t> image(step * height, 0);
+
+        for (auto y = 0; y < height; ++y) {
+            auto line = image.data() + y * step;
+
+            for (auto x = 0; x < width; ++x) {
+                auto value = values[y * width + x];
+
+                if (format.packing == lirs::RawPacking::MIPI10) {
+                    line[5 * (x / 4) + x % 4] = static_cast<uint8_t>(value >> 2);
+                    line[5 * (x / 4) + 4] |= static_cast<uint8_t>((value & 0x3) << (2 * (x % 4)));
+                } else if (format.packing == lirs::RawPacking::MIPI12) {
+                    line[3 * (x / 2) + x % 2] = static_cast<uint8_t>(value >> 4);
+                    line[3 * (x / 2) + 2] |= static_cast<uint8_t>((value & 0xF) << (4 * (x % 2)));
+                } else {
+                    line[2 * x] = static_cast<uint8_t>(value & 0xFF);
+                    line[2 * x + 1] = static_cast<uint8_t>(value >> 8);
+                }
+            }
+        }
+        return image;
+    }
+
+    std::vector<uint16_t> randomRaw(int bits, size_t count) {
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> distribution{0, (1 << bits) - 1};
+
+        std::vector<uint16_t> values(count);
+        for (auto &value : values) {
+            value = static_cast<uint16_t>(distribution(generator));
+        }
+        return values;
+    }
+
+    // Minimal line size of the raw format (as reported by v4l2)
+    size_t rawStep(lirs::RawFormat format, int width) {
+        switch (format.packing) {
+            case lirs::RawPacking::MIPI10:
+                return static_cast<size_t>(width * 5 / 4);
+            case lirs::RawPacking::MIPI12:
+                return static_cast<size_t>(width * 3 / 2);
+            default:
+                return static_cast<size_t>(width * 2);
+        }
+    }
+
+    constexpr auto ALL_RAW_FORMATS = {lirs::RawFormat{lirs::RawPacking::UNPACKED, 10},
+                                      lirs::RawFormat{lirs::RawPacking::UNPACKED, 12},
+                                      lirs::RawFormat{lirs::RawPacking::UNPACKED, 16},
+                                      lirs::RawFormat{lirs::RawPacking::MIPI10, 10},
+                                      lirs::RawFormat{lirs::RawPacking::MIPI12, 12}};
+
+}  // namespace
+
+TEST(PixelConversionTestCase, YuyvToMono8ShouldExtractLuma) {
+    // width is not a multiple of the SIMD width (tail processing), source lines are padded
+    constexpr auto width = 70;
+    constexpr auto height = 5;
+    auto srcStep = size_t{width * 2 + 12};
+    auto dstStep = size_t{width + 3};
+
+    auto yuyv = randomImage(srcStep * height);
+
+    for (auto level : ALL_SIMD_LEVELS) {
+        std::vector<uint8_t> mono(dstStep * height, 0);
+
+        if (!lirs::PixelConversion::yuyv_to_mono8(level, yuyv.data(), srcStep, mono.data(), dstStep, width, height)) {
+            continue;  // not supported by the CPU
+        }
+
+        for (auto y = 0; y < height; ++y) {
+            for (auto x = 0; x < width; ++x) {
+                ASSERT_EQ(mono[y * dstStep + x], yuyv[y * srcStep + 2 * x])
+                                            << lirs::PixelConversion::simd_level_name(level);
+            }
+            EXPECT_EQ(mono[y * dstStep + width], 0);  // padding is untouched
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, RuntimeSelectedLevelShouldBeSupported) {
+    auto level = lirs::PixelConversion::simd_level();
+
+    uint8_t yuyv[4] = {1, 2, 3, 4};
+    uint8_t mono[2] = {0};
+
+    EXPECT_TRUE(lirs::PixelConversion::yuyv_to_mono8(level, yuyv, 4, mono, 2, 2, 1));
+
+    lirs::PixelConversion::yuyv_to_mono8(yuyv, 4, mono, 2, 2, 1);
+
+    EXPECT_EQ(mono[0], 1);
+    EXPECT_EQ(mono[1], 3);
+}
+
+TEST(PixelConversionTestCase, YuyvToUyvyShouldSwapBytes) {
+    constexpr auto width = 102;
+    constexpr auto height = 3;
+    constexpr auto srcStep = size_t{width * 2 + 8};
+    constexpr auto dstStep = size_t{width * 2 + 2};
+
+    auto yuyv = randomImage(srcStep * height);
+
+    for (auto level : ALL_SIMD_LEVELS) {
+        std::vector<uint8_t> uyvy(dstStep * height, 0);
+
+        if (!lirs::PixelConversion::yuyv_to_uyvy(level, yuyv.data(), srcStep, uyvy.data(), dstStep, width, height)) {
+            continue;  // not supported by the CPU
+        }
+
+        for (auto y = 0; y < height; ++y) {
+            for (auto x = 0; x < width * 2; x += 2) {
+                ASSERT_EQ(uyvy[y * dstStep + x], yuyv[y * srcStep + x + 1])
+                                            << lirs::PixelConversion::simd_level_name(level);
+                ASSERT_EQ(uyvy[y * dstStep + x + 1], yuyv[y * srcStep + x])
+                                            << lirs::PixelConversion::simd_level_name(level);
+            }
+            EXPECT_EQ(uyvy[y * dstStep + width * 2], 0);  // padding is untouched
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, Yuv422ToRgbShouldMatchReference) {
+    constexpr auto width = 70;
+    constexpr auto height = 3;
+    constexpr auto srcStep = size_t{width * 2 + 4};
+    constexpr auto dstStep = size_t{width * 3 + 5};
+
+    auto yuv = randomImage(srcStep * height);
+
+    for (auto const &conversion : allConversions()) {
+        std::vector<uint8_t> rgb(dstStep * height);
+
+        lirs::PixelConversion::yuv422_to_rgb(lirs::SimdLevel::SCALAR, conversion, yuv.data(), srcStep,
+                                             rgb.data(), dstStep, width, height);
+
+        auto isYuyv = conversion.layout == lirs::YuvLayout::YUYV;
+        auto rIndex = conversion.order == lirs::RgbOrder::RGB ? 0 : 2;
+
+        for (auto y = 0; y < height; ++y) {
+            for (auto x = 0; x < width; ++x) {
+                auto pair = yuv.data() + y * srcStep + 4 * (x / 2);
+
+                auto luma = pair[(isYuyv ? 0 : 1) + 2 * (x % 2)];
+                auto u = pair[isYuyv ? 1 : 0];
+                auto v = pair[isYuyv ? 3 : 2];
+
+                auto expected = referenceRgb(conversion, luma, u, v);
+                auto pixel = rgb.data() + y * dstStep + 3 * x;
+
+                ASSERT_NEAR(pixel[rIndex], expected[0], 2.0);
+                ASSERT_NEAR(pixel[1], expected[1], 2.0);
+                ASSERT_NEAR(pixel[2 - rIndex], expected[2], 2.0);
+            }
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, Yuv422ToRgbSimdShouldMatchScalar) {
+    constexpr auto width = 98;
+    constexpr auto height = 4;
+    constexpr auto srcStep = size_t{width * 2};
+    constexpr auto dstStep = size_t{width * 3};
+
+    auto yuv = randomImage(srcStep * height);
+
+    for (auto const &conversion : allConversions()) {
+        std::vector<uint8_t> expected(dstStep * height);
+
+        lirs::PixelConversion::yuv422_to_rgb(lirs::SimdLevel::SCALAR, conversion, yuv.data(), srcStep,
+                                             expected.data(), dstStep, width, height);
+
+        for (auto level : ALL_SIMD_LEVELS) {
+            std::vector<uint8_t> rgb(dstStep * height);
+
+            if (lirs::PixelConversion::yuv422_to_rgb(level, conversion, yuv.data(), srcStep,
+                                                     rgb.data(), dstStep, width, height)) {
+                ASSERT_EQ(rgb, expected) << lirs::PixelConversion::simd_level_name(level);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+TEST(PixelConversionTestCase, BayerToRgbShouldRestoreUniformColor) {
+    constexpr auto width = 70;
+    constexpr auto height = 6;
+    constexpr auto step = size_t{width};
+
+    constexpr auto red = uint8_t{200};
+    constexpr auto green = uint8_t{100};
+    constexpr auto blue = uint8_t{30};
+
+    // colors of the top-left 2x2 block
+    auto patterns = {std::pair{lirs::BayerPattern::RGGB, std::array{red, green, green, blue}},
+                     std::pair{lirs::BayerPattern::BGGR, std::array{blue, green, green, red}},
+                     std::pair{lirs::BayerPattern::GRBG, std::array{green, red, blue, green}},
+                     std::pair{lirs::BayerPattern::GBRG, std::array{green, blue, red, green}}};
+
+    for (auto const &[pattern, colors] : patterns) {
+        std::vector<uint8_t> bayer(step * height);
+
+        for (auto y = 0; y < height; ++y) {
+            for (auto x = 0; x < width; ++x) {
+                bayer[y * step + x] = colors[(y % 2) * 2 + x % 2];
+            }
+        }
+
+        for (auto level : ALL_SIMD_LEVELS) {
+            std::vector<uint8_t> bgr(width * height * 3);
+            std::vector<uint8_t> mono(width * height);
+
+            if (!lirs::PixelConversion::bayer_to_rgb(level, pattern, lirs::RgbOrder::BGR, bayer.data(), step,
+                                                     bgr.data(), width * 3, width, height)) {
+                continue;  // not supported by the CPU
+            }
+
+            lirs::PixelConversion::bayer_to_mono8(level, pattern, bayer.data(), step,
+                                                  mono.data(), width, width, height);
+
+            for (auto pixel = 0; pixel < width * height; ++pixel) {
+                ASSERT_EQ(bgr[3 * pixel], blue) << lirs::PixelConversion::simd_level_name(level) << ' ' << pixel;
+                ASSERT_EQ(bgr[3 * pixel + 1], green) << lirs::PixelConversion::simd_level_name(level) << ' ' << pixel;
+                ASSERT_EQ(bgr[3 * pixel + 2], red) << lirs::PixelConversion::simd_level_name(level) << ' ' << pixel;
+                ASSERT_NEAR(mono[pixel], (red + 2 * green + blue) / 4.0, 1.0);  // rounding averages
+            }
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, BayerSimdShouldMatchScalar) {
+    constexpr auto width = 101;  // not multiple of the SIMD width
+    constexpr auto height = 5;
+    constexpr auto srcStep = size_t{width + 11};
+
+    auto bayer = randomImage(srcStep * height);
+
+    for (auto pattern : {lirs::BayerPattern::RGGB, lirs::BayerPattern::BGGR,
+                         lirs::BayerPattern::GRBG, lirs::BayerPattern::GBRG}) {
+        std::vector<uint8_t> expectedRgb(width * height * 3);
+        std::vector<uint8_t> expectedMono(width * height);
+
+        lirs::PixelConversion::bayer_to_rgb(lirs::SimdLevel::SCALAR, pattern, lirs::RgbOrder::RGB, bayer.data(),
+                                            srcStep, expectedRgb.data(), width * 3, width, height);
+        lirs::PixelConversion::bayer_to_mono8(lirs::SimdLevel::SCALAR, pattern, bayer.data(), srcStep,
+                                              expectedMono.data(), width, width, height);
+
+        for (auto level : ALL_SIMD_LEVELS) {
+            std::vector<uint8_t> rgb(expectedRgb.size());
+            std::vector<uint8_t> mono(expectedMono.size());
+
+            if (!lirs::PixelConversion::bayer_to_rgb(level, pattern, lirs::RgbOrder::RGB, bayer.data(), srcStep,
+                                                     rgb.data(), width * 3, width, height)) {
+                continue;  // not supported by the CPU
+            }
+
+            lirs::PixelConversion::bayer_to_mono8(level, pattern, bayer.data(), srcStep,
+                                                  mono.data(), width, width, height);
+
+            EXPECT_EQ(rgb, expectedRgb) << lirs::PixelConversion::simd_level_name(level);
+            EXPECT_EQ(mono, expectedMono) << lirs::PixelConversion::simd_level_name(level);
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, RawTo16ShouldUnpackMsbAligned) {
+    constexpr auto width = 100;  // multiple of 4, not multiple of the SIMD width
+    constexpr auto height = 3;
+    constexpr auto dstStep = size_t{width * 2};
+
+    for (auto format : ALL_RAW_FORMATS) {
+        auto srcStep = rawStep(format, width);  // no padding, reading beyond the lines is detected by sanitizers
+        auto values = randomRaw(format.bits, width * height);
+        auto raw = packRaw(format, values, width, height, srcStep);
+
+        for (auto level : ALL_SIMD_LEVELS) {
+            std::vector<uint8_t> unpacked(dstStep * height);
+
+            if (!lirs::PixelConversion::raw_to_16(level, format, raw.data(), srcStep,
+                                                  unpacked.data(), dstStep, width, height)) {
+                continue;  // not supported by the CPU
+            }
+
+            for (auto pixel = 0; pixel < width * height; ++pixel) {
+                auto value = unpacked[2 * pixel] | unpacked[2 * pixel + 1] << 8;
+                ASSERT_EQ(value, values[pixel] << (16 - format.bits))
+                                            << lirs::PixelConversion::simd_level_name(level) << ' ' << pixel;
+            }
+        }
+    }
+}
+
+TEST(PixelConversionTestCase, RawTo8ShouldMapWindow) {
+    constexpr auto width = 100;
+    constexpr auto height = 3;
+    for (auto format : ALL_RAW_FORMATS) {
+        auto srcStep = rawStep(format, width) + 6;
+        auto values = randomRaw(format.bits, width * height);
+        auto raw = packRaw(format, values, width, height, srcStep);
+
+        auto maximum = (1 << format.bits) - 1;
+
+        for (auto window : {lirs::RawWindow{0, static_cast<uint16_t>(maximum)},
+                            lirs::RawWindow{static_cast<uint16_t>(maximum / 4), static_cast<uint16_t>(maximum / 2)},
+                            lirs::RawWindow{100, 200}}) {
+
+            std::vector<uint8_t> expected(width * height);
+
+            lirs::PixelConversion::raw_to_8(lirs::SimdLevel::SCALAR, format, window, raw.data(), srcStep,
+                                            expected.data(), width, width, height);
+
+            for (auto pixel = 0; pixel < width * height; ++pixel) {
+                auto reference = std::clamp((values[pixel] - window.min) * 255.0 / (window.max - window.min),
+                                            0.0, 255.0);
+                ASSERT_NEAR(expected[pixel], reference, 1.0) << pixel;
+            }
+
+            for (auto level : ALL_SIMD_LEVELS) {
+                std::vector<uint8_t> windowed(width * height);
+
+                if (!lirs::PixelConversion::raw_to_8(level, format, window, raw.data(), srcStep,
+                                                     windowed.data(), width, width, height)) {
+                    continue;  // not supported by the CPU
+                }
+
+                EXPECT_EQ(windowed, expected) << lirs::PixelConversion::simd_level_name(level);
+            }
+        }
+    }
+}
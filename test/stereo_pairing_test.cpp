@@ -0,0 +1,102 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+#include "lirs_ros_video_streaming/StereoPairing.hpp"
+
+namespace {
+
+    using namespace std::chrono_literals;
+
+    lirs::Frame frameAt(std::chrono::nanoseconds timestamp, uint32_t sequence) {
+        std::vector<uint8_t> data(16, static_cast<uint8_t>(sequence));
+
+        auto frame = lirs::Frame{data.data(), data.size()};
+        frame.stamp(lirs::FrameInfo{data.size(), timestamp, sequence, 0});
+
+        return frame;
+    }
+
+}  // namespace
+
+TEST(StereoPairingTestCase, FramesWithinToleranceShouldBePairedWithIdenticalStamp) {
+    lirs::StereoPairing pairing{5ms};
+
+    EXPECT_FALSE(pairing.Push(lirs::StereoSide::LEFT, frameAt(100ms, 1)));
+
+    auto pair = pairing.Push(lirs::StereoSide::RIGHT, frameAt(104ms, 7));
+
+    ASSERT_TRUE(pair);
+    EXPECT_EQ(pair->left.sequence(), 1u);
+    EXPECT_EQ(pair->right.sequence(), 7u);
+    EXPECT_EQ(pair->skew, 4ms);
+    EXPECT_EQ(pair->left.timestamp(), 102ms);
+    EXPECT_EQ(pair->right.timestamp(), 102ms);
+
+    EXPECT_EQ(pairing.stats().pairs, 1u);
+    EXPECT_EQ(pairing.stats().maxSkew, 4ms);
+    EXPECT_EQ(pairing.pendingCount(lirs::StereoSide::LEFT), 0u);
+}
+
+TEST(StereoPairingTestCase, FramesWithoutMateShouldBeDiscarded) {
+    lirs::StereoPairing pairing{5ms};
+
+    // left frame at 100 ms is never paired (right camera skipped it)
+    EXPECT_FALSE(pairing.Push(lirs::StereoSide::LEFT, frameAt(100ms, 1)));
+    EXPECT_FALSE(pairing.Push(lirs::StereoSide::LEFT, frameAt(133ms, 2)));
+
+    auto pair = pairing.Push(lirs::StereoSide::RIGHT, frameAt(131ms, 1));
+
+    ASSERT_TRUE(pair);
+    EXPECT_EQ(pair->left.sequence(), 2u);
+    EXPECT_EQ(pairing.stats().unpaired[static_cast<size_t>(lirs::StereoSide::LEFT)], 1u);
+
+    // pending frames are limited (the oldest is discarded)
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_FALSE(pairing.Push(lirs::StereoSide::RIGHT, frameAt(200ms + i * 33ms, static_cast<uint32_t>(2 + i))));
+    }
+
+    EXPECT_EQ(pairing.pendingCount(lirs::StereoSide::RIGHT), lirs::stereo_pairing_defaults::MAX_PENDING_FRAMES);
+    EXPECT_EQ(pairing.stats().unpaired[static_cast<size_t>(lirs::StereoSide::RIGHT)], 1u);
+}
+
+TEST(StereoPairingTestCase, SequenceGapsShouldBeCountedAsDropped) {
+    lirs::StereoPairing pairing{5ms};
+
+    pairing.Push(lirs::StereoSide::LEFT, frameAt(100ms, 10));
+    pairing.Push(lirs::StereoSide::LEFT, frameAt(200ms, 13));
+
+    EXPECT_EQ(pairing.stats().dropped[static_cast<size_t>(lirs::StereoSide::LEFT)], 2u);
+    EXPECT_EQ(pairing.stats().dropped[static_cast<size_t>(lirs::StereoSide::RIGHT)], 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
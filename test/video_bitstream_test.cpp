@@ -0,0 +1,61 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2018 Laboratory of Intelligent Robotic Systems,
+ *                     Higher Institute of Information Technology and Intelligent Systems,
+ *                     Kazan Federal University
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "lirs_ros_video_streaming/VideoBitstream.hpp"
+
+namespace {
+
+    TEST(VideoBitstreamTestCase, ShouldDetectH264Keyframes) {
+        // AUD, SPS, PPS, IDR slice
+        std::vector<uint8_t> idr{0, 0, 0, 1, 0x09, 0xF0, 0, 0, 0, 1, 0x67, 0x42, 0, 0, 1, 0x68, 0xCE,
+                                 0, 0, 1, 0x65, 0x88, 0x84};
+        // AUD, non-IDR slice (payload resembles IDR header after a false start code prefix)
+        std::vector<uint8_t> inter{0, 0, 0, 1, 0x09, 0xF0, 0, 0, 1, 0x41, 0x9A, 0x00, 0x00, 0x03, 0x01, 0x65};
+
+        EXPECT_TRUE(lirs::VideoBitstream::is_keyframe(lirs::VideoCodec::H264, idr.data(), idr.size()));
+        EXPECT_FALSE(lirs::VideoBitstream::is_keyframe(lirs::VideoCodec::H264, inter.data(), inter.size()));
+        EXPECT_FALSE(lirs::VideoBitstream::is_keyframe(lirs::VideoCodec::H264, idr.data(), 3));
+    }
+
+    TEST(VideoBitstreamTestCase, ShouldDetectHevcKeyframes) {
+        // VPS, SPS, PPS, IDR_W_RADL slice
+        std::vector<uint8_t> idr{0, 0, 0, 1, 0x40, 0x01, 0, 0, 1, 0x42, 0x01, 0, 0, 1, 0x44, 0x01,
+                                 0, 0, 1, 0x26, 0x01, 0xAF};
+        // TRAIL_R slice
+        std::vector<uint8_t> inter{0, 0, 0, 1, 0x02, 0x01, 0xD0};
+
+        EXPECT_TRUE(lirs::VideoBitstream::is_keyframe(lirs::VideoCodec::HEVC, idr.data(), idr.size()));
+        EXPECT_FALSE(lirs::VideoBitstream::is_keyframe(lirs::VideoCodec::HEVC, inter.data(), inter.size()));
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}